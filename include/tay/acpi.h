@@ -0,0 +1,259 @@
+/**
+ * @file acpi.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief ACPI表结构
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** RSDP签名 */
+#define ACPI_RSDP_SIGNATURE "RSD PTR "
+
+/**
+ * @brief RSDP(根系统描述指针)
+ *
+ */
+typedef struct {
+    /** 签名 "RSD PTR " */
+    char signature[8];
+    /** 前20字节的校验和 */
+    byte checksum;
+    /** OEM ID */
+    char oem_id[6];
+    /** 版本 0 => ACPI 1.0 2 => ACPI 2.0+ */
+    byte revision;
+    /** RSDT物理地址 */
+    dword rsdt_address;
+    /** 结构长度(ACPI 2.0+) */
+    dword length;
+    /** XSDT物理地址(ACPI 2.0+) */
+    qword xsdt_address;
+    /** 整个结构的校验和(ACPI 2.0+) */
+    byte extended_checksum;
+    /** 保留 */
+    byte reserved[3];
+} __attribute__((packed)) ACPIRSDP;
+
+/**
+ * @brief 系统描述表头
+ *
+ */
+typedef struct {
+    /** 签名 */
+    char signature[4];
+    /** 整张表的长度 */
+    dword length;
+    /** 版本 */
+    byte revision;
+    /** 整张表的校验和 */
+    byte checksum;
+    /** OEM ID */
+    char oem_id[6];
+    /** OEM表ID */
+    char oem_table_id[8];
+    /** OEM版本 */
+    dword oem_revision;
+    /** 创建者ID */
+    dword creator_id;
+    /** 创建者版本 */
+    dword creator_revision;
+} __attribute__((packed)) ACPISDTHeader;
+
+/**
+ * @brief SRAT(系统资源亲和表)
+ * 表头后为若干亲和结构
+ *
+ */
+typedef struct {
+    /** 表头 签名"SRAT" */
+    ACPISDTHeader header;
+    /** 保留 */
+    byte reserved[12];
+} __attribute__((packed)) ACPISRAT;
+
+/**
+ * @brief SRAT亲和结构类型
+ *
+ */
+enum ACPISRATTypes {
+    /** 处理器(本地APIC)亲和 */
+    SRAT_PROCESSOR_AFFINITY   = 0,
+    /** 内存亲和 */
+    SRAT_MEMORY_AFFINITY      = 1,
+    /** 处理器(本地x2APIC)亲和 */
+    SRAT_X2APIC_AFFINITY      = 2
+};
+
+/** 亲和结构有效 */
+#define SRAT_ENABLED (1 << 0)
+
+/**
+ * @brief SRAT亲和结构头
+ *
+ */
+typedef struct {
+    /** 类型 */
+    byte type;
+    /** 长度 */
+    byte length;
+} __attribute__((packed)) ACPISRATEntry;
+
+/**
+ * @brief 处理器(本地APIC)亲和结构
+ *
+ */
+typedef struct {
+    /** 结构头 */
+    ACPISRATEntry entry;
+    /** 邻近域 bit 0~7 */
+    byte proximity_low;
+    /** 本地APIC ID */
+    byte apic_id;
+    /** 标志 */
+    dword flags;
+    /** 本地SAPIC EID */
+    byte sapic_eid;
+    /** 邻近域 bit 8~31 */
+    byte proximity_high[3];
+    /** 时钟域 */
+    dword clock_domain;
+} __attribute__((packed)) ACPISRATProcessor;
+
+/**
+ * @brief 内存亲和结构
+ *
+ */
+typedef struct {
+    /** 结构头 */
+    ACPISRATEntry entry;
+    /** 邻近域 */
+    dword proximity;
+    /** 保留 */
+    word reserved0;
+    /** 基址 */
+    qword base;
+    /** 长度 */
+    qword length;
+    /** 保留 */
+    dword reserved1;
+    /** 标志 */
+    dword flags;
+    /** 保留 */
+    qword reserved2;
+} __attribute__((packed)) ACPISRATMemory;
+
+/**
+ * @brief 处理器(本地x2APIC)亲和结构
+ *
+ */
+typedef struct {
+    /** 结构头 */
+    ACPISRATEntry entry;
+    /** 保留 */
+    word reserved0;
+    /** 邻近域 */
+    dword proximity;
+    /** x2APIC ID */
+    dword x2apic_id;
+    /** 标志 */
+    dword flags;
+    /** 时钟域 */
+    dword clock_domain;
+    /** 保留 */
+    dword reserved1;
+} __attribute__((packed)) ACPISRATX2APIC;
+
+/**
+ * @brief SLIT(系统局部性距离信息表)
+ * 表头后为locality_num * locality_num字节的距离矩阵
+ *
+ */
+typedef struct {
+    /** 表头 签名"SLIT" */
+    ACPISDTHeader header;
+    /** 局部性(邻近域)数 */
+    qword locality_num;
+    /** 距离矩阵 */
+    byte entries[];
+} __attribute__((packed)) ACPISLIT;
+
+/**
+ * @brief MADT(多APIC描述表)
+ * 表头后为若干中断控制器结构
+ *
+ */
+typedef struct {
+    /** 表头 签名"APIC" */
+    ACPISDTHeader header;
+    /** 本地APIC物理地址 */
+    dword local_apic_address;
+    /** 标志 */
+    dword flags;
+} __attribute__((packed)) ACPIMADT;
+
+/**
+ * @brief MADT中断控制器结构类型
+ *
+ */
+enum ACPIMADTTypes {
+    /** 处理器本地APIC */
+    MADT_LOCAL_APIC   = 0,
+    /** I/O APIC */
+    MADT_IO_APIC      = 1,
+    /** 处理器本地x2APIC */
+    MADT_LOCAL_X2APIC = 9
+};
+
+/** 处理器可用 */
+#define MADT_ENABLED (1 << 0)
+
+/**
+ * @brief MADT中断控制器结构头
+ *
+ */
+typedef struct {
+    /** 类型 */
+    byte type;
+    /** 长度 */
+    byte length;
+} __attribute__((packed)) ACPIMADTEntry;
+
+/**
+ * @brief 处理器本地APIC结构
+ *
+ */
+typedef struct {
+    /** 结构头 */
+    ACPIMADTEntry entry;
+    /** ACPI处理器UID */
+    byte processor_uid;
+    /** 本地APIC ID */
+    byte apic_id;
+    /** 标志 */
+    dword flags;
+} __attribute__((packed)) ACPIMADTLocalAPIC;
+
+/**
+ * @brief 处理器本地x2APIC结构
+ *
+ */
+typedef struct {
+    /** 结构头 */
+    ACPIMADTEntry entry;
+    /** 保留 */
+    word reserved;
+    /** x2APIC ID */
+    dword x2apic_id;
+    /** 标志 */
+    dword flags;
+    /** ACPI处理器UID */
+    dword processor_uid;
+} __attribute__((packed)) ACPIMADTLocalX2APIC;
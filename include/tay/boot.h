@@ -12,4 +12,69 @@
 
 #pragma once
 
-#define BOOT_MAGIC (0x036CB787)
\ No newline at end of file
+#include <tay/types.h>
+
+#define BOOT_MAGIC (0x036CB787)
+
+/**
+ * @brief 内核映像的虚拟基址
+ * 加载器需将物理内存[0, KERNEL_MAP_SIZE)映射到该地址 并保留低端的恒等映射
+ * 随后跳转到内核入口(高半区地址)
+ * 内核沿用加载器的页表 页表与启动信息须位于KERNEL_LOAD_ADDR之下(内核保留该区域)
+ *
+ */
+#define KERNEL_VIRT_BASE (0xFFFFFFFF80000000ull)
+/** 内核映像的物理加载地址 */
+#define KERNEL_LOAD_ADDR (0x400000ull)
+/** 加载器为内核映像建立的映射大小 */
+#define KERNEL_MAP_SIZE  (1ull << 30)
+
+/** 内存布局表最大项数 */
+#define BOOT_MEMORY_ENTRY_MAX (64)
+
+/**
+ * @brief 内存区域类型
+ * 与Multiboot2内存布局表一致
+ *
+ */
+enum BootMemoryTypes {
+    /** 可用内存 */
+    BOOT_MEMORY_AVAILABLE        = 1,
+    /** 保留内存 */
+    BOOT_MEMORY_RESERVED         = 2,
+    /** ACPI可回收内存 */
+    BOOT_MEMORY_ACPI_RECLAIMABLE = 3,
+    /** ACPI NVS内存 */
+    BOOT_MEMORY_NVS              = 4,
+    /** 损坏的内存 */
+    BOOT_MEMORY_BADRAM           = 5
+};
+
+/**
+ * @brief 内存布局表项
+ *
+ */
+typedef struct {
+    /** 基址 */
+    qword base;
+    /** 长度 */
+    qword length;
+    /** 类型 */
+    dword type;
+    /** 保留 */
+    dword reserved;
+} BootMemoryEntry;
+
+/**
+ * @brief 加载器传递给内核的启动信息
+ * 物理地址存放在rbx中
+ *
+ */
+typedef struct {
+    /** 内存布局表项数 */
+    dword memory_entry_num;
+    /** 保留 */
+    dword reserved;
+    /** 内存布局表 */
+    BootMemoryEntry memory_map[BOOT_MEMORY_ENTRY_MAX];
+} BootInfo;
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @file cpuid.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief CPUID
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/**
+ * @brief CPUID结果
+ *
+ */
+typedef struct {
+    /** EAX */
+    dword eax;
+    /** EBX */
+    dword ebx;
+    /** ECX */
+    dword ecx;
+    /** EDX */
+    dword edx;
+} CPUIDResult;
+
+/** CPUID.01H:EDX.PGE[bit 13] 支持全局页 */
+#define CPUID_01_EDX_PGE      (1 << 13)
+/** CPUID.01H:EDX.PAT[bit 16] 支持页属性表 */
+#define CPUID_01_EDX_PAT      (1 << 16)
+/** CPUID.01H:ECX.PCID[bit 17] 支持PCID */
+#define CPUID_01_ECX_PCID     (1 << 17)
+/** CPUID.(EAX=07H,ECX=0):EBX.INVPCID[bit 10] 支持INVPCID指令 */
+#define CPUID_07_EBX_INVPCID  (1 << 10)
+/** CPUID.(EAX=07H,ECX=0):ECX.LA57[bit 16] 支持5级分页 */
+#define CPUID_07_ECX_LA57     (1 << 16)
+/** CPUID.80000001H:EDX.Page1GB[bit 26] 支持1GB页 */
+#define CPUID_80000001_EDX_PAGE1GB (1 << 26)
+
+/** CPUID.(EAX=04H,ECX=n):EAX[4:0] 缓存类型 为0时已没有更多缓存 */
+#define CPUID_04_EAX_TYPE(eax)       ((eax) & 0x1F)
+/** CPUID.(EAX=04H,ECX=n):EAX[7:5] 缓存级别 */
+#define CPUID_04_EAX_LEVEL(eax)      (((eax) >> 5) & 0x7)
+/** CPUID.(EAX=04H,ECX=n):EAX[25:14] 共享该缓存的逻辑处理器数上限减1 */
+#define CPUID_04_EAX_SHARING(eax)    ((((eax) >> 14) & 0xFFF) + 1)
+/** CPUID.(EAX=04H,ECX=n):EBX[11:0] 缓存行大小减1 */
+#define CPUID_04_EBX_LINE_SIZE(ebx)  (((ebx) & 0xFFF) + 1)
+/** CPUID.(EAX=04H,ECX=n):EBX[21:12] 物理行分区数减1 */
+#define CPUID_04_EBX_PARTITIONS(ebx) ((((ebx) >> 12) & 0x3FF) + 1)
+/** CPUID.(EAX=04H,ECX=n):EBX[31:22] 相联路数减1 */
+#define CPUID_04_EBX_WAYS(ebx)       ((((ebx) >> 22) & 0x3FF) + 1)
+/** CPUID.(EAX=04H,ECX=n):ECX 组数减1 */
+#define CPUID_04_ECX_SETS(ecx)       ((ecx) + 1)
+
+/**
+ * @brief 执行CPUID
+ *
+ * @param leaf 主功能号(EAX)
+ * @param subleaf 子功能号(ECX)
+ * @return CPUID结果
+ */
+static inline CPUIDResult cpuid(dword leaf, dword subleaf) {
+    CPUIDResult result;
+    asm volatile ("cpuid"
+        : "=a"(result.eax), "=b"(result.ebx), "=c"(result.ecx), "=d"(result.edx)
+        : "a"(leaf), "c"(subleaf));
+    return result;
+}
+
+/**
+ * @brief 获取最大主功能号
+ *
+ * @return 最大主功能号
+ */
+static inline dword cpuid_max_leaf(void) {
+    return cpuid(0, 0).eax;
+}
+
+/**
+ * @brief 获取最大扩展功能号
+ *
+ * @return 最大扩展功能号
+ */
+static inline dword cpuid_max_ext_leaf(void) {
+    return cpuid(0x80000000, 0).eax;
+}
\ No newline at end of file
@@ -142,12 +142,46 @@ typedef union cr3_t {
         /** 保留 bit 51~63 */
         word reserved : 13;
     };
+    /**
+     * @brief CR4.PCIDE=1时的CR3格式
+     *
+     */
+    struct {
+        /**
+         * @brief Process-Context Identifier(进程上下文识别符) bit 0~11
+         * TLB项以PCID为标签 切换CR3时不同PCID的TLB项可以共存
+         *
+         */
+        word PCID : 12;
+        /** 页表地址 bit 12~51 */
+        qword _pcid_page_entry : 40;
+        /** 保留 bit 52~62 */
+        word reserved4 : 11;
+        /**
+         * @brief No Flush(不刷新) bit 63
+         * 写CR3时NOFLUSH=1 则不清除新PCID对应的TLB项
+         * 该位仅在写入时有效 读出恒为0
+         *
+         */
+        bool NOFLUSH : 1;
+    };
     /** 页表地址 */
     qword page_entry;
 } CR3;
 
+#if BITS==32
 /** CR3页表地址掩码 */
 #define CR3_PAGE_ENTRY_MASK (0xFFFFF000)
+#else
+/** CR3页表地址掩码 */
+#define CR3_PAGE_ENTRY_MASK (0x000FFFFFFFFFF000)
+#endif
+
+/** CR3 PCID掩码 */
+#define CR3_PCID_MASK (0xFFF)
+
+/** CR3 NOFLUSH位 */
+#define CR3_NOFLUSH (1ull << 63)
 
 /**
  * @brief CR4寄存器
@@ -354,8 +388,16 @@ typedef struct {
     qword reserved3 : 52;
 } EFER;
 
+/** PAT地址 */
+#define MSR_PAT_ADDR (0x277)
 /** EFER地址 */
 #define MSR_EFER_ADDR (0xC0000080)
+/** FS基址地址 */
+#define MSR_FS_BASE_ADDR (0xC0000100)
+/** GS基址地址 */
+#define MSR_GS_BASE_ADDR (0xC0000101)
+/** SWAPGS交换的GS基址地址 */
+#define MSR_KERNEL_GS_BASE_ADDR (0xC0000102)
 
 /**
  * @brief 读取CR0
@@ -364,10 +406,11 @@ typedef struct {
  */
 static inline CR0 rdcr0(void) {
     CR0 cr0;
-    dword cr0Val;
+    reg_t cr0Reg;
 
-    asm volatile("movl %%cr0, %0" : "=r"(cr0Val));
+    asm volatile("mov %%cr0, %0" : "=r"(cr0Reg));
 
+    dword cr0Val = (dword)cr0Reg;
     cr0 = *(CR0 *)&cr0Val;
 
     return cr0;
@@ -379,9 +422,9 @@ static inline CR0 rdcr0(void) {
  * @param cr0 CR0
  */
 static inline void wrcr0(CR0 cr0) {
-    dword cr0Val = *(dword *)&cr0;
+    reg_t cr0Val = *(dword *)&cr0;
 
-    asm volatile("movl %0, %%cr0" : : "r"(cr0Val));
+    asm volatile("mov %0, %%cr0" : : "r"(cr0Val) : "memory");
 }
 
 /**
@@ -391,11 +434,11 @@ static inline void wrcr0(CR0 cr0) {
  */
 static inline CR2 rdcr2(void) {
     CR2 cr2;
-    dword cr2Val;
+    reg_t cr2Val;
 
-    asm volatile("movl %%cr2, %0" : "=r"(cr2Val));
+    asm volatile("mov %%cr2, %0" : "=r"(cr2Val));
 
-    cr2 = *(CR2 *)&cr2Val;
+    cr2.PFLA = cr2Val;
 
     return cr2;
 }
@@ -406,9 +449,9 @@ static inline CR2 rdcr2(void) {
  * @param cr2 CR2
  */
 static inline void wrcr2(CR2 cr2) {
-    dword cr2Val = *(dword *)&cr2;
+    reg_t cr2Val = (reg_t)cr2.PFLA;
 
-    asm volatile("movl %0, %%cr2" : : "r"(cr2Val));
+    asm volatile("mov %0, %%cr2" : : "r"(cr2Val));
 }
 
 /**
@@ -417,12 +460,12 @@ static inline void wrcr2(CR2 cr2) {
  * @return CR3
  */
 static inline CR3 rdcr3(void) {
-    CR3 cr3;
-    dword cr3Val;
+    CR3 cr3 = {};
+    reg_t cr3Val;
 
-    asm volatile("movl %%cr3, %0" : "=r"(cr3Val));
+    asm volatile("mov %%cr3, %0" : "=r"(cr3Val));
 
-    cr3 = *(CR3 *)&cr3Val;
+    cr3.page_entry = cr3Val;
 
     return cr3;
 }
@@ -433,9 +476,9 @@ static inline CR3 rdcr3(void) {
  * @param cr3 CR3
  */
 static inline void wrcr3(CR3 cr3) {
-    dword cr3Val = *(dword *)&cr3;
+    reg_t cr3Val = (reg_t)cr3.page_entry;
 
-    asm volatile("movl %0, %%cr3" : : "r"(cr3Val));
+    asm volatile("mov %0, %%cr3" : : "r"(cr3Val) : "memory");
 }
 
 /**
@@ -445,10 +488,11 @@ static inline void wrcr3(CR3 cr3) {
  */
 static inline CR4 rdcr4(void) {
     CR4 cr4;
-    dword cr4Val;
+    reg_t cr4Reg;
 
-    asm volatile("movl %%cr4, %0" : "=r"(cr4Val));
+    asm volatile("mov %%cr4, %0" : "=r"(cr4Reg));
 
+    dword cr4Val = (dword)cr4Reg;
     cr4 = *(CR4 *)&cr4Val;
 
     return cr4;
@@ -460,9 +504,9 @@ static inline CR4 rdcr4(void) {
  * @param cr4 CR4
  */
 static inline void wrcr4(CR4 cr4) {
-    dword cr4Val = *(dword *)&cr4;
+    reg_t cr4Val = *(dword *)&cr4;
 
-    asm volatile("movl %0, %%cr4" : : "r"(cr4Val));
+    asm volatile("mov %0, %%cr4" : : "r"(cr4Val) : "memory");
 }
 
 /**
@@ -495,6 +539,18 @@ static inline void wrmsr(dword address, qword msr) {
     asm volatile("wrmsr" : : "d"(high), "a"(low), "c"(address));
 }
 
+/**
+ * @brief 读时间戳计数器
+ *
+ * @return TSC
+ */
+static inline qword rdtsc(void) {
+    dword high;
+    dword low;
+    asm volatile("rdtsc" : "=d"(high), "=a"(low));
+    return (((qword)high) << 32) | ((qword)low);
+}
+
 /**
  * @brief 读EFER
  *
@@ -418,7 +418,7 @@ inline static GateDescriptor build_gate(byte type, void *ptr, byte privilege, in
  * @return 门描述符
  */
 inline static GateDescriptor build_gate(byte type, void *ptr, byte privilege, int cs) {
-    dword base = (dword)ptr;
+    qword base = (qword)ptr;
 	GateDescriptor desc = {};
     desc.offset0 = base & 0xFFFF; //偏移
     desc.segment = cs; //段
@@ -430,6 +430,7 @@ inline static GateDescriptor build_gate(byte type, void *ptr, byte privilege, in
     desc.offset1 = (base >> 16) & 0xFFFF; //偏移
     desc.offset2 = base >> 32; //偏移
     desc.reserved = 0;
+	return desc;
 }
 
 #endif
@@ -25,7 +25,55 @@
 #define PAGE_ENTRY_1G_MASK (0x01FFFFFFC0000000)
 
 /** 页表地址掩码 */
-#define PAGING_TABLE_ENTRY_MASK (0x01FFFFFFC0000000)
+#define PAGING_TABLE_ENTRY_MASK (0x000FFFFFFFFFF000)
+
+/** 存在位 */
+#define PAGE_PRESENT  (1ull << 0)
+/** 读写位 */
+#define PAGE_WRITE    (1ull << 1)
+/** 用户位 */
+#define PAGE_USER     (1ull << 2)
+/** 页级别写透明 */
+#define PAGE_PWT      (1ull << 3)
+/** 页级别缓存禁用 */
+#define PAGE_PCD      (1ull << 4)
+/** 已访问位 */
+#define PAGE_ACCESSED (1ull << 5)
+/** 脏位 */
+#define PAGE_DIRTY    (1ull << 6)
+/** 页大小位(PDE/PDPTE) */
+#define PAGE_HUGE     (1ull << 7)
+/** 页属性表位(PTE) 与PDE/PDPTE的页大小位同位 */
+#define PAGE_PAT      (1ull << 7)
+/** 页属性表位(大页PDE/PDPTE) */
+#define PAGE_PAT_HUGE (1ull << 12)
+/** 全局位 */
+#define PAGE_GLOBAL   (1ull << 8)
+/** 禁止执行位 */
+#define PAGE_NOEXEC   (1ull << 63)
+
+/** PML5索引 */
+#define PML5_INDEX(address) (((address) >> 48) & 0x1FF)
+/** PML4索引 */
+#define PML4_INDEX(address) (((address) >> 39) & 0x1FF)
+/** PDPT索引 */
+#define PDPT_INDEX(address) (((address) >> 30) & 0x1FF)
+/** PD索引 */
+#define PD_INDEX(address)   (((address) >> 21) & 0x1FF)
+/** PT索引 */
+#define PT_INDEX(address)   (((address) >> 12) & 0x1FF)
+
+/** 一个PML5项映射的大小(256TB) */
+#define PML5E_SPAN (1ull << 48)
+/** 一个PML4项映射的大小(512GB) */
+#define PML4E_SPAN (1ull << 39)
+
+/**
+ * @brief 写时复制(软件定义位) bit 9
+ * 该页属于可写区域 但因与其他地址空间共享而被写保护
+ *
+ */
+#define PAGE_COW_BIT (1ull << 9)
 
 /**
  * @brief 4K页面项
@@ -432,7 +480,7 @@ typedef union {
  * @param page4k 4K页面
  * @return 4K页面地址
  */
-static inline dword get_4k_page_addr(PageEntry4K page4k) {
+static inline qword get_4k_page_addr(PageEntry4K page4k) {
     return page4k.address & PAGE_ENTRY_4K_MASK;
 }
 
@@ -442,7 +490,7 @@ static inline dword get_4k_page_addr(PageEntry4K page4k) {
  * @param page2m 2M页面
  * @return 2M页面地址
  */
-static inline dword get_2m_page_addr(PageEntry2M page2m) {
+static inline qword get_2m_page_addr(PageEntry2M page2m) {
     return page2m.address & PAGE_ENTRY_2M_MASK;
 }
 
@@ -452,7 +500,7 @@ static inline dword get_2m_page_addr(PageEntry2M page2m) {
  * @param page1g 1G页面
  * @return 1G页面地址
  */
-static inline dword get_1g_page_addr(PageEntry1G page1g) {
+static inline qword get_1g_page_addr(PageEntry1G page1g) {
     return page1g.address & PAGE_ENTRY_1G_MASK;
 }
 
@@ -462,7 +510,7 @@ static inline dword get_1g_page_addr(PageEntry1G page1g) {
  * @param pagingTable 页表
  * @return 页表地址
  */
-static inline dword get_pagingtab_addr(PagingTableEntry paging_tab) {
+static inline qword get_pagingtab_addr(PagingTableEntry paging_tab) {
     return paging_tab.address & PAGING_TABLE_ENTRY_MASK;
 }
 
@@ -546,6 +594,16 @@ typedef union {
  * 
  */
 #define PAGE_SIZE    (4096)
+/**
+ * @brief 2M页大小
+ * 
+ */
+#define PAGE_2M_SIZE (0x200000ull)
+/**
+ * @brief 1G页大小
+ * 
+ */
+#define PAGE_1G_SIZE (0x40000000ull)
 /**
  * @brief 每表PTE数
  * 
@@ -0,0 +1,65 @@
+/**
+ * @file tlb.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief TLB操作指令
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/**
+ * @brief INVPCID类型
+ *
+ */
+enum INVPCIDTypes {
+    /** 使单个PCID中的单个地址无效 */
+    INVPCID_ADDRESS    = 0,
+    /** 使单个PCID中的所有非全局项无效 */
+    INVPCID_SINGLE     = 1,
+    /** 使所有PCID中的所有项(含全局项)无效 */
+    INVPCID_ALL_GLOBAL = 2,
+    /** 使所有PCID中的所有非全局项无效 */
+    INVPCID_ALL        = 3
+};
+
+/**
+ * @brief INVPCID描述符
+ *
+ */
+typedef struct {
+    /** PCID bit 0~11 */
+    qword pcid;
+    /** 线性地址 */
+    qword address;
+} __attribute__((packed)) INVPCIDDesc;
+
+/**
+ * @brief 使单个地址的TLB项无效
+ *
+ * @param address 线性地址
+ */
+static inline void invlpg(void *address) {
+    asm volatile ("invlpg (%0)" : : "r"(address) : "memory");
+}
+
+/**
+ * @brief 使PCID相关的TLB项无效
+ *
+ * @param type 类型(见INVPCIDTypes)
+ * @param pcid PCID
+ * @param address 线性地址(仅INVPCID_ADDRESS时有效)
+ */
+static inline void invpcid(reg_t type, word pcid, void *address) {
+    INVPCIDDesc desc = {
+        .pcid = pcid,
+        .address = (qword)address
+    };
+    asm volatile ("invpcid %0, %1" : : "m"(desc), "r"(type) : "memory");
+}
\ No newline at end of file
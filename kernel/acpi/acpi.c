@@ -0,0 +1,136 @@
+/**
+ * @file acpi.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief ACPI表查找
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <acpi/acpi.h>
+#include <mm/direct_map.h>
+#include <basec/logger.h>
+#include <string.h>
+#include <stddef.h>
+
+/** BIOS数据区中EBDA段地址的位置 */
+#define BDA_EBDA_SEGMENT (0x40E)
+/** BIOS只读区域起始 */
+#define BIOS_AREA_START  (0xE0000)
+/** BIOS只读区域结束 */
+#define BIOS_AREA_END    (0x100000)
+
+// 根表(RSDT或XSDT)
+static ACPISDTHeader *root_table = NULL;
+// 根表中的指针是否为64位(XSDT)
+static bool root_is_xsdt = false;
+
+/**
+ * @brief 计算校验和
+ * 合法结构的所有字节之和为0
+ *
+ * @param data 数据
+ * @param length 长度
+ * @return 字节和
+ */
+static byte acpi_checksum(void *data, size_t length) {
+    byte sum = 0;
+    for (size_t i = 0 ; i < length ; i ++) {
+        sum += ((byte *)data)[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief 在物理内存区间中查找RSDP
+ * RSDP总是16字节对齐
+ *
+ * @param start 起始物理地址
+ * @param end 结束物理地址
+ * @return RSDP 未找到时为NULL
+ */
+static ACPIRSDP *scan_rsdp(qword start, qword end) {
+    for (qword phys = start ; phys + 20 <= end ; phys += 16) {
+        ACPIRSDP *rsdp = phys_to_virt(phys);
+        if (memcmp(rsdp->signature, ACPI_RSDP_SIGNATURE, 8) == 0 && acpi_checksum(rsdp, 20) == 0) {
+            return rsdp;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 初始化ACPI
+ * 在BIOS区域中查找RSDP 需要在直接映射建立之后调用
+ *
+ * @return 是否找到RSDP
+ */
+bool init_acpi(void) {
+    // 先查EBDA的前1KB 再查BIOS只读区域
+    qword ebda = ((qword)*(word *)phys_to_virt(BDA_EBDA_SEGMENT)) << 4;
+    ACPIRSDP *rsdp = NULL;
+    if (ebda != 0) {
+        rsdp = scan_rsdp(ebda, ebda + 1024);
+    }
+    if (rsdp == NULL) {
+        rsdp = scan_rsdp(BIOS_AREA_START, BIOS_AREA_END);
+    }
+    if (rsdp == NULL) {
+        log_warn("未找到ACPI RSDP");
+        return false;
+    }
+
+    if (rsdp->revision >= 2 && rsdp->xsdt_address != 0 &&
+        acpi_checksum(rsdp, rsdp->length) == 0) {
+        root_table = phys_to_virt(rsdp->xsdt_address);
+        root_is_xsdt = true;
+    }
+    else {
+        root_table = phys_to_virt(rsdp->rsdt_address);
+        root_is_xsdt = false;
+    }
+
+    if (acpi_checksum(root_table, root_table->length) != 0) {
+        log_warn("ACPI根表校验失败");
+        root_table = NULL;
+        return false;
+    }
+
+    log_info("ACPI: 版本%d, 根表%s", rsdp->revision, root_is_xsdt ? "XSDT" : "RSDT");
+    return true;
+}
+
+/**
+ * @brief 查找ACPI表
+ *
+ * @param signature 签名(4字节)
+ * @return 表 不存在或校验失败时为NULL
+ */
+ACPISDTHeader *acpi_find_table(const char *signature) {
+    if (root_table == NULL) {
+        return NULL;
+    }
+
+    size_t entry_size = root_is_xsdt ? sizeof(qword) : sizeof(dword);
+    size_t entry_num = (root_table->length - sizeof(ACPISDTHeader)) / entry_size;
+    byte *entries = ((byte *)root_table) + sizeof(ACPISDTHeader);
+
+    for (size_t i = 0 ; i < entry_num ; i ++) {
+        qword phys = root_is_xsdt ? *(qword *)(entries + i * entry_size) : *(dword *)(entries + i * entry_size);
+        ACPISDTHeader *table = phys_to_virt(phys);
+
+        if (memcmp(table->signature, signature, 4) != 0) {
+            continue;
+        }
+        if (acpi_checksum(table, table->length) != 0) {
+            log_warn("ACPI表%c%c%c%c校验失败", signature[0], signature[1], signature[2], signature[3]);
+            continue;
+        }
+        return table;
+    }
+
+    return NULL;
+}
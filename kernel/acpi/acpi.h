@@ -0,0 +1,31 @@
+/**
+ * @file acpi.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief ACPI表查找
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/acpi.h>
+
+/**
+ * @brief 初始化ACPI
+ * 在BIOS区域中查找RSDP 需要在直接映射建立之后调用
+ *
+ * @return 是否找到RSDP
+ */
+bool init_acpi(void);
+
+/**
+ * @brief 查找ACPI表
+ *
+ * @param signature 签名(4字节)
+ * @return 表 不存在或校验失败时为NULL
+ */
+ACPISDTHeader *acpi_find_table(const char *signature);
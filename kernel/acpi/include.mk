@@ -0,0 +1 @@
+objects += acpi/acpi.o
\ No newline at end of file
@@ -0,0 +1,255 @@
+/**
+ * @file apic.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 本地APIC
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/apic.h>
+#include <tay/cr.h>
+#include <tay/paging.h>
+#include <tay/io.h>
+#include <mm/vmalloc.h>
+#include <cpu/irqflags.h>
+#include <cpu/interrupt.h>
+#include <sync/spinlock.h>
+#include <sched/clock.h>
+#include <basec/logger.h>
+#include <stddef.h>
+
+// 是否处于x2APIC模式
+static bool x2apic_mode = false;
+// xAPIC寄存器基址
+static volatile byte *apic_base = NULL;
+// 16分频下定时器每秒的计数 为0时尚未测定
+static qword apic_timer_frequency = 0;
+
+/** PIT输入频率 */
+#define PIT_FREQUENCY (1193182)
+/** 测定定时器频率的时长(1/PIT_CALIBRATE_DIV秒) */
+#define PIT_CALIBRATE_DIV (100)
+
+/**
+ * @brief 读APIC寄存器
+ *
+ * @param reg 寄存器偏移
+ * @return 寄存器值
+ */
+static dword apic_read(dword reg) {
+    if (x2apic_mode) {
+        return (dword)rdmsr(0x800 + (reg >> 4));
+    }
+    return *(volatile dword *)(apic_base + reg);
+}
+
+/**
+ * @brief 写APIC寄存器
+ *
+ * @param reg 寄存器偏移
+ * @param value 寄存器值
+ */
+static void apic_write(dword reg, dword value) {
+    if (x2apic_mode) {
+        wrmsr(0x800 + (reg >> 4), value);
+        return;
+    }
+    *(volatile dword *)(apic_base + reg) = value;
+}
+
+/**
+ * @brief 初始化本地APIC
+ *
+ */
+void init_apic(void) {
+    qword base = rdmsr(MSR_APIC_BASE_ADDR);
+
+    x2apic_mode = (base & APIC_BASE_X2APIC) != 0;
+    apic_base = (volatile byte *)(base & APIC_BASE_MASK);
+
+    load_apic();
+
+    log_info("本地APIC: %s模式, ID=%d", x2apic_mode ? "x2APIC" : "xAPIC", apic_id());
+}
+
+/**
+ * @brief 在当前CPU上启用本地APIC
+ * 模式与0号CPU一致 其它CPU上线时调用
+ *
+ */
+void load_apic(void) {
+    qword base = rdmsr(MSR_APIC_BASE_ADDR);
+
+    if ((base & APIC_BASE_ENABLE) == 0) {
+        base |= APIC_BASE_ENABLE;
+        wrmsr(MSR_APIC_BASE_ADDR, base);
+    }
+    // 进入x2APIC模式须先启用xAPIC
+    if (x2apic_mode && (base & APIC_BASE_X2APIC) == 0) {
+        wrmsr(MSR_APIC_BASE_ADDR, base | APIC_BASE_X2APIC);
+    }
+
+    // 软件启用APIC
+    apic_write(APIC_REG_SVR, apic_read(APIC_REG_SVR) | 0x100 | APIC_SPURIOUS_VECTOR);
+}
+
+/**
+ * @brief 以不缓存方式重新映射xAPIC寄存器
+ * 此前经加载器的恒等映射访问 其缓存类型取决于加载器与MTRR
+ * 需在vmalloc初始化之后调用
+ *
+ */
+void init_apic_mmio(void) {
+    if (x2apic_mode) {
+        return;
+    }
+
+    qword phys = rdmsr(MSR_APIC_BASE_ADDR) & APIC_BASE_MASK;
+    volatile byte *base = ioremap_uc(phys, PAGE_SIZE);
+    if (base == NULL) {
+        log_error("无法映射本地APIC寄存器");
+        return;
+    }
+    apic_base = base;
+}
+
+/**
+ * @brief 是否处于x2APIC模式
+ * xAPIC模式下只能向APIC ID小于255的CPU发送IPI
+ *
+ * @return 是否处于x2APIC模式
+ */
+bool x2apic_enabled(void) {
+    return x2apic_mode;
+}
+
+/**
+ * @brief 获取当前CPU的APIC ID
+ *
+ * @return APIC ID
+ */
+dword apic_id(void) {
+    if (x2apic_mode) {
+        return apic_read(APIC_REG_ID);
+    }
+    return apic_read(APIC_REG_ID) >> 24;
+}
+
+/**
+ * @brief 发送中断结束信号
+ *
+ */
+void apic_eoi(void) {
+    apic_write(APIC_REG_EOI, 0);
+}
+
+/**
+ * @brief 写ICR 等待投递完成
+ *
+ * @param apic_id 目标APIC ID
+ * @param command ICR低32位
+ */
+static void apic_write_icr(dword apic_id, dword command) {
+    if (x2apic_mode) {
+        // x2APIC下ICR为一个64位MSR
+        wrmsr(0x800 + (APIC_REG_ICR0 >> 4), (((qword)apic_id) << 32) | command);
+        return;
+    }
+
+    // 两次写ICR之间不能被同样发送IPI的中断处理程序打断
+    qword flags = local_irq_save();
+    apic_write(APIC_REG_ICR1, apic_id << 24);
+    apic_write(APIC_REG_ICR0, command);
+
+    while (apic_read(APIC_REG_ICR0) & APIC_ICR_PENDING);
+    local_irq_restore(flags);
+}
+
+/**
+ * @brief 向指定CPU发送IPI
+ *
+ * @param apic_id 目标APIC ID
+ * @param vector 中断向量
+ */
+void apic_send_ipi(dword apic_id, byte vector) {
+    apic_write_icr(apic_id, vector);
+}
+
+/**
+ * @brief 向指定CPU发送INIT IPI 使其进入等待启动的状态
+ *
+ * @param apic_id 目标APIC ID
+ */
+void apic_send_init(dword apic_id) {
+    apic_write_icr(apic_id, APIC_ICR_INIT | APIC_ICR_ASSERT | APIC_ICR_LEVEL);
+}
+
+/**
+ * @brief 向指定CPU发送Start-Up IPI
+ * 目标CPU在实模式下从address处开始执行
+ *
+ * @param apic_id 目标APIC ID
+ * @param address 启动代码的物理地址 须4K对齐且低于1M
+ */
+void apic_send_startup(dword apic_id, qword address) {
+    apic_write_icr(apic_id, APIC_ICR_STARTUP | APIC_ICR_ASSERT | (address >> 12));
+}
+
+/**
+ * @brief 借助PIT通道2测定本地APIC定时器的频率
+ * 通道2的门控由0x61端口控制 计数结束时0x61的第5位置位 不需要中断
+ * 同时测定TSC的频率 作为调度时钟
+ *
+ * @return 16分频下定时器每秒的计数
+ */
+static qword calibrate_apic_timer(void) {
+    word count = PIT_FREQUENCY / PIT_CALIBRATE_DIV;
+
+    // 关闭扬声器 拉低门控
+    outb(0x61, inb(0x61) & ~0x03);
+    // 通道2 先低后高 模式0
+    outb(0x43, 0xB0);
+    outb(0x42, count & 0xFF);
+    outb(0x42, count >> 8);
+
+    apic_write(APIC_REG_TIMER_DIVIDE, APIC_TIMER_DIVIDE_16);
+    apic_write(APIC_REG_LVT_TIMER, APIC_LVT_MASKED);
+
+    // 拉高门控开始计数 同时启动APIC定时器 顺带测定TSC
+    outb(0x61, (inb(0x61) & ~0x02) | 0x01);
+    apic_write(APIC_REG_TIMER_INITIAL, 0xFFFFFFFF);
+    qword tsc_start = rdtsc();
+
+    while ((inb(0x61) & 0x20) == 0) {
+        cpu_relax();
+    }
+
+    dword elapsed = 0xFFFFFFFF - apic_read(APIC_REG_TIMER_CURRENT);
+    qword tsc_elapsed = rdtsc() - tsc_start;
+    apic_write(APIC_REG_TIMER_INITIAL, 0);
+    outb(0x61, inb(0x61) & ~0x01);
+
+    init_sched_clock(tsc_elapsed * PIT_CALIBRATE_DIV);
+    return (qword)elapsed * PIT_CALIBRATE_DIV;
+}
+
+/**
+ * @brief 以周期模式启动当前CPU的本地APIC定时器
+ * 首次调用时借助PIT通道2测定定时器频率
+ *
+ * @param hz 每秒中断次数
+ */
+void init_apic_timer(dword hz) {
+    if (apic_timer_frequency == 0) {
+        apic_timer_frequency = calibrate_apic_timer();
+        log_info("本地APIC定时器: %dkHz(16分频)", (int)(apic_timer_frequency / 1000));
+    }
+
+    apic_write(APIC_REG_TIMER_DIVIDE, APIC_TIMER_DIVIDE_16);
+    apic_write(APIC_REG_LVT_TIMER, APIC_LVT_TIMER_PERIODIC | APIC_TIMER_VECTOR);
+    apic_write(APIC_REG_TIMER_INITIAL, apic_timer_frequency / hz);
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+ * @file apic.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 本地APIC
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** IA32_APIC_BASE MSR地址 */
+#define MSR_APIC_BASE_ADDR (0x1B)
+/** IA32_APIC_BASE.EXTD 启用x2APIC */
+#define APIC_BASE_X2APIC   (1 << 10)
+/** IA32_APIC_BASE.EN 启用APIC */
+#define APIC_BASE_ENABLE   (1 << 11)
+/** IA32_APIC_BASE 基址掩码 */
+#define APIC_BASE_MASK     (0x000FFFFFFFFFF000)
+
+/** ID寄存器 */
+#define APIC_REG_ID   (0x020)
+/** EOI寄存器 */
+#define APIC_REG_EOI  (0x0B0)
+/** 伪中断向量寄存器 */
+#define APIC_REG_SVR  (0x0F0)
+/** ICR(低32位) */
+#define APIC_REG_ICR0 (0x300)
+/** ICR(高32位) */
+#define APIC_REG_ICR1 (0x310)
+/** LVT定时器寄存器 */
+#define APIC_REG_LVT_TIMER     (0x320)
+/** 定时器初始计数 */
+#define APIC_REG_TIMER_INITIAL (0x380)
+/** 定时器当前计数 */
+#define APIC_REG_TIMER_CURRENT (0x390)
+/** 定时器分频 */
+#define APIC_REG_TIMER_DIVIDE  (0x3E0)
+
+/** ICR 投递模式: INIT */
+#define APIC_ICR_INIT    (5 << 8)
+/** ICR 投递模式: Start-Up 向量为启动代码的物理页号 */
+#define APIC_ICR_STARTUP (6 << 8)
+/** ICR 投递状态(发送中) */
+#define APIC_ICR_PENDING (1 << 12)
+/** ICR 电平有效 */
+#define APIC_ICR_ASSERT  (1 << 14)
+/** ICR 电平触发 */
+#define APIC_ICR_LEVEL   (1 << 15)
+
+/** LVT 屏蔽 */
+#define APIC_LVT_MASKED         (1 << 16)
+/** LVT定时器 周期模式 */
+#define APIC_LVT_TIMER_PERIODIC (1 << 17)
+/** 定时器16分频 */
+#define APIC_TIMER_DIVIDE_16    (0x3)
+
+/** 伪中断向量 */
+#define APIC_SPURIOUS_VECTOR (0xFF)
+
+/**
+ * @brief 初始化本地APIC
+ *
+ */
+void init_apic(void);
+
+/**
+ * @brief 在当前CPU上启用本地APIC
+ * 模式与0号CPU一致 其它CPU上线时调用
+ *
+ */
+void load_apic(void);
+
+/**
+ * @brief 以不缓存方式重新映射xAPIC寄存器
+ * 此前经加载器的恒等映射访问 其缓存类型取决于加载器与MTRR
+ * 需在vmalloc初始化之后调用
+ *
+ */
+void init_apic_mmio(void);
+
+/**
+ * @brief 是否处于x2APIC模式
+ * xAPIC模式下只能向APIC ID小于255的CPU发送IPI
+ *
+ * @return 是否处于x2APIC模式
+ */
+bool x2apic_enabled(void);
+
+/**
+ * @brief 获取当前CPU的APIC ID
+ *
+ * @return APIC ID
+ */
+dword apic_id(void);
+
+/**
+ * @brief 发送中断结束信号
+ *
+ */
+void apic_eoi(void);
+
+/**
+ * @brief 向指定CPU发送IPI
+ *
+ * @param apic_id 目标APIC ID
+ * @param vector 中断向量
+ */
+void apic_send_ipi(dword apic_id, byte vector);
+
+/**
+ * @brief 向指定CPU发送INIT IPI 使其进入等待启动的状态
+ *
+ * @param apic_id 目标APIC ID
+ */
+void apic_send_init(dword apic_id);
+
+/**
+ * @brief 向指定CPU发送Start-Up IPI
+ * 目标CPU在实模式下从address处开始执行
+ *
+ * @param apic_id 目标APIC ID
+ * @param address 启动代码的物理地址 须4K对齐且低于1M
+ */
+void apic_send_startup(dword apic_id, qword address);
+
+/**
+ * @brief 以周期模式启动当前CPU的本地APIC定时器
+ * 首次调用时借助PIT通道2测定定时器频率
+ *
+ * @param hz 每秒中断次数
+ */
+void init_apic_timer(dword hz);
@@ -0,0 +1,127 @@
+/**
+ * @file cpu.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief CPU管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/cpu.h>
+#include <cpu/apic.h>
+#include <cpu/gdt.h>
+#include <tay/boot.h>
+#include <tay/cr.h>
+#include <tay/cpuid.h>
+
+/** 已上线的CPU数 */
+int cpu_num = 0;
+
+/** 已登记的CPU数(含尚未启动的CPU) */
+int cpu_present_num = 0;
+
+/** 已上线的CPU */
+CPUMask cpu_online_mask = 0;
+
+/** 各CPU的APIC ID */
+dword cpu_apic_ids[MAX_CPU_NUM];
+
+/** APIC ID右移该位数得到末级缓存号 */
+int cpu_llc_shift = 0;
+
+/**
+ * @brief 由CPUID 4号功能计算末级缓存号的位移
+ * 共享末级缓存的逻辑处理器的APIC ID只有低位不同
+ * CPU不报告缓存结构时每个CPU自成一组
+ *
+ */
+static void init_llc_shift(void) {
+    if (cpuid_max_leaf() < 0x04) {
+        return;
+    }
+
+    int level = 0;
+    dword sharing = 1;
+    for (dword index = 0 ; ; index ++) {
+        CPUIDResult result = cpuid(0x04, index);
+        int type = CPUID_04_EAX_TYPE(result.eax);
+        if (type == 0) {
+            break;
+        }
+        // 指令缓存
+        if (type == 2 || CPUID_04_EAX_LEVEL(result.eax) <= level) {
+            continue;
+        }
+
+        level = CPUID_04_EAX_LEVEL(result.eax);
+        sharing = CPUID_04_EAX_SHARING(result.eax);
+    }
+
+    while ((1u << cpu_llc_shift) < sharing) {
+        cpu_llc_shift ++;
+    }
+}
+
+/**
+ * @brief 初始化CPU管理
+ * 将当前CPU登记为0号CPU
+ *
+ */
+void init_cpu(void) {
+    // 换用内核自己的GDT 启动栈顶作为0号CPU的特权级0栈
+    load_gdt(0, KERNEL_VIRT_BASE + KERNEL_LOAD_ADDR);
+    // 建立每CPU区域前 每CPU变量的访问落到模板上
+    // 两个GS基址都为0 此时入口代码即使swapgs也不会改变GS基址
+    wrmsr(MSR_GS_BASE_ADDR, 0);
+    wrmsr(MSR_KERNEL_GS_BASE_ADDR, 0);
+    init_apic();
+    init_llc_shift();
+    set_cpu_online(register_cpu(apic_id()));
+}
+
+/**
+ * @brief 登记CPU 分配CPU号
+ * 登记后CPU尚未上线 不参与调度
+ *
+ * @param apic_id APIC ID
+ * @return CPU号 失败时为-1
+ */
+int register_cpu(dword apic_id) {
+    int cpu = __atomic_fetch_add(&cpu_present_num, 1, __ATOMIC_SEQ_CST);
+    if (cpu >= MAX_CPU_NUM) {
+        __atomic_fetch_sub(&cpu_present_num, 1, __ATOMIC_SEQ_CST);
+        return -1;
+    }
+
+    cpu_apic_ids[cpu] = apic_id;
+    return cpu;
+}
+
+/**
+ * @brief 由APIC ID查找已登记的CPU
+ *
+ * @param apic_id APIC ID
+ * @return CPU号 未登记时为-1
+ */
+int apic_id_to_cpu(dword apic_id) {
+    for (int cpu = 0 ; cpu < cpu_present_num ; cpu ++) {
+        if (cpu_apic_ids[cpu] == apic_id) {
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 标记CPU上线
+ * 此后调度器与TLB击落会考虑该CPU
+ *
+ * @param cpu CPU号
+ */
+void set_cpu_online(int cpu) {
+    cpumask_set(&cpu_online_mask, cpu);
+    __atomic_fetch_add(&cpu_num, 1, __ATOMIC_SEQ_CST);
+}
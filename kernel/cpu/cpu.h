@@ -0,0 +1,136 @@
+/**
+ * @file cpu.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief CPU管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <cpu/percpu.h>
+
+/** 最大CPU数 */
+#define MAX_CPU_NUM (64)
+
+/**
+ * @brief CPU集合
+ * 第i位表示i号CPU
+ *
+ */
+typedef qword CPUMask;
+
+/** 包含全部CPU的集合 */
+#define CPU_MASK_ALL (~(CPUMask)0)
+
+/** 已上线的CPU数 */
+extern int cpu_num;
+
+/** 已登记的CPU数(含尚未启动的CPU) */
+extern int cpu_present_num;
+
+/** 已上线的CPU */
+extern CPUMask cpu_online_mask;
+
+/** 各CPU的APIC ID */
+extern dword cpu_apic_ids[MAX_CPU_NUM];
+
+/** APIC ID右移该位数得到末级缓存号 */
+extern int cpu_llc_shift;
+
+/**
+ * @brief 初始化CPU管理
+ * 将当前CPU登记为0号CPU
+ *
+ */
+void init_cpu(void);
+
+/**
+ * @brief 登记CPU 分配CPU号
+ * 登记后CPU尚未上线 不参与调度
+ *
+ * @param apic_id APIC ID
+ * @return CPU号 失败时为-1
+ */
+int register_cpu(dword apic_id);
+
+/**
+ * @brief 由APIC ID查找已登记的CPU
+ *
+ * @param apic_id APIC ID
+ * @return CPU号 未登记时为-1
+ */
+int apic_id_to_cpu(dword apic_id);
+
+/**
+ * @brief 标记CPU上线
+ * 此后调度器与TLB击落会考虑该CPU
+ *
+ * @param cpu CPU号
+ */
+void set_cpu_online(int cpu);
+
+/**
+ * @brief 获取当前CPU号
+ * 从每CPU区域读取 建立区域前读到模板中的0
+ *
+ * @return 当前CPU号
+ */
+static inline int current_cpu_id(void) {
+    return this_cpu_read(cpu_number);
+}
+
+/**
+ * @brief 两个CPU是否共享末级缓存
+ *
+ * @param cpu1 CPU号
+ * @param cpu2 CPU号
+ * @return 是否共享
+ */
+static inline bool cpus_share_cache(int cpu1, int cpu2) {
+    return (cpu_apic_ids[cpu1] >> cpu_llc_shift) == (cpu_apic_ids[cpu2] >> cpu_llc_shift);
+}
+
+/**
+ * @brief 遍历CPU集合
+ *
+ */
+#define for_each_cpu(cpu, mask) \
+    for (int cpu = 0 ; cpu < MAX_CPU_NUM ; cpu ++) \
+        if (cpumask_test((mask), cpu))
+
+/**
+ * @brief 原子地向CPU集合中加入CPU
+ *
+ * @param mask CPU集合
+ * @param cpu CPU号
+ */
+static inline void cpumask_set(CPUMask *mask, int cpu) {
+    __atomic_fetch_or(mask, 1ull << cpu, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 原子地从CPU集合中移除CPU
+ *
+ * @param mask CPU集合
+ * @param cpu CPU号
+ */
+static inline void cpumask_clear(CPUMask *mask, int cpu) {
+    __atomic_fetch_and(mask, ~(1ull << cpu), __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief CPU是否在集合中
+ *
+ * @param mask CPU集合
+ * @param cpu CPU号
+ * @return 是否在集合中
+ */
+static inline bool cpumask_test(CPUMask mask, int cpu) {
+    return (mask & (1ull << cpu)) != 0;
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+/**
+ * @file gdt.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 各CPU的GDT与TSS
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/gdt.h>
+#include <cpu/cpu.h>
+#include <cpu/interrupt.h>
+#include <mm/kstack.h>
+#include <basec/logger.h>
+#include <string.h>
+
+// 各CPU的GDT 加载器的GDT只用于进入内核
+static Descriptor gdts[MAX_CPU_NUM][GDT_ENTRY_NUM] __attribute__((aligned(64)));
+// 各CPU的TSS
+static TSS64 tsses[MAX_CPU_NUM] __attribute__((aligned(64)));
+
+/**
+ * @brief 构建64位代码/数据段描述符
+ * 长模式下基址与界限不起作用
+ *
+ * @param type 段类型
+ * @param dpl 特权级
+ * @param code 是否为代码段
+ * @return 描述符
+ */
+static Descriptor build_segment(word type, word dpl, bool code) {
+    RawDesc raw = {
+        .limit = 0xFFFFF,
+        .base = 0,
+        .DPL = dpl,
+        .type = type,
+        .S = true,
+        .P = true,
+        .AVL = false,
+        .L = code,
+        .DB = ! code,
+        .G = true
+    };
+    return build_desc(raw);
+}
+
+/**
+ * @brief 构建TSS描述符
+ *
+ * @param tss TSS
+ * @return TSS描述符
+ */
+static TSSDescriptor build_tss_desc(TSS64 *tss) {
+    qword base = (qword)tss;
+    dword limit = sizeof(TSS64) - 1;
+
+    TSSDescriptor desc = {};
+    desc.limit0 = limit & 0xFFFF;
+    desc.limit1 = (limit >> 16) & 0xF;
+    desc.base0 = base & 0xFFFF;
+    desc.base1 = (base >> 16) & 0xFF;
+    desc.base2 = (base >> 24) & 0xFF;
+    desc.base3 = base >> 32;
+    desc.type = GTYPE_386_TSS;
+    desc.DPL = DPL_KERNEL;
+    desc.P = true;
+    desc.g = false;
+    return desc;
+}
+
+/**
+ * @brief 为CPU建立GDT与TSS并在当前CPU上加载
+ * 重新加载CS/DS/ES/SS 不改动FS/GS 保留已分配的IST栈
+ *
+ * @param cpu 当前CPU号
+ * @param rsp0 特权级切换到0时的栈
+ */
+void load_gdt(int cpu, qword rsp0) {
+    Descriptor *gdt = gdts[cpu];
+    TSS64 *tss = &tsses[cpu];
+
+    tss->rsp0 = rsp0;
+    // 没有I/O许可位图
+    tss->IOPB = sizeof(TSS64);
+
+    memset(gdt, 0, sizeof(gdts[cpu]));
+    gdt[GDT_KERNEL_CODE_IDX] = build_segment(DTYPE_XRCODE, DPL_KERNEL, true);
+    gdt[GDT_KERNEL_DATA_IDX] = build_segment(DTYPE_RWDATA, DPL_KERNEL, false);
+    gdt[GDT_USER_DATA_IDX] = build_segment(DTYPE_RWDATA, DPL_USER, false);
+    gdt[GDT_USER_CODE_IDX] = build_segment(DTYPE_XRCODE, DPL_USER, true);
+    *(TSSDescriptor *)&gdt[GDT_TSS_IDX] = build_tss_desc(tss);
+
+    DPTR gdtr = {
+        .size = sizeof(gdts[cpu]) - 1,
+        .address = (qword)gdt
+    };
+    asm volatile ("lgdt %0" : : "m"(gdtr));
+
+    // 远返回重新加载CS
+    asm volatile (
+        "pushq %0\n\t"
+        "leaq 1f(%%rip), %%rax\n\t"
+        "pushq %%rax\n\t"
+        "lretq\n\t"
+        "1:\n\t"
+        "movw %w1, %%ds\n\t"
+        "movw %w1, %%es\n\t"
+        "movw %w1, %%ss"
+        : : "i"(KERNEL_CS), "r"(KERNEL_DS) : "rax", "memory");
+
+    asm volatile ("ltr %w0" : : "r"(TSS_SEL));
+}
+
+/**
+ * @brief 为CPU分配IST栈 填入其TSS
+ * 其它CPU的IST栈由0号CPU在启动它之前分配
+ *
+ * @param cpu CPU号
+ * @return 是否成功
+ */
+bool alloc_ist_stacks(int cpu) {
+    TSS64 *tss = &tsses[cpu];
+    if (tss->ist1 != 0) {
+        return true;
+    }
+
+    void *stacks[IST_NUM];
+    for (int i = 0 ; i < IST_NUM ; i ++) {
+        stacks[i] = alloc_kernel_stack();
+        if (stacks[i] == NULL) {
+            while (-- i >= 0) {
+                free_kernel_stack(stacks[i]);
+            }
+            return false;
+        }
+    }
+
+    tss->ist1 = (qword)kernel_stack_top(stacks[IST_DOUBLE_FAULT - 1]);
+    tss->ist2 = (qword)kernel_stack_top(stacks[IST_NMI - 1]);
+    tss->ist3 = (qword)kernel_stack_top(stacks[IST_MACHINE_CHECK - 1]);
+    return true;
+}
+
+/**
+ * @brief 为0号CPU分配IST栈 并让双重错误 NMI与机器检查改用IST
+ * 需在vmalloc初始化之后调用
+ *
+ */
+void init_ist(void) {
+    if (! alloc_ist_stacks(0)) {
+        log_error("无法分配IST栈");
+        return;
+    }
+
+    // IDT为各CPU共用 其它CPU上线前都已分配好IST栈
+    set_interrupt_ist(DOUBLE_FAULT_VECTOR, IST_DOUBLE_FAULT);
+    set_interrupt_ist(NMI_VECTOR, IST_NMI);
+    set_interrupt_ist(MACHINE_CHECK_VECTOR, IST_MACHINE_CHECK);
+}
+
+/**
+ * @brief 设置当前CPU的TSS中特权级0的栈
+ * 切换线程时调用 从用户态进入内核时使用该线程的内核栈
+ *
+ * @param rsp0 栈顶
+ */
+void set_kernel_stack(qword rsp0) {
+    tsses[current_cpu_id()].rsp0 = rsp0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file gdt.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 各CPU的GDT与TSS
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <tay/desc.h>
+
+/** 内核代码段 */
+#define GDT_KERNEL_CODE_IDX (1)
+/** 内核数据段 */
+#define GDT_KERNEL_DATA_IDX (2)
+/** 用户数据段(SYSRET要求其紧邻用户代码段之前) */
+#define GDT_USER_DATA_IDX   (3)
+/** 用户代码段 */
+#define GDT_USER_CODE_IDX   (4)
+/** TSS 占两项 */
+#define GDT_TSS_IDX         (5)
+/** GDT项数 */
+#define GDT_ENTRY_NUM       (7)
+
+/** 内核代码段选择子 */
+#define KERNEL_CS (GDT_KERNEL_CODE_IDX << 3)
+/** 内核数据段选择子 */
+#define KERNEL_DS (GDT_KERNEL_DATA_IDX << 3)
+/** 用户数据段选择子 */
+#define USER_DS   ((GDT_USER_DATA_IDX << 3) | DPL_USER)
+/** 用户代码段选择子 */
+#define USER_CS   ((GDT_USER_CODE_IDX << 3) | DPL_USER)
+/** TSS选择子 */
+#define TSS_SEL   (GDT_TSS_IDX << 3)
+
+/** 双重错误使用的IST 内核栈溢出时仍有可用的栈 */
+#define IST_DOUBLE_FAULT  (1)
+/** NMI使用的IST */
+#define IST_NMI           (2)
+/** 机器检查使用的IST */
+#define IST_MACHINE_CHECK (3)
+/** 使用的IST数 */
+#define IST_NUM           (3)
+
+/**
+ * @brief 为CPU建立GDT与TSS并在当前CPU上加载
+ * 重新加载CS/DS/ES/SS 不改动FS/GS 保留已分配的IST栈
+ *
+ * @param cpu 当前CPU号
+ * @param rsp0 特权级切换到0时的栈
+ */
+void load_gdt(int cpu, qword rsp0);
+
+/**
+ * @brief 为CPU分配IST栈 填入其TSS
+ * 其它CPU的IST栈由0号CPU在启动它之前分配
+ *
+ * @param cpu CPU号
+ * @return 是否成功
+ */
+bool alloc_ist_stacks(int cpu);
+
+/**
+ * @brief 为0号CPU分配IST栈 并让双重错误 NMI与机器检查改用IST
+ * 需在vmalloc初始化之后调用
+ *
+ */
+void init_ist(void);
+
+/**
+ * @brief 设置当前CPU的TSS中特权级0的栈
+ * 切换线程时调用 从用户态进入内核时使用该线程的内核栈
+ *
+ * @param rsp0 栈顶
+ */
+void set_kernel_stack(qword rsp0);
@@ -0,0 +1,109 @@
+/**
+ * @file idle.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 空闲循环
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/idle.h>
+#include <sched/sched.h>
+#include <mm/zero.h>
+#include <mm/compact.h>
+#include <mm/reclaim.h>
+#include <mm/ksm.h>
+#include <mm/huge.h>
+#include <basec/logger.h>
+
+/** 后台线程无事可做时的睡眠时长(时钟中断数) */
+#define BACKGROUND_SLEEP_TICKS (SCHED_HZ / 10)
+
+/**
+ * @brief 后台工作
+ *
+ * @return 是否做了工作
+ */
+typedef bool (*BackgroundWork)(void);
+
+/**
+ * @brief 后台线程
+ *
+ */
+typedef struct {
+    /** 线程名 */
+    const char *name;
+    /** 每轮的工作 */
+    BackgroundWork work;
+} BackgroundThread;
+
+// 原先在空闲循环中依次执行的后台工作 各自成为线程 由调度器分时
+static const BackgroundThread background_threads[] = {
+    { "ksmd", ksm_run },
+    { "kcompactd", compact_background },
+    { "khugepaged", khugepaged_run }
+};
+
+/**
+ * @brief 后台线程的主循环
+ * 有工作时一直做(由时间片抢占) 无事可做时睡眠
+ *
+ * @param arg 后台线程
+ */
+static void background_thread_main(void *arg) {
+    const BackgroundThread *background = arg;
+    while (true) {
+        if (! background->work()) {
+            thread_sleep(BACKGROUND_SLEEP_TICKS);
+        }
+    }
+}
+
+/**
+ * @brief 启动后台线程
+ * 需在调度器初始化之后调用
+ *
+ */
+void start_background_threads(void) {
+    // kswapd每个节点一个 由分配路径直接唤醒
+    start_kswapd();
+
+    int num = sizeof(background_threads) / sizeof(BackgroundThread);
+    for (int i = 0 ; i < num ; i ++) {
+        if (create_kernel_thread(background_threads[i].name, background_thread_main,
+            (void *)&background_threads[i]) == NULL) {
+            log_error("无法创建后台线程%s", background_threads[i].name);
+        }
+    }
+}
+
+/**
+ * @brief 空闲循环
+ * 运行队列为空时从其它CPU窃取线程 否则预先清零空闲页 没有工作时停机等待中断
+ *
+ */
+void cpu_idle_loop(void) {
+    while (true) {
+        while (! this_cpu_read(need_resched)) {
+            // 先从其它CPU窃取线程 窃取到时已设置need_resched
+            if (idle_balance()) {
+                break;
+            }
+            if (zero_pool_refill()) {
+                continue;
+            }
+
+            // 检查与停机之间不能漏掉中断 sti的下一条指令执行完才响应中断
+            local_irq_disable();
+            if (this_cpu_read(need_resched)) {
+                local_irq_enable();
+                break;
+            }
+            asm volatile ("sti; hlt" : : : "memory");
+        }
+        schedule();
+    }
+}
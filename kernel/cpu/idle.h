@@ -0,0 +1,29 @@
+/**
+ * @file idle.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 空闲循环
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/**
+ * @brief 启动后台线程
+ * 需在调度器初始化之后调用
+ *
+ */
+void start_background_threads(void);
+
+/**
+ * @brief 空闲循环
+ * 运行队列为空时从其它CPU窃取线程 否则预先清零空闲页 没有工作时停机等待中断
+ *
+ */
+void cpu_idle_loop(void);
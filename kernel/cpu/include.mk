@@ -0,0 +1,9 @@
+objects += cpu/cpu.o
+objects += cpu/apic.o
+objects += cpu/idle.o
+objects += cpu/percpu.o
+objects += cpu/interrupt.o
+objects += cpu/entry.o
+objects += cpu/gdt.o
+objects += cpu/smp.o
+objects += cpu/trampoline.o
\ No newline at end of file
@@ -0,0 +1,177 @@
+/**
+ * @file interrupt.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief IDT与中断分发
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/interrupt.h>
+#include <cpu/apic.h>
+#include <cpu/cpu.h>
+#include <cpu/gdt.h>
+#include <cpu/irqflags.h>
+#include <sched/sched.h>
+#include <mm/vmm.h>
+#include <mm/fault.h>
+#include <mm/tlb.h>
+#include <tay/desc.h>
+#include <tay/io.h>
+#include <tay/cr.h>
+#include <basec/logger.h>
+#include <stddef.h>
+
+/** entry.S中的入口 每个16字节 */
+extern byte interrupt_stubs[];
+
+// IDT
+static GateDescriptor idt[INTERRUPT_NUM];
+// IDTR
+static DPTR idtr;
+// 各向量的处理程序
+static InterruptHandler interrupt_handlers[INTERRUPT_NUM];
+
+// 异常名
+static const char *exception_names[EXCEPTION_NUM] = {
+    "#DE 除以0", "#DB 调试", "NMI", "#BP 断点",
+    "#OF 溢出", "#BR 越界", "#UD 无效的操作码", "#NM 设备不可用",
+    "#DF 双重错误", "协处理器段溢出", "#TS 无效TSS", "#NP 缺少段",
+    "#SS 栈段错误", "#GP 通用保护错误", "#PF 缺页", "保留",
+    "#MF x87浮点错误", "#AC 对齐检测", "#MC 机器检测", "#XF SIMD浮点错误",
+    "#VE 虚拟化异常", "#CP 控制保护错误", "保留", "保留",
+    "保留", "保留", "保留", "保留",
+    "#HV Hypervisor注入异常", "#VC VMM通信异常", "#SX 安全性错误", "保留"
+};
+
+/**
+ * @brief 打印现场并停机
+ *
+ * @param frame 中断现场
+ */
+static void die(InterruptFrame *frame) {
+    log_fatal("CPU%d 在%04X:%p处发生异常: %s", current_cpu_id(), (int)frame->cs, (void *)frame->rip,
+        exception_names[frame->vector]);
+    log_fatal("错误码=%p CR2=%p", (void *)frame->error_code, (void *)rdcr2().PFLA);
+    log_fatal("rax=%p rbx=%p rcx=%p rdx=%p", (void *)frame->rax, (void *)frame->rbx,
+        (void *)frame->rcx, (void *)frame->rdx);
+    log_fatal("rsi=%p rdi=%p rbp=%p rsp=%p", (void *)frame->rsi, (void *)frame->rdi,
+        (void *)frame->rbp, (void *)frame->rsp);
+    log_fatal("rflags=%p", (void *)frame->rflags);
+
+    while (true) {
+        asm volatile ("cli; hlt");
+    }
+}
+
+/**
+ * @brief 处理异常
+ *
+ * @param frame 中断现场
+ */
+static void handle_exception(InterruptFrame *frame) {
+    if (frame->vector == PAGE_FAULT_VECTOR) {
+        // 开中断前取出CR2与地址空间 之后可能被抢占或再次缺页
+        qword address = rdcr2().PFLA;
+        AddressSpace *address_space = cpu_address_space(current_cpu_id());
+
+        // 中断门进入时关了中断 而处理缺页会持有地址空间的锁并同步等待TLB击落
+        // 关着中断等锁的CPU无法响应击落IPI 会与持锁者互相等待
+        // 被打断处原本开着中断时恢复开中断
+        if (frame->rflags & RFLAGS_IF) {
+            local_irq_enable();
+        }
+        bool solved = handle_page_fault(address_space, address, frame->error_code);
+        local_irq_disable();
+
+        if (solved) {
+            return;
+        }
+    }
+
+    die(frame);
+}
+
+/**
+ * @brief 中断分发
+ * 由entry.S调用 外部中断与IPI返回前检查是否需要抢占被中断的线程
+ *
+ * @param frame 中断现场
+ */
+void interrupt_dispatch(InterruptFrame *frame) {
+    if (frame->vector < EXCEPTION_NUM) {
+        handle_exception(frame);
+        return;
+    }
+
+    irq_enter();
+    InterruptHandler handler = interrupt_handlers[frame->vector];
+    if (handler != NULL) {
+        handler(frame);
+    }
+    else if (frame->vector != APIC_SPURIOUS_VECTOR) {
+        log_warn("未处理的中断%02X", (int)frame->vector);
+    }
+    if (frame->vector != APIC_SPURIOUS_VECTOR) {
+        apic_eoi();
+    }
+    irq_exit();
+
+    if (this_cpu_read(preempt_count) == 0 && this_cpu_read(need_resched)) {
+        preempt_schedule_irq();
+    }
+}
+
+/**
+ * @brief 在当前CPU上加载IDT
+ * 其它CPU上线时调用
+ *
+ */
+void load_idt(void) {
+    asm volatile ("lidt %0" : : "m"(idtr));
+}
+
+/**
+ * @brief 初始化IDT并在当前CPU上加载
+ *
+ */
+void init_interrupt(void) {
+    // 各CPU共用IDT 各自的GDT中内核代码段位置相同
+    for (int vector = 0 ; vector < INTERRUPT_NUM ; vector ++) {
+        idt[vector] = build_gate(GTYPE_386_INT_GATE, interrupt_stubs + vector * 16, 0, KERNEL_CS);
+    }
+
+    idtr.address = (qword)idt;
+    idtr.size = sizeof(idt) - 1;
+    load_idt();
+
+    register_interrupt_handler(TLB_SHOOTDOWN_VECTOR, tlb_shootdown_interrupt);
+}
+
+/**
+ * @brief 登记中断处理程序
+ *
+ * @param vector 向量号(不小于EXCEPTION_NUM)
+ * @param handler 处理程序
+ */
+void register_interrupt_handler(byte vector, InterruptHandler handler) {
+    if (vector < EXCEPTION_NUM) {
+        log_error("向量%02X为异常 不能登记处理程序", (int)vector);
+        return;
+    }
+    interrupt_handlers[vector] = handler;
+}
+
+/**
+ * @brief 让向量改用IST栈
+ * 各CPU的TSS中该IST项都须已填好
+ *
+ * @param vector 向量号
+ * @param ist IST号(1~7)
+ */
+void set_interrupt_ist(byte vector, byte ist) {
+    idt[vector].bits.ist = ist;
+}
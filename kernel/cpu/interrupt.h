@@ -0,0 +1,103 @@
+/**
+ * @file interrupt.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief IDT与中断分发
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** 异常向量数 */
+#define EXCEPTION_NUM (32)
+/** 中断向量数 */
+#define INTERRUPT_NUM (256)
+
+/** NMI向量 */
+#define NMI_VECTOR           (0x02)
+/** 双重错误向量 */
+#define DOUBLE_FAULT_VECTOR  (0x08)
+/** 缺页异常向量 */
+#define PAGE_FAULT_VECTOR    (0x0E)
+/** 机器检查向量 */
+#define MACHINE_CHECK_VECTOR (0x12)
+/** 本地APIC定时器向量 */
+#define APIC_TIMER_VECTOR (0xEF)
+/** 重新调度IPI向量 */
+#define RESCHEDULE_VECTOR (0xFC)
+
+/**
+ * @brief 中断现场
+ * 由entry.S中的入口压栈 顺序与压栈顺序相反
+ *
+ */
+typedef struct {
+    qword r15;
+    qword r14;
+    qword r13;
+    qword r12;
+    qword r11;
+    qword r10;
+    qword r9;
+    qword r8;
+    qword rbp;
+    qword rdi;
+    qword rsi;
+    qword rdx;
+    qword rcx;
+    qword rbx;
+    qword rax;
+    /** 向量号 */
+    qword vector;
+    /** 错误码 没有错误码的向量为0 */
+    qword error_code;
+    /** 以下由CPU压栈 */
+    qword rip;
+    qword cs;
+    qword rflags;
+    qword rsp;
+    qword ss;
+} InterruptFrame;
+
+/**
+ * @brief 中断处理程序
+ * 在关中断且抢占计数含HARDIRQ_OFFSET的情况下调用 返回后由分发程序发送EOI
+ *
+ */
+typedef void (*InterruptHandler)(InterruptFrame *frame);
+
+/**
+ * @brief 初始化IDT并在当前CPU上加载
+ *
+ */
+void init_interrupt(void);
+
+/**
+ * @brief 在当前CPU上加载IDT
+ * 其它CPU上线时调用
+ *
+ */
+void load_idt(void);
+
+/**
+ * @brief 登记中断处理程序
+ *
+ * @param vector 向量号(不小于EXCEPTION_NUM)
+ * @param handler 处理程序
+ */
+void register_interrupt_handler(byte vector, InterruptHandler handler);
+
+/**
+ * @brief 让向量改用IST栈
+ * 各CPU的TSS中该IST项都须已填好
+ *
+ * @param vector 向量号
+ * @param ist IST号(1~7)
+ */
+void set_interrupt_ist(byte vector, byte ist);
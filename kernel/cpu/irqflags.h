@@ -0,0 +1,76 @@
+/**
+ * @file irqflags.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 本CPU的中断开关
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** RFLAGS.IF */
+#define RFLAGS_IF (1ull << 9)
+
+/**
+ * @brief 读RFLAGS
+ *
+ * @return RFLAGS
+ */
+static inline qword read_rflags(void) {
+    qword flags;
+    asm volatile ("pushfq; popq %0" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+/**
+ * @brief 关闭本CPU的中断
+ *
+ */
+static inline void local_irq_disable(void) {
+    asm volatile ("cli" : : : "memory");
+}
+
+/**
+ * @brief 开启本CPU的中断
+ *
+ */
+static inline void local_irq_enable(void) {
+    asm volatile ("sti" : : : "memory");
+}
+
+/**
+ * @brief 关闭本CPU的中断并返回原先的RFLAGS
+ *
+ * @return 原先的RFLAGS
+ */
+static inline qword local_irq_save(void) {
+    qword flags = read_rflags();
+    local_irq_disable();
+    return flags;
+}
+
+/**
+ * @brief 恢复local_irq_save之前的中断状态
+ *
+ * @param flags local_irq_save的返回值
+ */
+static inline void local_irq_restore(qword flags) {
+    if (flags & RFLAGS_IF) {
+        local_irq_enable();
+    }
+}
+
+/**
+ * @brief 本CPU的中断是否关闭
+ *
+ * @return 是否关闭
+ */
+static inline bool irqs_disabled(void) {
+    return (read_rflags() & RFLAGS_IF) == 0;
+}
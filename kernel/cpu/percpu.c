@@ -0,0 +1,200 @@
+/**
+ * @file percpu.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 每CPU变量
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/percpu.h>
+#include <cpu/cpu.h>
+#include <tay/cr.h>
+#include <mm/memblock.h>
+#include <mm/direct_map.h>
+#include <mm/buddy.h>
+#include <mm/numa.h>
+#include <sync/spinlock.h>
+#include <basec/logger.h>
+#include <string.h>
+
+/** 各CPU副本相对模板的偏移 */
+qword per_cpu_offset[MAX_CPU_NUM];
+
+/** 当前CPU号 */
+DEFINE_PER_CPU(int, cpu_number);
+/** 当前CPU副本相对模板的偏移 */
+DEFINE_PER_CPU(qword, this_cpu_offset);
+
+// 静态部分的大小(按页对齐 动态变量的对齐最大可到一页)
+static qword percpu_static_size = 0;
+// 已建立副本的CPU
+static CPUMask percpu_ready_mask = 0;
+// 各动态单位是否已分配
+static bool percpu_used[PERCPU_UNIT_NUM];
+// 各动态分配的单位数 记在首个单位上
+static word percpu_sizes[PERCPU_UNIT_NUM];
+// 动态分配的锁
+static Spinlock percpu_lock = (Spinlock)SPINLOCK_INIT;
+
+/**
+ * @brief 每CPU区域的大小
+ *
+ * @return 大小
+ */
+static inline qword percpu_area_size(void) {
+    return percpu_static_size + PERCPU_DYNAMIC_SIZE;
+}
+
+/**
+ * @brief 填写CPU的副本并登记
+ * 静态部分复制模板 动态部分清零
+ * 模板中的抢占计数随之复制 因此0号CPU须在不持锁时调用
+ *
+ * @param cpu CPU号
+ * @param area 副本
+ */
+static void install_percpu_area(int cpu, byte *area) {
+    qword template_size = __per_cpu_end - __per_cpu_start;
+    memcpy(area, __per_cpu_start, template_size);
+    memset(area + template_size, 0, percpu_area_size() - template_size);
+
+    per_cpu_offset[cpu] = (qword)area - (qword)__per_cpu_start;
+    per_cpu(cpu_number, cpu) = cpu;
+    per_cpu(this_cpu_offset, cpu) = per_cpu_offset[cpu];
+    cpumask_set(&percpu_ready_mask, cpu);
+}
+
+/**
+ * @brief 在当前CPU上加载其每CPU区域的GS基址
+ * 用户态的GS基址(KERNEL_GS_BASE)置为0
+ *
+ * @param cpu 当前CPU号
+ */
+void load_percpu_base(int cpu) {
+    wrmsr(MSR_GS_BASE_ADDR, per_cpu_offset[cpu]);
+    wrmsr(MSR_KERNEL_GS_BASE_ADDR, 0);
+}
+
+/**
+ * @brief 建立0号CPU的每CPU区域并切换GS基址
+ * 在直接映射建立后调用 区域取自memblock
+ * 模板中此前写入的值会随之复制 0号CPU看到的状态保持连续
+ *
+ */
+void init_percpu(void) {
+    percpu_static_size = ((__per_cpu_end - __per_cpu_start) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+    qword phys = memblock_alloc(percpu_area_size(), PAGE_SIZE);
+    if (phys == MEMBLOCK_ALLOC_FAILED) {
+        log_fatal("无法分配每CPU区域");
+        while (true);
+    }
+
+    install_percpu_area(0, phys_to_virt(phys));
+    load_percpu_base(0);
+
+    log_info("每CPU区域: 静态%dB 动态%dKB", (int)percpu_static_size, PERCPU_DYNAMIC_SIZE >> 10);
+}
+
+/**
+ * @brief 为其它CPU建立每CPU区域
+ * 区域取自CPU所在节点 复制模板中的静态部分
+ *
+ * @param cpu CPU号
+ * @return 是否成功
+ */
+bool setup_percpu_area(int cpu) {
+    if (cpumask_test(percpu_ready_mask, cpu)) {
+        return true;
+    }
+
+    int order = 0;
+    while ((PAGE_SIZE << order) < percpu_area_size()) {
+        order ++;
+    }
+
+    PageFrame *frame = alloc_frames_node(cpu_to_node(cpu), order, 0);
+    if (frame == NULL) {
+        return false;
+    }
+
+    spin_lock(&percpu_lock);
+    install_percpu_area(cpu, frame_to_ptr(frame));
+    spin_unlock(&percpu_lock);
+    return true;
+}
+
+/**
+ * @brief 分配动态每CPU变量
+ * 在每个CPU的副本中各占一份 均清零
+ *
+ * @param size 大小
+ * @param align 对齐
+ * @return 模板中的地址 经per_cpu_ptr/this_cpu_ptr访问 失败时为NULL
+ */
+void *__alloc_percpu(qword size, qword align) {
+    // 建立副本前模板之后没有动态部分
+    if (percpu_ready_mask == 0 || size == 0 || size > PERCPU_DYNAMIC_SIZE || align > PAGE_SIZE) {
+        return NULL;
+    }
+
+    int units = (size + PERCPU_UNIT_SIZE - 1) / PERCPU_UNIT_SIZE;
+    int step = align > PERCPU_UNIT_SIZE ? align / PERCPU_UNIT_SIZE : 1;
+
+    spin_lock(&percpu_lock);
+
+    // 首次适配
+    int start = -1;
+    for (int unit = 0 ; unit + units <= PERCPU_UNIT_NUM ; unit += step) {
+        int i = 0;
+        while (i < units && ! percpu_used[unit + i]) {
+            i ++;
+        }
+        if (i == units) {
+            start = unit;
+            break;
+        }
+    }
+
+    if (start == -1) {
+        spin_unlock(&percpu_lock);
+        return NULL;
+    }
+
+    for (int i = 0 ; i < units ; i ++) {
+        percpu_used[start + i] = true;
+    }
+    percpu_sizes[start] = units;
+
+    qword offset = percpu_static_size + (qword)start * PERCPU_UNIT_SIZE;
+    for_each_cpu (cpu, percpu_ready_mask) {
+        memset(__per_cpu_start + offset + per_cpu_offset[cpu], 0, (qword)units * PERCPU_UNIT_SIZE);
+    }
+
+    spin_unlock(&percpu_lock);
+    return __per_cpu_start + offset;
+}
+
+/**
+ * @brief 释放动态每CPU变量
+ *
+ * @param ptr __alloc_percpu返回的地址
+ */
+void free_percpu(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    int start = ((byte *)ptr - __per_cpu_start - percpu_static_size) / PERCPU_UNIT_SIZE;
+
+    spin_lock(&percpu_lock);
+    for (int i = 0 ; i < percpu_sizes[start] ; i ++) {
+        percpu_used[start + i] = false;
+    }
+    percpu_sizes[start] = 0;
+    spin_unlock(&percpu_lock);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file percpu.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 每CPU变量
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/*
+ * 静态每CPU变量链接在.data..percpu节中 这一节是模板
+ * 每个CPU有一块副本(静态部分 + 动态部分) 其GS基址为副本与模板的偏移
+ * 于是模板中变量的地址加上GS基址即为当前CPU副本中的地址
+ * this_cpu_*对模板地址做GS相对访问 只需一条指令
+ * 建立副本前GS基址为0 访问直接落到模板上
+ * 副本位于直接映射区 低于内核映像中的模板 因此偏移恒为负
+ * 用户态运行时GS基址属于用户 偏移存放在KERNEL_GS_BASE中 由入口代码swapgs换回
+ */
+
+/** 每CPU区域中动态部分的大小 */
+#define PERCPU_DYNAMIC_SIZE (64 * 1024)
+/** 动态分配的单位 */
+#define PERCPU_UNIT_SIZE (16)
+/** 动态部分的单位数 */
+#define PERCPU_UNIT_NUM (PERCPU_DYNAMIC_SIZE / PERCPU_UNIT_SIZE)
+
+/** 模板起始 */
+extern byte __per_cpu_start[];
+/** 模板结束 */
+extern byte __per_cpu_end[];
+
+/** 各CPU副本相对模板的偏移 */
+extern qword per_cpu_offset[];
+
+/**
+ * @brief 定义每CPU变量
+ *
+ */
+#define DEFINE_PER_CPU(type, name) \
+    __attribute__((section(".data..percpu"))) __typeof__(type) name
+
+/**
+ * @brief 声明每CPU变量
+ *
+ */
+#define DECLARE_PER_CPU(type, name) \
+    extern __attribute__((section(".data..percpu"))) __typeof__(type) name
+
+/** 当前CPU号 */
+DECLARE_PER_CPU(int, cpu_number);
+/** 当前CPU副本相对模板的偏移 */
+DECLARE_PER_CPU(qword, this_cpu_offset);
+
+/**
+ * @brief 读当前CPU的每CPU变量
+ *
+ */
+#define this_cpu_read(var) ({ \
+    __typeof__(var) __value; \
+    asm volatile ("mov %%gs:%1, %0" : "=r"(__value) : "m"(var)); \
+    __value; \
+})
+
+/**
+ * @brief 写当前CPU的每CPU变量
+ *
+ */
+#define this_cpu_write(var, value) ({ \
+    __typeof__(var) __value = (value); \
+    asm volatile ("mov %1, %%gs:%0" : "=m"(var) : "r"(__value) : "memory"); \
+})
+
+/**
+ * @brief 给当前CPU的每CPU变量加上一个数
+ * 操作数宽度由寄存器决定 一条指令完成读改写 无需关中断
+ *
+ */
+#define this_cpu_add(var, value) ({ \
+    __typeof__(var) __value = (value); \
+    asm volatile ("add %1, %%gs:%0" : "+m"(var) : "r"(__value) : "cc"); \
+})
+
+/**
+ * @brief 给当前CPU的每CPU变量减去一个数
+ *
+ */
+#define this_cpu_sub(var, value) this_cpu_add(var, -(__typeof__(var))(value))
+
+/**
+ * @brief 当前CPU的每CPU变量加一
+ *
+ */
+#define this_cpu_inc(var) this_cpu_add(var, 1)
+
+/**
+ * @brief 当前CPU的每CPU变量减一
+ *
+ */
+#define this_cpu_dec(var) this_cpu_sub(var, 1)
+
+/**
+ * @brief 指定CPU副本中的地址
+ *
+ */
+#define per_cpu_ptr(ptr, cpu) \
+    ((__typeof__(ptr))((qword)(ptr) + per_cpu_offset[(cpu)]))
+
+/**
+ * @brief 当前CPU副本中的地址
+ *
+ */
+#define this_cpu_ptr(ptr) \
+    ((__typeof__(ptr))((qword)(ptr) + this_cpu_read(this_cpu_offset)))
+
+/**
+ * @brief 指定CPU的每CPU变量
+ *
+ */
+#define per_cpu(var, cpu) (*per_cpu_ptr(&(var), cpu))
+
+/**
+ * @brief 建立0号CPU的每CPU区域并切换GS基址
+ * 在直接映射建立后调用 区域取自memblock
+ *
+ */
+void init_percpu(void);
+
+/**
+ * @brief 为其它CPU建立每CPU区域
+ * 区域取自CPU所在节点 复制模板中的静态部分
+ *
+ * @param cpu CPU号
+ * @return 是否成功
+ */
+bool setup_percpu_area(int cpu);
+
+/**
+ * @brief 在当前CPU上加载其每CPU区域的GS基址
+ * 用户态的GS基址(KERNEL_GS_BASE)置为0
+ *
+ * @param cpu 当前CPU号
+ */
+void load_percpu_base(int cpu);
+
+/**
+ * @brief 分配动态每CPU变量
+ * 在每个CPU的副本中各占一份 均清零
+ *
+ * @param size 大小
+ * @param align 对齐
+ * @return 模板中的地址 经per_cpu_ptr/this_cpu_ptr访问 失败时为NULL
+ */
+void *__alloc_percpu(qword size, qword align);
+
+/**
+ * @brief 分配动态每CPU变量
+ *
+ */
+#define alloc_percpu(type) \
+    ((type *)__alloc_percpu(sizeof(type), __alignof__(type)))
+
+/**
+ * @brief 释放动态每CPU变量
+ *
+ * @param ptr __alloc_percpu返回的地址
+ */
+void free_percpu(void *ptr);
@@ -0,0 +1,256 @@
+/**
+ * @file smp.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 多处理器启动
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <cpu/smp.h>
+#include <cpu/cpu.h>
+#include <cpu/apic.h>
+#include <cpu/gdt.h>
+#include <cpu/idle.h>
+#include <cpu/interrupt.h>
+#include <cpu/percpu.h>
+#include <acpi/acpi.h>
+#include <tay/cr.h>
+#include <mm/vmm.h>
+#include <mm/pcid.h>
+#include <mm/pat.h>
+#include <mm/kstack.h>
+#include <mm/direct_map.h>
+#include <sched/sched.h>
+#include <sched/clock.h>
+#include <sync/spinlock.h>
+#include <basec/logger.h>
+#include <string.h>
+
+/**
+ * @brief 启动代码的参数
+ * 布局与trampoline.S中的trampoline_params一致
+ *
+ */
+typedef struct {
+    /** 页表根的物理地址 须低于4G */
+    qword cr3;
+    /** CR4 不含PCIDE(只能在长模式下启用) */
+    qword cr4;
+    /** EFER */
+    qword efer;
+    /** CR0 */
+    qword cr0;
+    /** 栈顶 */
+    qword stack;
+    /** 长模式下的入口 */
+    qword entry;
+    /** 入口参数 */
+    qword arg;
+} TrampolineParams;
+
+/** 启动代码 */
+extern byte trampoline_start[];
+/** 启动代码结束 */
+extern byte trampoline_end[];
+/** 启动代码的参数 */
+extern byte trampoline_params[];
+
+/**
+ * @brief 登记MADT中的CPU
+ * 跳过已登记的(0号CPU与重复项)与无法寻址的CPU
+ *
+ * @param apic_id APIC ID
+ */
+static void add_madt_cpu(dword apic_id) {
+    if (apic_id_to_cpu(apic_id) >= 0) {
+        return;
+    }
+    if (apic_id >= 0xFF && ! x2apic_enabled()) {
+        log_warn("xAPIC模式下无法启动APIC ID为%d的CPU", (int)apic_id);
+        return;
+    }
+    if (register_cpu(apic_id) < 0) {
+        log_warn("CPU数超出上限, 忽略APIC ID为%d的CPU", (int)apic_id);
+    }
+}
+
+/**
+ * @brief 解析MADT
+ *
+ * @param madt MADT
+ */
+static void parse_madt(ACPIMADT *madt) {
+    byte *ptr = ((byte *)madt) + sizeof(ACPIMADT);
+    byte *end = ((byte *)madt) + madt->header.length;
+
+    while (ptr + sizeof(ACPIMADTEntry) <= end) {
+        ACPIMADTEntry *entry = (ACPIMADTEntry *)ptr;
+        if (entry->length == 0) {
+            break;
+        }
+
+        switch (entry->type) {
+        case MADT_LOCAL_APIC: {
+            ACPIMADTLocalAPIC *local_apic = (ACPIMADTLocalAPIC *)entry;
+            if (local_apic->flags & MADT_ENABLED) {
+                add_madt_cpu(local_apic->apic_id);
+            }
+            break;
+        }
+        case MADT_LOCAL_X2APIC: {
+            ACPIMADTLocalX2APIC *local_x2apic = (ACPIMADTLocalX2APIC *)entry;
+            if (local_x2apic->flags & MADT_ENABLED) {
+                add_madt_cpu(local_x2apic->x2apic_id);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        ptr += entry->length;
+    }
+}
+
+/**
+ * @brief 从MADT中发现其它CPU并登记
+ * 在ACPI初始化之后 NUMA初始化之前调用
+ *
+ */
+void init_smp(void) {
+    ACPIMADT *madt = (ACPIMADT *)acpi_find_table("APIC");
+    if (madt == NULL) {
+        log_info("没有MADT, 只使用0号CPU");
+        return;
+    }
+
+    parse_madt(madt);
+    log_info("MADT: %d个CPU", cpu_present_num);
+}
+
+/**
+ * @brief 忙等
+ *
+ * @param ns 纳秒数
+ */
+static void smp_delay(qword ns) {
+    qword end = sched_clock() + ns;
+    while (sched_clock() < end) {
+        cpu_relax();
+    }
+}
+
+/**
+ * @brief 其它CPU进入长模式后的入口
+ * 运行在其空闲线程的栈上 加载各项CPU状态后加入调度
+ *
+ * @param cpu CPU号
+ */
+static void ap_main(int cpu) {
+    Thread *idle = per_cpu(current_thread_ptr, cpu);
+
+    load_gdt(cpu, (qword)kernel_stack_top(idle->stack));
+    load_percpu_base(cpu);
+    load_idt();
+    load_pcid();
+    load_pat();
+    load_apic();
+
+    cpumask_set(&kernel_address_space.cpumask, cpu);
+    set_cpu_online(cpu);
+    log_info("CPU%d已上线, APIC ID=%d", cpu, (int)apic_id());
+
+    sched_start();
+    cpu_idle_loop();
+}
+
+/**
+ * @brief 启动一个CPU
+ *
+ * @param cpu CPU号
+ * @param params 启动代码的参数
+ * @return 是否在时限内上线
+ */
+static bool boot_cpu(int cpu, TrampolineParams *params) {
+    if (! setup_percpu_area(cpu) || ! alloc_ist_stacks(cpu)) {
+        return false;
+    }
+
+    Thread *idle = create_idle_thread(cpu);
+    if (idle == NULL) {
+        return false;
+    }
+    init_runqueue(cpu, idle);
+    per_cpu(current_thread_ptr, cpu) = idle;
+
+    params->stack = (qword)kernel_stack_top(idle->stack);
+    params->arg = cpu;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    dword target = cpu_apic_ids[cpu];
+    apic_send_init(target);
+    smp_delay(SMP_INIT_DELAY);
+
+    // 第一个SIPI可能被忽略 未上线时再发一次
+    for (int i = 0 ; i < 2 && ! cpumask_test(__atomic_load_n(&cpu_online_mask, __ATOMIC_SEQ_CST), cpu) ; i ++) {
+        apic_send_startup(target, SMP_TRAMPOLINE_ADDR);
+        smp_delay(SMP_STARTUP_DELAY);
+    }
+
+    qword deadline = sched_clock() + SMP_ONLINE_TIMEOUT;
+    while (! cpumask_test(__atomic_load_n(&cpu_online_mask, __ATOMIC_SEQ_CST), cpu)) {
+        if (sched_clock() >= deadline) {
+            // 使其停在等待SIPI的状态 不会再读到之后改写的参数
+            apic_send_init(target);
+            return false;
+        }
+        cpu_relax();
+    }
+    return true;
+}
+
+/**
+ * @brief 以INIT-SIPI-SIPI依次启动其它CPU
+ * 启动后各CPU加入调度 需在0号CPU开始调度之后调用(借助调度时钟计时)
+ *
+ */
+void smp_boot_cpus(void) {
+    if (cpu_present_num <= 1) {
+        return;
+    }
+
+    // 启动代码在32位保护模式下加载CR3
+    if (kernel_address_space.root >= (1ull << 32)) {
+        log_error("内核页表位于4G以上, 无法启动其它CPU");
+        return;
+    }
+
+    byte *trampoline = phys_to_virt(SMP_TRAMPOLINE_ADDR);
+    memcpy(trampoline, trampoline_start, trampoline_end - trampoline_start);
+    TrampolineParams *params = (TrampolineParams *)(trampoline + (trampoline_params - trampoline_start));
+
+    // 与0号CPU相同的分页设置
+    CR4 cr4 = rdcr4();
+    cr4.PCIDE = false;
+    EFER efer = rdefer();
+    efer.LMA = false;
+    CR0 cr0 = rdcr0();
+
+    params->cr3 = kernel_address_space.root;
+    params->cr4 = *(dword *)&cr4;
+    params->efer = *(qword *)&efer;
+    params->cr0 = *(dword *)&cr0;
+    params->entry = (qword)ap_main;
+
+    for (int cpu = 1 ; cpu < cpu_present_num ; cpu ++) {
+        if (! boot_cpu(cpu, params)) {
+            log_error("CPU%d(APIC ID=%d)启动失败", cpu, (int)cpu_apic_ids[cpu]);
+        }
+    }
+
+    log_info("SMP: %d/%d个CPU已上线", cpu_num, cpu_present_num);
+}
@@ -0,0 +1,44 @@
+/**
+ * @file smp.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 多处理器启动
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/**
+ * @brief 启动代码的物理地址
+ * 须4K对齐且低于1M 位于memblock保留的低端内存中 并经加载器保留的恒等映射执行
+ * 与cpu/trampoline.S中的TRAMPOLINE_ADDR一致
+ *
+ */
+#define SMP_TRAMPOLINE_ADDR (0x8000)
+
+/** INIT之后的等待(10ms) */
+#define SMP_INIT_DELAY     (10000000ull)
+/** SIPI之后的等待(200us) */
+#define SMP_STARTUP_DELAY  (200000ull)
+/** 等待CPU上线的时长(100ms) */
+#define SMP_ONLINE_TIMEOUT (100000000ull)
+
+/**
+ * @brief 从MADT中发现其它CPU并登记
+ * 在ACPI初始化之后 NUMA初始化之前调用
+ *
+ */
+void init_smp(void);
+
+/**
+ * @brief 以INIT-SIPI-SIPI依次启动其它CPU
+ * 启动后各CPU加入调度 需在0号CPU开始调度之后调用(借助调度时钟计时)
+ *
+ */
+void smp_boot_cpus(void);
@@ -0,0 +1,2 @@
+objects += lib/rbtree.o
+objects += lib/lz4.o
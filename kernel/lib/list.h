@@ -0,0 +1,125 @@
+/**
+ * @file list.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 侵入式双向循环链表
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <stddef.h>
+
+/**
+ * @brief 链表节点
+ *
+ */
+typedef struct ListNode {
+    /** 前驱 */
+    struct ListNode *prev;
+    /** 后继 */
+    struct ListNode *next;
+} ListNode;
+
+/**
+ * @brief 链表头静态初始值
+ *
+ */
+#define LIST_HEAD_INIT(name) { .prev = &(name), .next = &(name) }
+
+/**
+ * @brief 由成员指针获得结构体指针
+ *
+ */
+#define container_of(ptr, type, member) ((type *)((byte *)(ptr) - offsetof(type, member)))
+
+/**
+ * @brief 由链表节点获得结构体指针
+ *
+ */
+#define list_entry(ptr, type, member) container_of(ptr, type, member)
+
+/**
+ * @brief 遍历链表
+ *
+ */
+#define list_for_each(node, head) \
+    for (ListNode *node = (head)->next ; node != (head) ; node = node->next)
+
+/**
+ * @brief 遍历链表(允许删除当前节点)
+ *
+ */
+#define list_for_each_safe(node, head) \
+    for (ListNode *node = (head)->next, *__next = node->next ; node != (head) ; node = __next, __next = node->next)
+
+/**
+ * @brief 初始化链表头
+ *
+ * @param head 链表头
+ */
+static inline void list_init(ListNode *head) {
+    head->prev = head;
+    head->next = head;
+}
+
+/**
+ * @brief 链表是否为空
+ *
+ * @param head 链表头
+ * @return 是否为空
+ */
+static inline bool list_empty(ListNode *head) {
+    return head->next == head;
+}
+
+/**
+ * @brief 在两个节点间插入节点
+ *
+ * @param prev 前驱
+ * @param next 后继
+ * @param node 节点
+ */
+static inline void __list_insert(ListNode *prev, ListNode *next, ListNode *node) {
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+/**
+ * @brief 插入到链表头部
+ *
+ * @param head 链表头
+ * @param node 节点
+ */
+static inline void list_add(ListNode *head, ListNode *node) {
+    __list_insert(head, head->next, node);
+}
+
+/**
+ * @brief 插入到链表尾部
+ *
+ * @param head 链表头
+ * @param node 节点
+ */
+static inline void list_add_tail(ListNode *head, ListNode *node) {
+    __list_insert(head->prev, head, node);
+}
+
+/**
+ * @brief 从链表中删除节点
+ *
+ * @param node 节点
+ */
+static inline void list_del(ListNode *node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+}
\ No newline at end of file
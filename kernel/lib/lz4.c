@@ -0,0 +1,260 @@
+/**
+ * @file lz4.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief LZ4块格式压缩与解压
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <lib/lz4.h>
+#include <string.h>
+
+/** 最短匹配长度 */
+#define MIN_MATCH (4)
+/** 最后一个匹配必须在块结束前至少这么多字节处开始 */
+#define MF_LIMIT (12)
+/** 块的最后这么多字节必须是字面量 */
+#define LAST_LITERALS (5)
+/** 最大匹配距离 */
+#define MAX_DISTANCE (65535)
+
+/**
+ * @brief 读取未对齐的4字节
+ *
+ * @param ptr 地址
+ * @return 值
+ */
+static inline dword read32(const byte *ptr) {
+    dword value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief 4字节序列的哈希
+ *
+ * @param sequence 序列
+ * @return 哈希表索引
+ */
+static inline dword hash_sequence(dword sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+/**
+ * @brief 写入长度的扩展字节
+ *
+ * @param op 输出位置
+ * @param length 超出标记部分的长度
+ * @return 新的输出位置
+ */
+static inline byte *write_length(byte *op, int length) {
+    while (length >= 255) {
+        *op ++ = 255;
+        length -= 255;
+    }
+    *op ++ = length;
+    return op;
+}
+
+/**
+ * @brief 输出一个序列
+ *
+ * @param op 输出位置
+ * @param oend 输出缓冲区末尾
+ * @param literals 字面量
+ * @param literal_len 字面量长度
+ * @param offset 匹配距离(最后一个序列为0)
+ * @param match_len 匹配长度减去MIN_MATCH
+ * @return 新的输出位置 缓冲区不足时为NULL
+ */
+static byte *write_sequence(byte *op, byte *oend, const byte *literals, int literal_len, int offset, int match_len) {
+    // 标记, 长度扩展字节, 距离与字面量
+    if (oend - op < 1 + literal_len / 255 + 1 + literal_len + 2 + match_len / 255 + 1) {
+        return NULL;
+    }
+
+    byte *token = op ++;
+
+    if (literal_len >= 15) {
+        *token = 15 << 4;
+        op = write_length(op, literal_len - 15);
+    }
+    else {
+        *token = literal_len << 4;
+    }
+
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+
+    if (offset == 0) {
+        return op;
+    }
+
+    *op ++ = offset & 0xFF;
+    *op ++ = offset >> 8;
+
+    if (match_len >= 15) {
+        *token |= 15;
+        op = write_length(op, match_len - 15);
+    }
+    else {
+        *token |= match_len;
+    }
+
+    return op;
+}
+
+/**
+ * @brief 压缩
+ * 贪心匹配 压缩率略低于参考实现 但足以区分可压缩的页
+ *
+ * @param src 输入
+ * @param src_len 输入长度(不超过LZ4_MAX_INPUT)
+ * @param dst 输出
+ * @param dst_cap 输出缓冲区大小
+ * @param workmem 工作区(LZ4_WORKMEM_SIZE字节)
+ * @return 压缩后的长度 输出缓冲区不足时为0
+ */
+int lz4_compress(const byte *src, int src_len, byte *dst, int dst_cap, void *workmem) {
+    word *table = workmem;
+    const byte *ip = src;
+    const byte *anchor = src;
+    const byte *end = src + src_len;
+    byte *op = dst;
+    byte *oend = dst + dst_cap;
+
+    if (src_len > LZ4_MAX_INPUT) {
+        return 0;
+    }
+
+    memset(table, 0, LZ4_WORKMEM_SIZE);
+
+    if (src_len > MF_LIMIT) {
+        const byte *match_start_limit = end - MF_LIMIT;
+        const byte *match_end_limit = end - LAST_LITERALS;
+
+        ip ++;
+        while (ip <= match_start_limit) {
+            dword sequence = read32(ip);
+            dword hash = hash_sequence(sequence);
+            const byte *ref = src + table[hash];
+            table[hash] = ip - src;
+
+            if (ref >= ip || ip - ref > MAX_DISTANCE || read32(ref) != sequence) {
+                ip ++;
+                continue;
+            }
+
+            const byte *match_end = ip + MIN_MATCH;
+            const byte *ref_end = ref + MIN_MATCH;
+            while (match_end < match_end_limit && *match_end == *ref_end) {
+                match_end ++;
+                ref_end ++;
+            }
+
+            op = write_sequence(op, oend, anchor, ip - anchor, ip - ref, match_end - ip - MIN_MATCH);
+            if (op == NULL) {
+                return 0;
+            }
+
+            ip = match_end;
+            anchor = ip;
+        }
+    }
+
+    // 最后的字面量
+    op = write_sequence(op, oend, anchor, end - anchor, 0, 0);
+    if (op == NULL) {
+        return 0;
+    }
+
+    return op - dst;
+}
+
+/**
+ * @brief 读取长度的扩展字节
+ *
+ * @param ip 输入位置
+ * @param iend 输入末尾
+ * @param length 长度 读取的扩展部分累加到其上
+ * @return 新的输入位置 输入损坏时为NULL
+ */
+static const byte *read_length(const byte *ip, const byte *iend, int *length) {
+    byte value;
+    do {
+        if (ip >= iend) {
+            return NULL;
+        }
+        value = *ip ++;
+        *length += value;
+    } while (value == 255);
+    return ip;
+}
+
+/**
+ * @brief 解压
+ * 对损坏的输入是安全的 不会越界读写
+ *
+ * @param src 输入
+ * @param src_len 输入长度
+ * @param dst 输出
+ * @param dst_cap 输出缓冲区大小
+ * @return 解压后的长度 输入损坏时为-1
+ */
+int lz4_decompress(const byte *src, int src_len, byte *dst, int dst_cap) {
+    const byte *ip = src;
+    const byte *iend = src + src_len;
+    byte *op = dst;
+    byte *oend = dst + dst_cap;
+
+    while (ip < iend) {
+        byte token = *ip ++;
+
+        int literal_len = token >> 4;
+        if (literal_len == 15 && (ip = read_length(ip, iend, &literal_len)) == NULL) {
+            return -1;
+        }
+        if (literal_len > iend - ip || literal_len > oend - op) {
+            return -1;
+        }
+
+        memcpy(op, ip, literal_len);
+        op += literal_len;
+        ip += literal_len;
+
+        // 最后一个序列没有匹配
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dst) {
+            return -1;
+        }
+
+        int match_len = token & 15;
+        if (match_len == 15 && (ip = read_length(ip, iend, &match_len)) == NULL) {
+            return -1;
+        }
+        match_len += MIN_MATCH;
+        if (match_len > oend - op) {
+            return -1;
+        }
+
+        // 匹配可能与输出重叠 逐字节复制
+        const byte *ref = op - offset;
+        while (match_len --) {
+            *op ++ = *ref ++;
+        }
+    }
+
+    return op - dst;
+}
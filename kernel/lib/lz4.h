@@ -0,0 +1,53 @@
+/**
+ * @file lz4.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief LZ4块格式压缩与解压
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** 哈希表位数 */
+#define LZ4_HASH_LOG (12)
+/** 压缩所需工作区大小 */
+#define LZ4_WORKMEM_SIZE ((1 << LZ4_HASH_LOG) * sizeof(word))
+/** 输入的最大长度(匹配位置用16位保存) */
+#define LZ4_MAX_INPUT (65535)
+
+/**
+ * @brief 最坏情况下的压缩结果大小
+ *
+ */
+#define LZ4_COMPRESS_BOUND(size) ((size) + (size) / 255 + 16)
+
+/**
+ * @brief 压缩
+ * 贪心匹配 压缩率略低于参考实现 但足以区分可压缩的页
+ *
+ * @param src 输入
+ * @param src_len 输入长度(不超过LZ4_MAX_INPUT)
+ * @param dst 输出
+ * @param dst_cap 输出缓冲区大小
+ * @param workmem 工作区(LZ4_WORKMEM_SIZE字节)
+ * @return 压缩后的长度 输出缓冲区不足时为0
+ */
+int lz4_compress(const byte *src, int src_len, byte *dst, int dst_cap, void *workmem);
+
+/**
+ * @brief 解压
+ * 对损坏的输入是安全的 不会越界读写
+ *
+ * @param src 输入
+ * @param src_len 输入长度
+ * @param dst 输出
+ * @param dst_cap 输出缓冲区大小
+ * @return 解压后的长度 输入损坏时为-1
+ */
+int lz4_decompress(const byte *src, int src_len, byte *dst, int dst_cap);
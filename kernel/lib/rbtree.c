@@ -0,0 +1,341 @@
+/**
+ * @file rbtree.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 侵入式红黑树
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <lib/rbtree.h>
+
+/**
+ * @brief 节点是否为红色(空节点为黑色)
+ *
+ * @param node 节点
+ * @return 是否为红色
+ */
+static inline bool is_red(RBNode *node) {
+    return node != NULL && node->red;
+}
+
+/**
+ * @brief 在父节点中用新节点替换旧节点
+ *
+ * @param tree 树
+ * @param old 旧节点
+ * @param new 新节点
+ * @param parent 父节点
+ */
+static void replace_child(RBTree *tree, RBNode *old, RBNode *new, RBNode *parent) {
+    if (parent == NULL) {
+        tree->root = new;
+    }
+    else if (parent->left == old) {
+        parent->left = new;
+    }
+    else {
+        parent->right = new;
+    }
+}
+
+/**
+ * @brief 左旋
+ * 旋转不改变子树的节点集合 只需重新计算旋转的两个节点
+ *
+ * @param tree 树
+ * @param node 节点
+ * @param augment 增强回调
+ */
+static void rotate_left(RBTree *tree, RBNode *node, RBAugment augment) {
+    RBNode *right = node->right;
+
+    node->right = right->left;
+    if (right->left != NULL) {
+        right->left->parent = node;
+    }
+
+    right->parent = node->parent;
+    replace_child(tree, node, right, node->parent);
+
+    right->left = node;
+    node->parent = right;
+
+    if (augment != NULL) {
+        augment(node);
+        augment(right);
+    }
+}
+
+/**
+ * @brief 右旋
+ *
+ * @param tree 树
+ * @param node 节点
+ * @param augment 增强回调
+ */
+static void rotate_right(RBTree *tree, RBNode *node, RBAugment augment) {
+    RBNode *left = node->left;
+
+    node->left = left->right;
+    if (left->right != NULL) {
+        left->right->parent = node;
+    }
+
+    left->parent = node->parent;
+    replace_child(tree, node, left, node->parent);
+
+    left->right = node;
+    node->parent = left;
+
+    if (augment != NULL) {
+        augment(node);
+        augment(left);
+    }
+}
+
+/**
+ * @brief 插入新链接的节点并重新平衡
+ *
+ * @param tree 树
+ * @param node 已由rb_link_node链接的节点
+ * @param augment 增强回调
+ */
+void rb_insert_color(RBTree *tree, RBNode *node, RBAugment augment) {
+    rb_propagate(node, augment);
+
+    while (is_red(node->parent)) {
+        RBNode *parent = node->parent;
+        RBNode *grandparent = parent->parent;
+
+        if (parent == grandparent->left) {
+            RBNode *uncle = grandparent->right;
+            if (is_red(uncle)) {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+                continue;
+            }
+            if (node == parent->right) {
+                rotate_left(tree, parent, augment);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = false;
+            grandparent->red = true;
+            rotate_right(tree, grandparent, augment);
+        }
+        else {
+            RBNode *uncle = grandparent->left;
+            if (is_red(uncle)) {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+                continue;
+            }
+            if (node == parent->left) {
+                rotate_right(tree, parent, augment);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = false;
+            grandparent->red = true;
+            rotate_left(tree, grandparent, augment);
+        }
+    }
+
+    tree->root->red = false;
+}
+
+/**
+ * @brief 删除黑色节点后重新平衡
+ *
+ * @param tree 树
+ * @param node 顶替被删除节点的节点(可能为空)
+ * @param parent 该节点的父节点
+ * @param augment 增强回调
+ */
+static void erase_color(RBTree *tree, RBNode *node, RBNode *parent, RBAugment augment) {
+    while (node != tree->root && ! is_red(node)) {
+        if (node == parent->left) {
+            RBNode *sibling = parent->right;
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                rotate_left(tree, parent, augment);
+                sibling = parent->right;
+            }
+            if (! is_red(sibling->left) && ! is_red(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (! is_red(sibling->right)) {
+                sibling->left->red = false;
+                sibling->red = true;
+                rotate_right(tree, sibling, augment);
+                sibling = parent->right;
+            }
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->right->red = false;
+            rotate_left(tree, parent, augment);
+            node = tree->root;
+        }
+        else {
+            RBNode *sibling = parent->left;
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                rotate_right(tree, parent, augment);
+                sibling = parent->left;
+            }
+            if (! is_red(sibling->left) && ! is_red(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (! is_red(sibling->left)) {
+                sibling->right->red = false;
+                sibling->red = true;
+                rotate_left(tree, sibling, augment);
+                sibling = parent->left;
+            }
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->left->red = false;
+            rotate_right(tree, parent, augment);
+            node = tree->root;
+        }
+    }
+
+    if (node != NULL) {
+        node->red = false;
+    }
+}
+
+/**
+ * @brief 删除节点
+ *
+ * @param tree 树
+ * @param node 节点
+ * @param augment 增强回调
+ */
+void rb_erase(RBTree *tree, RBNode *node, RBAugment augment) {
+    RBNode *child;
+    RBNode *parent;
+    bool red;
+
+    if (node->left == NULL || node->right == NULL) {
+        child = node->left != NULL ? node->left : node->right;
+        parent = node->parent;
+        red = node->red;
+
+        if (child != NULL) {
+            child->parent = parent;
+        }
+        replace_child(tree, node, child, parent);
+    }
+    else {
+        // 用后继顶替被删除的节点
+        RBNode *successor = node->right;
+        while (successor->left != NULL) {
+            successor = successor->left;
+        }
+
+        child = successor->right;
+        red = successor->red;
+
+        if (successor->parent == node) {
+            parent = successor;
+        }
+        else {
+            parent = successor->parent;
+            parent->left = child;
+            if (child != NULL) {
+                child->parent = parent;
+            }
+            successor->right = node->right;
+            node->right->parent = successor;
+        }
+
+        successor->left = node->left;
+        node->left->parent = successor;
+        successor->parent = node->parent;
+        successor->red = node->red;
+        replace_child(tree, node, successor, node->parent);
+    }
+
+    // parent之上的路径经过所有子树发生变化的节点
+    rb_propagate(parent, augment);
+
+    if (! red) {
+        erase_color(tree, child, parent, augment);
+    }
+}
+
+/**
+ * @brief 最小的节点
+ *
+ * @param tree 树
+ * @return 节点 树为空时为NULL
+ */
+RBNode *rb_first(RBTree *tree) {
+    RBNode *node = tree->root;
+    if (node == NULL) {
+        return NULL;
+    }
+    while (node->left != NULL) {
+        node = node->left;
+    }
+    return node;
+}
+
+/**
+ * @brief 中序后继
+ *
+ * @param node 节点
+ * @return 后继 不存在时为NULL
+ */
+RBNode *rb_next(RBNode *node) {
+    if (node->right != NULL) {
+        node = node->right;
+        while (node->left != NULL) {
+            node = node->left;
+        }
+        return node;
+    }
+
+    while (node->parent != NULL && node == node->parent->right) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+/**
+ * @brief 中序前驱
+ *
+ * @param node 节点
+ * @return 前驱 不存在时为NULL
+ */
+RBNode *rb_prev(RBNode *node) {
+    if (node->left != NULL) {
+        node = node->left;
+        while (node->right != NULL) {
+            node = node->right;
+        }
+        return node;
+    }
+
+    while (node->parent != NULL && node == node->parent->left) {
+        node = node->parent;
+    }
+    return node->parent;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file rbtree.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 侵入式红黑树
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <lib/list.h>
+
+/**
+ * @brief 红黑树节点
+ *
+ */
+typedef struct RBNode {
+    /** 父节点 */
+    struct RBNode *parent;
+    /** 左子树 */
+    struct RBNode *left;
+    /** 右子树 */
+    struct RBNode *right;
+    /** 是否为红色 */
+    bool red;
+} RBNode;
+
+/**
+ * @brief 红黑树
+ *
+ */
+typedef struct {
+    /** 根节点 */
+    RBNode *root;
+} RBTree;
+
+/**
+ * @brief 红黑树静态初始值
+ *
+ */
+#define RB_TREE_INIT { .root = NULL }
+
+/**
+ * @brief 由红黑树节点获得结构体指针
+ *
+ */
+#define rb_entry(ptr, type, member) container_of(ptr, type, member)
+
+/**
+ * @brief 增强回调
+ * 由节点自身与左右子树重新计算节点上的附加信息(如子树最大值)
+ * 为NULL时即为普通红黑树
+ *
+ */
+typedef void (*RBAugment)(RBNode *node);
+
+/**
+ * @brief 将新节点链接到树中的指定位置
+ * 调用者自行查找位置 随后需调用rb_insert_color
+ *
+ * @param node 新节点
+ * @param parent 父节点 树为空时为NULL
+ * @param link 父节点中指向新节点的指针(或根指针)
+ */
+static inline void rb_link_node(RBNode *node, RBNode *parent, RBNode **link) {
+    node->parent = parent;
+    node->left = NULL;
+    node->right = NULL;
+    node->red = true;
+    *link = node;
+}
+
+/**
+ * @brief 自节点向上重新计算附加信息直到根
+ *
+ * @param node 节点
+ * @param augment 增强回调
+ */
+static inline void rb_propagate(RBNode *node, RBAugment augment) {
+    if (augment == NULL) {
+        return;
+    }
+    for ( ; node != NULL ; node = node->parent) {
+        augment(node);
+    }
+}
+
+/**
+ * @brief 插入新链接的节点并重新平衡
+ *
+ * @param tree 树
+ * @param node 已由rb_link_node链接的节点
+ * @param augment 增强回调
+ */
+void rb_insert_color(RBTree *tree, RBNode *node, RBAugment augment);
+
+/**
+ * @brief 删除节点
+ *
+ * @param tree 树
+ * @param node 节点
+ * @param augment 增强回调
+ */
+void rb_erase(RBTree *tree, RBNode *node, RBAugment augment);
+
+/**
+ * @brief 最小的节点
+ *
+ * @param tree 树
+ * @return 节点 树为空时为NULL
+ */
+RBNode *rb_first(RBTree *tree);
+
+/**
+ * @brief 中序后继
+ *
+ * @param node 节点
+ * @return 后继 不存在时为NULL
+ */
+RBNode *rb_next(RBNode *node);
+
+/**
+ * @brief 中序前驱
+ *
+ * @param node 节点
+ * @return 前驱 不存在时为NULL
+ */
+RBNode *rb_prev(RBNode *node);
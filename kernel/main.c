@@ -14,13 +14,72 @@
 #include <tay/boot.h>
 #include <basec/logger.h>
 
+#include <acpi/acpi.h>
+#include <cpu/cpu.h>
+#include <cpu/idle.h>
+#include <cpu/percpu.h>
+#include <cpu/apic.h>
+#include <cpu/interrupt.h>
+#include <cpu/gdt.h>
+#include <cpu/smp.h>
+#include <mm/vmm.h>
+#include <mm/pcid.h>
+#include <mm/pat.h>
+#include <mm/memblock.h>
+#include <mm/buddy.h>
+#include <mm/direct_map.h>
+#include <mm/paging.h>
+#include <mm/numa.h>
+#include <mm/zero.h>
+#include <mm/color.h>
+#include <mm/slab.h>
+#include <mm/vmalloc.h>
+#include <mm/zswap.h>
+#include <mm/ksm.h>
+#include <sched/sched.h>
+
+// 启动信息
+static BootInfo *boot_info;
+
 void init(void) {
+    init_cpu();
+    init_interrupt();
+    init_vmm();
+    init_pcid();
+    init_pat();
+
+    init_memblock(boot_info);
+    init_direct_map(boot_info);
+    init_percpu();
+
+    init_acpi();
+    init_smp();
+    init_numa();
+    init_buddy();
+    init_cache_color();
+    init_kernel_space();
+    init_zero_pool();
+
+    init_slab();
+    init_vmalloc();
+    init_ist();
+    init_apic_mmio();
+    init_zswap();
+    init_ksm();
+
+    init_thread();
+    init_sched();
 }
 
 void terminate(void) {
 }
 
 int main(void) {
+    // 初始化完成 开始调度 启动流程转为空闲线程
+    start_background_threads();
+    sched_start();
+    smp_boot_cpus();
+    cpu_idle_loop();
     return 0;
 }
 
@@ -30,14 +89,18 @@ int main(void) {
  */
 void setup(void) {
     register int magic __asm__("eax"); //GRUB Loader 魔数 存放在eax
+    register BootInfo *info __asm__("rbx"); //启动信息 存放在rbx
 
     // 设置栈
-    asm volatile ("movl $0x400000, %esp");
+    // 内核映像之下的物理内存 经高半区映射访问
+    asm volatile ("movq %0, %%rsp" : : "i"(KERNEL_VIRT_BASE + KERNEL_LOAD_ADDR));
 
     if ((magic & 0xFFFFFFFF) != BOOT_MAGIC) { //魔数不匹配
         while (true);
     }
 
+    boot_info = info;
+
     // 初始化
     init();
 
@@ -0,0 +1,540 @@
+/**
+ * @file buddy.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 伙伴系统页框分配器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/buddy.h>
+#include <mm/zero.h>
+#include <mm/compact.h>
+#include <mm/memblock.h>
+#include <mm/reclaim.h>
+#include <basec/logger.h>
+#include <string.h>
+
+/** 各节点的内存区 */
+Zone zones[MAX_NUMA_NODES];
+
+/** 空闲页框数(所有节点) */
+qword free_frame_num = 0;
+
+// 各页块的迁移类型
+static byte *pageblock_types;
+
+/**
+ * @brief 获取页框所在页块的迁移类型
+ *
+ * @param pfn 页框号
+ * @return 迁移类型
+ */
+int get_pageblock_type(qword pfn) {
+    return pageblock_types[pfn >> PAGEBLOCK_ORDER];
+}
+
+/**
+ * @brief 设置页框所在页块的迁移类型
+ *
+ * @param pfn 页框号
+ * @param type 迁移类型
+ */
+static void set_pageblock_type(qword pfn, int type) {
+    pageblock_types[pfn >> PAGEBLOCK_ORDER] = type;
+}
+
+/**
+ * @brief 将块加入空闲区
+ * 按所在页块的迁移类型放入对应链表
+ *
+ * @param zone 内存区
+ * @param frame 首页框
+ * @param order 阶数
+ */
+static void add_free_block(Zone *zone, PageFrame *frame, int order) {
+    frame->flags = FRAME_FREE;
+    frame->order = order;
+    frame->refcount = 0;
+    list_add(&zone->free_areas[order].lists[get_pageblock_type(frame_to_pfn(frame))], &frame->list);
+    zone->free_areas[order].count ++;
+}
+
+/**
+ * @brief 将块移出空闲区
+ *
+ * @param zone 内存区
+ * @param frame 首页框
+ * @param order 阶数
+ */
+static void del_free_block(Zone *zone, PageFrame *frame, int order) {
+    list_del(&frame->list);
+    frame->flags &= ~FRAME_FREE;
+    zone->free_areas[order].count --;
+}
+
+/**
+ * @brief 将页块中的空闲块移到另一迁移类型的链表
+ * 调用者需持有内存区的锁
+ *
+ * @param zone 内存区
+ * @param pfn 页块起始页框号
+ * @param type 迁移类型
+ */
+static void move_pageblock(Zone *zone, qword pfn, int type) {
+    set_pageblock_type(pfn, type);
+
+    qword end = pfn + PAGEBLOCK_PAGES;
+    while (pfn < end && pfn < frame_num) {
+        PageFrame *frame = pfn_to_frame(pfn);
+        if ((frame->flags & FRAME_FREE) && frame->node == zone->node) {
+            list_del(&frame->list);
+            list_add(&zone->free_areas[frame->order].lists[type], &frame->list);
+            pfn += 1ull << frame->order;
+        }
+        else {
+            pfn ++;
+        }
+    }
+}
+
+/**
+ * @brief 从指定迁移类型的链表中取出最小的合适块并拆分
+ * 调用者需持有内存区的锁
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @param type 迁移类型
+ * @return 首页框 失败时为NULL
+ */
+static PageFrame *take_smallest(Zone *zone, int order, int type) {
+    for (int current = order ; current < MAX_ORDER ; current ++) {
+        ListNode *list = &zone->free_areas[current].lists[type];
+        if (list_empty(list)) {
+            continue;
+        }
+
+        PageFrame *frame = list_entry(list->next, PageFrame, list);
+        del_free_block(zone, frame, current);
+
+        // 拆分 多余的一半放回低一阶
+        while (current > order) {
+            current --;
+            add_free_block(zone, frame + (1 << current), current);
+        }
+
+        return frame;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 从另一迁移类型借用空闲块
+ * 借用最大的块 以减少两种类型混杂的页块数
+ * 借用的块足够大时整个页块改为请求的类型
+ * 调用者需持有内存区的锁
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @param type 请求的迁移类型
+ * @return 首页框 失败时为NULL
+ */
+static PageFrame *steal_fallback(Zone *zone, int order, int type) {
+    int other = type == MIGRATE_MOVABLE ? MIGRATE_UNMOVABLE : MIGRATE_MOVABLE;
+
+    for (int current = MAX_ORDER - 1 ; current >= order ; current --) {
+        ListNode *list = &zone->free_areas[current].lists[other];
+        if (list_empty(list)) {
+            continue;
+        }
+
+        PageFrame *frame = list_entry(list->next, PageFrame, list);
+        qword pfn = frame_to_pfn(frame);
+
+        if (current >= PAGEBLOCK_ORDER) {
+            // 整块跨越若干页块 全部改为请求的类型
+            for (qword block = 0 ; block < (1ull << (current - PAGEBLOCK_ORDER)) ; block ++) {
+                set_pageblock_type(pfn + block * PAGEBLOCK_PAGES, type);
+            }
+            list_del(&frame->list);
+            list_add(&zone->free_areas[current].lists[type], &frame->list);
+        }
+        else if (current >= PAGEBLOCK_ORDER / 2) {
+            // 页块中空闲部分较多 占为己有
+            move_pageblock(zone, pfn & ~(PAGEBLOCK_PAGES - 1), type);
+        }
+        else {
+            return take_smallest(zone, order, other);
+        }
+
+        return take_smallest(zone, order, type);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 从内存区分配2^order个连续页框
+ * 分配后低于低水位时唤醒kswapd
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @param type 迁移类型
+ * @param reserve 能否动用最低水位以下的内存
+ * @return 首页框 失败时为NULL
+ */
+static PageFrame *zone_alloc_frames(Zone *zone, int order, int type, bool reserve) {
+    qword min = reserve ? 0 : zone->watermarks[WMARK_MIN];
+
+    // 无锁预检 空的节点不必争用锁
+    if (__atomic_load_n(&zone->free_frame_num, __ATOMIC_RELAXED) < (1ull << order) + min) {
+        return NULL;
+    }
+
+    spin_lock(&zone->lock);
+
+    PageFrame *frame = take_smallest(zone, order, type);
+    if (frame == NULL) {
+        frame = steal_fallback(zone, order, type);
+    }
+
+    if (frame != NULL) {
+        frame->flags = 0;
+        frame->order = order;
+        frame->refcount = 1;
+        frame->private = NULL;
+        zone->free_frame_num -= 1 << order;
+        __atomic_sub_fetch(&free_frame_num, 1 << order, __ATOMIC_RELAXED);
+    }
+
+    bool low = zone->free_frame_num < zone->watermarks[WMARK_LOW];
+
+    spin_unlock(&zone->lock);
+
+    if (low) {
+        wakeup_kswapd(zone->node);
+    }
+    return frame;
+}
+
+/**
+ * @brief 按距离依次尝试各节点
+ *
+ * @param node 节点号
+ * @param order 阶数
+ * @param flags 分配标志
+ * @param reserve 能否动用最低水位以下的内存
+ * @return 首页框 失败时为NULL
+ */
+static PageFrame *alloc_frames_fallback(int node, int order, dword flags, bool reserve) {
+    int type = (flags & ALLOC_MOVABLE) ? MIGRATE_MOVABLE : MIGRATE_UNMOVABLE;
+    int num = (flags & ALLOC_THISNODE) ? 1 : numa_node_num;
+
+    for (int i = 0 ; i < num ; i ++) {
+        PageFrame *frame = zone_alloc_frames(&zones[numa_fallback[node][i]], order, type, reserve);
+        if (frame != NULL) {
+            return frame;
+        }
+    }
+
+    // 预清零页池中的页也可以用来满足单页分配
+    // 池中的页取自可移动页块 不可移动的分配不能占用它们 否则会妨碍整理
+    if (order == 0 && type == MIGRATE_MOVABLE) {
+        for (int i = 0 ; i < num ; i ++) {
+            PageFrame *frame = zero_pool_get(numa_fallback[node][i]);
+            if (frame != NULL) {
+                return frame;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 从指定节点分配2^order个连续页框
+ * 不足时按距离依次尝试其他节点 仍失败时整理内存 最后同步回收后重试
+ * 返回的首页框引用计数为1
+ *
+ * @param node 节点号
+ * @param order 阶数
+ * @param flags 分配标志
+ * @return 首页框 失败时为NULL
+ */
+PageFrame *alloc_frames_node(int node, int order, dword flags) {
+    // 回收路径自身的分配动用保留内存 保证回收能够继续
+    bool reserve = in_reclaim();
+
+    PageFrame *frame = alloc_frames_fallback(node, order, flags, reserve);
+    if (frame != NULL) {
+        return frame;
+    }
+
+    // 空闲页足够但过于零散
+    int num = (flags & ALLOC_THISNODE) ? 1 : numa_node_num;
+    for (int i = 0 ; order > 0 && ! (flags & ALLOC_NOCOMPACT) && i < num ; i ++) {
+        if (compact_zone(&zones[numa_fallback[node][i]], order)) {
+            frame = alloc_frames_fallback(numa_fallback[node][i], order, flags | ALLOC_THISNODE, reserve);
+            if (frame != NULL) {
+                return frame;
+            }
+        }
+    }
+
+    // 最后手段: 同步回收
+    if ((flags & ALLOC_NORECLAIM) || try_to_free_pages(node, order) == 0) {
+        return NULL;
+    }
+    return alloc_frames_fallback(node, order, flags, reserve);
+}
+
+/**
+ * @brief 合并并加入空闲区
+ * 调用者需持有内存区的锁
+ *
+ * @param zone 内存区
+ * @param pfn 首页框号
+ * @param order 阶数
+ */
+static void __free_frames(Zone *zone, qword pfn, int order) {
+    // 与同一节点中空闲的伙伴合并
+    while (order < MAX_ORDER - 1) {
+        qword buddy_pfn = pfn ^ (1ull << order);
+        if (buddy_pfn >= frame_num) {
+            break;
+        }
+
+        PageFrame *buddy = pfn_to_frame(buddy_pfn);
+        if ((buddy->flags & FRAME_FREE) == 0 || buddy->order != order || buddy->node != zone->node) {
+            break;
+        }
+
+        // 隔离中的页块不与外部合并 否则其空闲页会被分配出去
+        if ((get_pageblock_type(buddy_pfn) == MIGRATE_ISOLATE) != (get_pageblock_type(pfn) == MIGRATE_ISOLATE)) {
+            break;
+        }
+
+        del_free_block(zone, buddy, order);
+        pfn &= ~(1ull << order);
+        order ++;
+    }
+
+    add_free_block(zone, pfn_to_frame(pfn), order);
+}
+
+/**
+ * @brief 释放2^order个连续页框
+ *
+ * @param frame 首页框
+ * @param order 阶数
+ */
+void free_frames(PageFrame *frame, int order) {
+    Zone *zone = &zones[frame->node];
+
+    spin_lock(&zone->lock);
+
+    zone->free_frame_num += 1 << order;
+    __atomic_add_fetch(&free_frame_num, 1 << order, __ATOMIC_RELAXED);
+    __free_frames(zone, frame_to_pfn(frame), order);
+
+    spin_unlock(&zone->lock);
+}
+
+/**
+ * @brief 隔离页块 其中的空闲页不再参与分配
+ *
+ * @param zone 内存区
+ * @param pfn 页块起始页框号
+ * @return 页块原先的迁移类型
+ */
+int isolate_pageblock(Zone *zone, qword pfn) {
+    spin_lock(&zone->lock);
+    int type = get_pageblock_type(pfn);
+    move_pageblock(zone, pfn, MIGRATE_ISOLATE);
+    spin_unlock(&zone->lock);
+    return type;
+}
+
+/**
+ * @brief 解除页块隔离 并合并其中的空闲页
+ *
+ * @param zone 内存区
+ * @param pfn 页块起始页框号
+ * @param type 恢复的迁移类型
+ */
+void unisolate_pageblock(Zone *zone, qword pfn, int type) {
+    spin_lock(&zone->lock);
+
+    set_pageblock_type(pfn, type);
+
+    // 隔离期间释放的页没有与外部合并 取出后重新释放
+    qword end = pfn + PAGEBLOCK_PAGES;
+    while (pfn < end && pfn < frame_num) {
+        PageFrame *frame = pfn_to_frame(pfn);
+        if ((frame->flags & FRAME_FREE) && frame->node == zone->node) {
+            int order = frame->order;
+            del_free_block(zone, frame, order);
+            __free_frames(zone, pfn, order);
+            pfn += 1ull << order;
+        }
+        else {
+            pfn ++;
+        }
+    }
+
+    spin_unlock(&zone->lock);
+}
+
+/**
+ * @brief 内存区中是否有不小于2^order页的空闲块
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @return 是否有
+ */
+bool zone_has_free_block(Zone *zone, int order) {
+    for (int current = order ; current < MAX_ORDER ; current ++) {
+        for (int type = 0 ; type < MIGRATE_ISOLATE ; type ++) {
+            if (! list_empty(&zone->free_areas[current].lists[type])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 把已分配的块拆分为独立的单页
+ * 拆分后每个页框都可以单独释放
+ *
+ * @param frame 首页框
+ * @param order 阶数
+ */
+void split_frames(PageFrame *frame, int order) {
+    for (qword i = 0 ; i < (1ull << order) ; i ++) {
+        frame[i].flags = 0;
+        frame[i].order = 0;
+        frame[i].refcount = 1;
+        frame[i].private = NULL;
+    }
+}
+
+/**
+ * @brief 分配一个清零的页框
+ * 可移动页优先从本节点的预清零页池中取 池空时才同步清零
+ *
+ * @param flags 分配标志
+ * @return 页框 失败时为NULL
+ */
+PageFrame *alloc_zeroed_frame(dword flags) {
+    int node = current_node();
+
+    if (flags & ALLOC_MOVABLE) {
+        PageFrame *frame = zero_pool_get(node);
+        if (frame != NULL) {
+            return frame;
+        }
+    }
+
+    PageFrame *frame = alloc_frames_node(node, 0, flags);
+    if (frame != NULL) {
+        memset(frame_to_ptr(frame), 0, PAGE_SIZE);
+    }
+    return frame;
+}
+
+/**
+ * @brief 按内存区大小计算水位
+ * 最低水位约为空闲内存的1/128 低水位与高水位依次高出1/4
+ *
+ * @param zone 内存区
+ */
+static void setup_watermarks(Zone *zone) {
+    qword min = zone->free_frame_num / 128;
+    if (min < WMARK_MIN_PAGES) {
+        min = WMARK_MIN_PAGES;
+    }
+    if (min > WMARK_MAX_PAGES) {
+        min = WMARK_MAX_PAGES;
+    }
+
+    zone->watermarks[WMARK_MIN] = min;
+    zone->watermarks[WMARK_LOW] = min + min / 4;
+    zone->watermarks[WMARK_HIGH] = min + min / 2;
+}
+
+/**
+ * @brief 初始化伙伴系统
+ * 页框描述符表与页块类型表由memblock按实际内存大小分配
+ * 随后接管memblock中所有未保留的内存 各页框按NUMA拓扑直接归入所属节点
+ *
+ */
+void init_buddy(void) {
+    for (int node = 0 ; node < MAX_NUMA_NODES ; node ++) {
+        zones[node].node = node;
+        zones[node].free_frame_num = 0;
+        zones[node].start_pfn = 0;
+        zones[node].end_pfn = 0;
+        zones[node].compact_defer_shift = 0;
+        zones[node].compact_considered = 0;
+        zones[node].lock = (Spinlock)SPINLOCK_INIT;
+        for (int lru = 0 ; lru < LRU_LISTS ; lru ++) {
+            list_init(&zones[node].lru[lru]);
+            zones[node].lru_num[lru] = 0;
+        }
+        zones[node].lru_lock = (Spinlock)SPINLOCK_INIT;
+        for (int order = 0 ; order < MAX_ORDER ; order ++) {
+            for (int type = 0 ; type < MIGRATE_TYPES ; type ++) {
+                list_init(&zones[node].free_areas[order].lists[type]);
+            }
+            zones[node].free_areas[order].count = 0;
+        }
+    }
+
+    frame_num = memblock_end() / PAGE_SIZE;
+    if (frame_num > direct_map_end / PAGE_SIZE) {
+        log_warn("物理内存超过直接映射区, 多余部分将被忽略");
+        frame_num = direct_map_end / PAGE_SIZE;
+    }
+
+    qword pageblock_num = (frame_num + PAGEBLOCK_PAGES - 1) >> PAGEBLOCK_ORDER;
+    qword frames_phys = memblock_alloc(frame_num * sizeof(PageFrame), PAGE_SIZE);
+    qword types_phys = memblock_alloc(pageblock_num, sizeof(qword));
+    if (frames_phys == MEMBLOCK_ALLOC_FAILED || types_phys == MEMBLOCK_ALLOC_FAILED) {
+        log_fatal("无法分配页框描述符表");
+        while (true);
+    }
+    frames = phys_to_virt(frames_phys);
+    pageblock_types = phys_to_virt(types_phys);
+
+    for (int node = 0 ; node < numa_node_num ; node ++) {
+        zones[node].start_pfn = frame_num;
+    }
+
+    for (qword pfn = 0 ; pfn < frame_num ; pfn ++) {
+        int node = phys_to_node(pfn * PAGE_SIZE);
+        frames[pfn].flags = FRAME_RESERVED;
+        frames[pfn].refcount = 1;
+        frames[pfn].node = node;
+        if (pfn < zones[node].start_pfn) {
+            zones[node].start_pfn = pfn;
+        }
+        zones[node].end_pfn = pfn + 1;
+    }
+
+    // 启动时所有页块都是可移动的 内核分配时再按需借用
+    for (qword block = 0 ; block < pageblock_num ; block ++) {
+        pageblock_types[block] = MIGRATE_MOVABLE;
+    }
+
+    memblock_free_all();
+
+    for (int node = 0 ; node < numa_node_num ; node ++) {
+        setup_watermarks(&zones[node]);
+        log_info("节点%d: 空闲%d个页框", node, (int)zones[node].free_frame_num);
+    }
+    log_info("伙伴系统: 共%d个页框, 空闲%d个", (int)frame_num, (int)free_frame_num);
+}
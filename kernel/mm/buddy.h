@@ -0,0 +1,241 @@
+/**
+ * @file buddy.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 伙伴系统页框分配器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+#include <mm/numa.h>
+#include <sync/spinlock.h>
+#include <tay/boot.h>
+
+/** 最大阶数(不含) 最大块为2^(MAX_ORDER-1)页 */
+#define MAX_ORDER (11)
+
+/** 页块阶数 页块(2MB)是迁移类型的管理单位 */
+#define PAGEBLOCK_ORDER (9)
+/** 页块页数 */
+#define PAGEBLOCK_PAGES (1ull << PAGEBLOCK_ORDER)
+
+/** 最低水位的下限(页) */
+#define WMARK_MIN_PAGES (32)
+/** 最低水位的上限(页) */
+#define WMARK_MAX_PAGES (16384)
+
+/**
+ * @brief 迁移类型
+ * 同类页框尽量集中在同一页块中 使可移动页块能被整理为大块
+ *
+ */
+enum MigrateTypes {
+    /** 不可移动(内核数据, 页表等) */
+    MIGRATE_UNMOVABLE = 0,
+    /** 可移动(用户匿名页) */
+    MIGRATE_MOVABLE   = 1,
+    /** 正在整理 其中的空闲页不参与分配 */
+    MIGRATE_ISOLATE   = 2,
+    /** 类型数 */
+    MIGRATE_TYPES     = 3
+};
+
+/**
+ * @brief 分配标志
+ *
+ */
+enum AllocFlags {
+    /** 分配可移动页 */
+    ALLOC_MOVABLE   = 1 << 0,
+    /** 只从指定节点分配 */
+    ALLOC_THISNODE  = 1 << 1,
+    /** 失败时不进行内存整理 */
+    ALLOC_NOCOMPACT = 1 << 2,
+    /** 失败时不进行同步回收 */
+    ALLOC_NORECLAIM = 1 << 3
+};
+
+/**
+ * @brief LRU链表
+ *
+ */
+enum LRULists {
+    /** 不活跃页 回收从这里选取 */
+    LRU_INACTIVE = 0,
+    /** 活跃页 */
+    LRU_ACTIVE   = 1,
+    /** 链表数 */
+    LRU_LISTS    = 2
+};
+
+/**
+ * @brief 空闲页水位
+ *
+ */
+enum Watermarks {
+    /** 低于该水位时普通分配失败 剩余内存留给回收路径 */
+    WMARK_MIN  = 0,
+    /** 低于该水位时唤醒kswapd */
+    WMARK_LOW  = 1,
+    /** kswapd回收到该水位为止 */
+    WMARK_HIGH = 2,
+    /** 水位数 */
+    WMARK_NUM  = 3
+};
+
+/**
+ * @brief 空闲区
+ *
+ */
+typedef struct {
+    /** 各迁移类型的空闲块链表 */
+    ListNode lists[MIGRATE_TYPES];
+    /** 空闲块数 */
+    qword count;
+} FreeArea;
+
+/**
+ * @brief 内存区
+ * 每个NUMA节点一个 伙伴块不会跨节点合并
+ *
+ */
+typedef struct {
+    /** 节点号 */
+    int node;
+    /** 各阶空闲区 */
+    FreeArea free_areas[MAX_ORDER];
+    /** 空闲页框数 */
+    qword free_frame_num;
+    /** 起始页框号 */
+    qword start_pfn;
+    /** 结束页框号(不含) */
+    qword end_pfn;
+    /** 整理连续失败后推迟的轮数(2的幂) */
+    int compact_defer_shift;
+    /** 推迟期间已跳过的轮数 */
+    int compact_considered;
+    /** 水位 */
+    qword watermarks[WMARK_NUM];
+    /** 锁 */
+    Spinlock lock;
+    /** 映射在用户空间中的匿名页 */
+    ListNode lru[LRU_LISTS];
+    /** 各LRU链表中的页数 */
+    qword lru_num[LRU_LISTS];
+    /** 保护LRU链表 */
+    Spinlock lru_lock;
+} Zone;
+
+/** 各节点的内存区 */
+extern Zone zones[MAX_NUMA_NODES];
+
+/** 空闲页框数(所有节点) */
+extern qword free_frame_num;
+
+/**
+ * @brief 初始化伙伴系统
+ * 页框描述符表与页块类型表由memblock按实际内存大小分配
+ * 随后接管memblock中所有未保留的内存 各页框按NUMA拓扑直接归入所属节点
+ * 需在init_numa之后调用
+ *
+ */
+void init_buddy(void);
+
+/**
+ * @brief 获取页框所在页块的迁移类型
+ *
+ * @param pfn 页框号
+ * @return 迁移类型
+ */
+int get_pageblock_type(qword pfn);
+
+/**
+ * @brief 隔离页块 其中的空闲页不再参与分配
+ *
+ * @param zone 内存区
+ * @param pfn 页块起始页框号
+ * @return 页块原先的迁移类型
+ */
+int isolate_pageblock(Zone *zone, qword pfn);
+
+/**
+ * @brief 解除页块隔离 并合并其中的空闲页
+ *
+ * @param zone 内存区
+ * @param pfn 页块起始页框号
+ * @param type 恢复的迁移类型
+ */
+void unisolate_pageblock(Zone *zone, qword pfn, int type);
+
+/**
+ * @brief 内存区中是否有不小于2^order页的空闲块
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @return 是否有
+ */
+bool zone_has_free_block(Zone *zone, int order);
+
+/**
+ * @brief 从指定节点分配2^order个连续页框
+ * 不足时按距离依次尝试其他节点 仍失败时整理内存 最后同步回收后重试
+ * 返回的首页框引用计数为1
+ *
+ * @param node 节点号
+ * @param order 阶数
+ * @param flags 分配标志
+ * @return 首页框 失败时为NULL
+ */
+PageFrame *alloc_frames_node(int node, int order, dword flags);
+
+/**
+ * @brief 释放2^order个连续页框
+ *
+ * @param frame 首页框
+ * @param order 阶数
+ */
+void free_frames(PageFrame *frame, int order);
+
+/**
+ * @brief 分配2^order个连续页框 优先使用当前CPU所在节点
+ * 返回的首页框引用计数为1
+ *
+ * @param order 阶数
+ * @return 首页框 失败时为NULL
+ */
+static inline PageFrame *alloc_frames(int order) {
+    return alloc_frames_node(current_node(), order, 0);
+}
+
+/**
+ * @brief 分配一个页框
+ *
+ * @return 页框 失败时为NULL
+ */
+static inline PageFrame *alloc_frame(void) {
+    return alloc_frames(0);
+}
+
+/**
+ * @brief 把已分配的块拆分为独立的单页
+ * 拆分后每个页框都可以单独释放
+ *
+ * @param frame 首页框
+ * @param order 阶数
+ */
+void split_frames(PageFrame *frame, int order);
+
+/**
+ * @brief 分配一个清零的页框
+ * 可移动页优先从本节点的预清零页池中取 池空时才同步清零
+ *
+ * @param flags 分配标志
+ * @return 页框 失败时为NULL
+ */
+PageFrame *alloc_zeroed_frame(dword flags);
@@ -0,0 +1,230 @@
+/**
+ * @file color.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 按缓存颜色分配用户页
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/color.h>
+#include <mm/buddy.h>
+#include <tay/cpuid.h>
+#include <basec/logger.h>
+#include <string.h>
+
+/**
+ * @brief 节点上按颜色分开的空闲页
+ * 伙伴系统的空闲链表无法按颜色拆分(合并后的块横跨所有颜色)
+ * 着色分配从伙伴系统取整块 拆开后其余颜色的页暂存在这里
+ *
+ */
+typedef struct {
+    /** 各颜色的空闲页 */
+    ListNode lists[MAX_CACHE_COLORS];
+    /** 各颜色的空闲页数 */
+    int num[MAX_CACHE_COLORS];
+    /** 锁 */
+    Spinlock lock;
+} ColorCache;
+
+/** 颜色数(2的幂) 为1时不着色 */
+int cache_color_num = 1;
+
+// 恰好包含每种颜色各一页的块的阶数
+static int color_order = 0;
+// 各节点的颜色缓存
+static ColorCache color_caches[MAX_NUMA_NODES];
+
+/**
+ * @brief 由CPUID 4号功能报告的末级缓存结构计算颜色数
+ *
+ */
+void init_cache_color(void) {
+    for (int node = 0 ; node < MAX_NUMA_NODES ; node ++) {
+        for (int color = 0 ; color < MAX_CACHE_COLORS ; color ++) {
+            list_init(&color_caches[node].lists[color]);
+        }
+        color_caches[node].lock = (Spinlock)SPINLOCK_INIT;
+    }
+
+    if (cpuid_max_leaf() < 0x04) {
+        log_info("缓存着色: CPU不报告缓存结构 不着色");
+        return;
+    }
+
+    // 级别最高的数据或统一缓存
+    int level = 0;
+    qword way_size = 0;
+    qword size = 0;
+    int ways = 0;
+    for (dword index = 0 ; ; index ++) {
+        CPUIDResult result = cpuid(0x04, index);
+        int type = CPUID_04_EAX_TYPE(result.eax);
+        if (type == 0) {
+            break;
+        }
+        // 指令缓存
+        if (type == 2 || CPUID_04_EAX_LEVEL(result.eax) <= level) {
+            continue;
+        }
+
+        level = CPUID_04_EAX_LEVEL(result.eax);
+        ways = CPUID_04_EBX_WAYS(result.ebx);
+        way_size = (qword)CPUID_04_EBX_LINE_SIZE(result.ebx) * CPUID_04_EBX_PARTITIONS(result.ebx) *
+            CPUID_04_ECX_SETS(result.ecx);
+        size = way_size * ways;
+    }
+
+    // 一路中能放下的页数即颜色数
+    qword colors = way_size / PAGE_SIZE;
+    while (cache_color_num * 2 <= colors && cache_color_num < MAX_CACHE_COLORS) {
+        cache_color_num *= 2;
+        color_order ++;
+    }
+
+    log_info("缓存着色: L%d %dKB %d路 %d种颜色", level, (int)(size >> 10), ways, cache_color_num);
+}
+
+/**
+ * @brief 设置地址空间的用户页可用的颜色
+ * 地址空间的页轮流使用这些颜色 不同地址空间使用不相交的颜色即可划分末级缓存
+ *
+ * @param address_space 地址空间
+ * @param first 第一个颜色
+ * @param num 颜色数 为0时不着色
+ * @return 是否成功
+ */
+bool set_address_space_colors(AddressSpace *address_space, int first, int num) {
+    if (num != 0 && (cache_color_num == 1 || first < 0 || num < 0 || first + num > cache_color_num)) {
+        return false;
+    }
+
+    spin_lock(&address_space->lock);
+    address_space->color_first = first;
+    address_space->color_num = num;
+    address_space->color_next = 0;
+    spin_unlock(&address_space->lock);
+    return true;
+}
+
+/**
+ * @brief 把页放入所在节点的颜色缓存 缓存已满时还给伙伴系统
+ *
+ * @param frame 页框
+ */
+static void stash_frame(PageFrame *frame) {
+    ColorCache *cache = &color_caches[frame->node];
+    int color = frame_color(frame);
+
+    spin_lock(&cache->lock);
+    if (cache->num[color] < COLOR_LIST_MAX) {
+        list_add(&cache->lists[color], &frame->list);
+        cache->num[color] ++;
+        spin_unlock(&cache->lock);
+        return;
+    }
+    spin_unlock(&cache->lock);
+
+    free_frames(frame, 0);
+}
+
+/**
+ * @brief 分配指定颜色的页
+ * 先查颜色缓存 没有时从伙伴系统取一整块拆开
+ *
+ * @param node 节点号
+ * @param color 颜色
+ * @return 页框 失败时为NULL
+ */
+static PageFrame *alloc_colored_frame(int node, int color) {
+    ColorCache *cache = &color_caches[node];
+
+    spin_lock(&cache->lock);
+    if (! list_empty(&cache->lists[color])) {
+        PageFrame *frame = list_entry(cache->lists[color].next, PageFrame, list);
+        list_del(&frame->list);
+        cache->num[color] --;
+        spin_unlock(&cache->lock);
+        return frame;
+    }
+    spin_unlock(&cache->lock);
+
+    // 块按大小对齐 其中每种颜色恰好一页
+    PageFrame *block = alloc_frames_node(node, color_order, ALLOC_MOVABLE | ALLOC_NOCOMPACT | ALLOC_NORECLAIM);
+    if (block == NULL) {
+        return NULL;
+    }
+    split_frames(block, color_order);
+
+    PageFrame *result = NULL;
+    for (int i = 0 ; i < (1 << color_order) ; i ++) {
+        if (frame_color(&block[i]) == color) {
+            result = &block[i];
+        }
+        else {
+            stash_frame(&block[i]);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 为地址空间分配一个可移动的用户页
+ * 地址空间设置了颜色时按颜色轮流分配 否则与普通分配相同
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param zeroed 是否清零
+ * @return 页框 失败时为NULL
+ */
+PageFrame *alloc_user_frame(AddressSpace *address_space, bool zeroed) {
+    PageFrame *frame = NULL;
+
+    if (address_space->color_num != 0) {
+        int color = address_space->color_first + address_space->color_next;
+        address_space->color_next = (address_space->color_next + 1) % address_space->color_num;
+
+        frame = alloc_colored_frame(current_node(), color);
+        if (frame != NULL && zeroed) {
+            memset(frame_to_ptr(frame), 0, PAGE_SIZE);
+        }
+    }
+
+    // 没有着色或内存碎片化时退回普通分配 只是失去着色效果
+    if (frame == NULL) {
+        frame = zeroed ? alloc_zeroed_frame(ALLOC_MOVABLE) : alloc_frames_node(current_node(), 0, ALLOC_MOVABLE);
+    }
+    return frame;
+}
+
+/**
+ * @brief 把节点各颜色缓存的空闲页还给伙伴系统
+ *
+ * @param node 节点号
+ */
+void drain_color_cache(int node) {
+    ColorCache *cache = &color_caches[node];
+    ListNode frames;
+    list_init(&frames);
+
+    spin_lock(&cache->lock);
+    for (int color = 0 ; color < cache_color_num ; color ++) {
+        while (! list_empty(&cache->lists[color])) {
+            ListNode *entry = cache->lists[color].next;
+            list_del(entry);
+            list_add(&frames, entry);
+        }
+        cache->num[color] = 0;
+    }
+    spin_unlock(&cache->lock);
+
+    while (! list_empty(&frames)) {
+        PageFrame *frame = list_entry(frames.next, PageFrame, list);
+        list_del(&frame->list);
+        free_frames(frame, 0);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file color.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 按缓存颜色分配用户页
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+#include <mm/vmm.h>
+
+/** 最大颜色数 缓存更大时相邻的颜色合并为一种 */
+#define MAX_CACHE_COLORS (64)
+/** 每个节点每种颜色最多缓存的空闲页数 */
+#define COLOR_LIST_MAX (16)
+
+/** 颜色数(2的幂) 为1时不着色 */
+extern int cache_color_num;
+
+/**
+ * @brief 页框的缓存颜色
+ * 颜色相同的页映射到末级缓存中相同的组
+ *
+ * @param frame 页框
+ * @return 颜色
+ */
+static inline int frame_color(PageFrame *frame) {
+    return frame_to_pfn(frame) & (cache_color_num - 1);
+}
+
+/**
+ * @brief 由CPUID 4号功能报告的末级缓存结构计算颜色数
+ *
+ */
+void init_cache_color(void);
+
+/**
+ * @brief 设置地址空间的用户页可用的颜色
+ * 地址空间的页轮流使用这些颜色 不同地址空间使用不相交的颜色即可划分末级缓存
+ *
+ * @param address_space 地址空间
+ * @param first 第一个颜色
+ * @param num 颜色数 为0时不着色
+ * @return 是否成功
+ */
+bool set_address_space_colors(AddressSpace *address_space, int first, int num);
+
+/**
+ * @brief 为地址空间分配一个可移动的用户页
+ * 地址空间设置了颜色时按颜色轮流分配 否则与普通分配相同
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param zeroed 是否清零
+ * @return 页框 失败时为NULL
+ */
+PageFrame *alloc_user_frame(AddressSpace *address_space, bool zeroed);
+
+/**
+ * @brief 把节点各颜色缓存的空闲页还给伙伴系统
+ *
+ * @param node 节点号
+ */
+void drain_color_cache(int node);
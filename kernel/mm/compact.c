@@ -0,0 +1,392 @@
+/**
+ * @file compact.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内存整理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/compact.h>
+#include <mm/paging.h>
+#include <mm/tlb.h>
+#include <mm/vmm.h>
+#include <mm/reclaim.h>
+#include <string.h>
+
+/** 一次TLB刷新最多迁移的页数 */
+#define MIGRATE_BATCH (32)
+/** 按需整理时最多尝试的区域数 */
+#define COMPACT_ATTEMPTS (4)
+/** 后台整理的碎片化阈值(百分比) */
+#define COMPACT_PROACTIVE_THRESHOLD (50)
+
+/**
+ * @brief 一次页迁移
+ *
+ */
+typedef struct {
+    /** 映射该页的PTE */
+    PTE *pte;
+    /** 撤销映射前的表项 */
+    qword entry;
+    /** 旧页框 */
+    PageFrame *old;
+    /** 新页框 */
+    PageFrame *new;
+} Migration;
+
+// 每个内存区同时只允许一次整理
+static Spinlock compact_locks[MAX_NUMA_NODES];
+
+/**
+ * @brief 整理是否处于推迟期
+ * 连续失败后跳过随后的若干轮 避免反复扫描无法整理的内存区
+ *
+ * @param zone 内存区
+ * @return 是否推迟
+ */
+static bool compact_deferred(Zone *zone) {
+    if (zone->compact_defer_shift == 0) {
+        return false;
+    }
+    if (++ zone->compact_considered < (1 << zone->compact_defer_shift)) {
+        return true;
+    }
+    zone->compact_considered = 0;
+    return false;
+}
+
+/**
+ * @brief 记录一次整理的结果
+ *
+ * @param zone 内存区
+ * @param success 是否成功
+ */
+static void compact_record(Zone *zone, bool success) {
+    zone->compact_considered = 0;
+    if (success) {
+        zone->compact_defer_shift = 0;
+    }
+    else if (zone->compact_defer_shift < COMPACT_MAX_DEFER_SHIFT) {
+        zone->compact_defer_shift ++;
+    }
+}
+
+/**
+ * @brief 检查区域能否整理
+ * 区域中的页块都必须是可移动的 已用页都必须是只有一个映射的匿名页
+ *
+ * @param zone 内存区
+ * @param start 起始页框号
+ * @param pages 页数
+ * @param free 区域中的空闲页数
+ * @return 能否整理
+ */
+static bool scan_unit(Zone *zone, qword start, qword pages, qword *free) {
+    for (qword pfn = start ; pfn < start + pages ; pfn += PAGEBLOCK_PAGES) {
+        if (get_pageblock_type(pfn) != MIGRATE_MOVABLE) {
+            return false;
+        }
+    }
+
+    *free = 0;
+    qword pfn = start;
+    while (pfn < start + pages) {
+        if (pfn >= frame_num) {
+            return false;
+        }
+
+        PageFrame *frame = pfn_to_frame(pfn);
+        if (frame->node != zone->node) {
+            return false;
+        }
+
+        if (frame->flags & FRAME_FREE) {
+            *free += 1ull << frame->order;
+            pfn += 1ull << frame->order;
+            continue;
+        }
+
+        // KSM共享页即使只剩稳定树的引用也不在页表中 无法迁移
+        if ((frame->flags & (FRAME_ANON | FRAME_KSM)) != FRAME_ANON || frame->refcount != 1) {
+            return false;
+        }
+        pfn ++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 寻找最容易整理的区域
+ * 选择空闲页最多的区域 使需要迁移的页最少
+ *
+ * @param zone 内存区
+ * @param unit_order 区域阶数
+ * @param start 区域起始页框号
+ * @return 是否找到
+ */
+static bool find_candidate(Zone *zone, int unit_order, qword *start) {
+    qword pages = 1ull << unit_order;
+    qword best_free = 0;
+    bool found = false;
+
+    for (qword pfn = zone->start_pfn & ~(pages - 1) ; pfn + pages <= zone->end_pfn ; pfn += pages) {
+        qword free;
+        if (! scan_unit(zone, pfn, pages, &free) || free == pages) {
+            continue;
+        }
+
+        // 迁出的页需要落在区域之外的空闲页中
+        if (pages - free > zone->free_frame_num - free) {
+            continue;
+        }
+
+        if (! found || free > best_free) {
+            best_free = free;
+            *start = pfn;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief 完成一批迁移
+ * 映射已在撤销时清空 刷新TLB后其他CPU不会再写入旧页 此时复制才是完整的
+ *
+ * @param batch TLB刷新批次
+ * @param migrations 迁移
+ * @param count 迁移数
+ */
+static void finish_migrations(TLBBatch *batch, Migration *migrations, int count) {
+    if (count == 0) {
+        return;
+    }
+
+    tlb_batch_flush(batch);
+
+    for (int i = 0 ; i < count ; i ++) {
+        Migration *migration = &migrations[i];
+        memcpy(frame_to_ptr(migration->new), frame_to_ptr(migration->old), PAGE_SIZE);
+        migration->new->flags |= FRAME_ANON;
+        lru_add(migration->new);
+
+        migration->pte->ref_page_entry.address = frame_to_phys(migration->new) |
+                                                 (migration->entry & ~PAGE_ENTRY_4K_MASK);
+        frame_put(migration->old);
+    }
+}
+
+/**
+ * @brief 迁出地址空间中映射到区域内的页
+ *
+ * @param address_space 地址空间
+ * @param zone 内存区
+ * @param start 区域起始页框号
+ * @param end 区域结束页框号
+ */
+static void migrate_address_space(AddressSpace *address_space, Zone *zone, qword start, qword end) {
+    // 持有地址空间锁的路径可能正在等待整理 不能在此等待
+    if (! spin_trylock(&address_space->lock)) {
+        return;
+    }
+
+    Migration migrations[MIGRATE_BATCH];
+    int count = 0;
+
+    TLBBatch batch;
+    tlb_batch_init(&batch, address_space);
+
+    PML4E *pml4e;
+    for_each_user_pml4e(pml4e, base, address_space) {
+        PDPTE *pdpt = table_ptr(pml4e->ref_pdpt_entry.address);
+        for (qword j = 0 ; j < PDPTE_PER_TAB ; j ++) {
+            if (! pdpt[j].ref_pde_entry.P || pdpt[j].ref_pde_entry.PS) {
+                continue;
+            }
+
+            PDE *pd = table_ptr(pdpt[j].ref_pde_entry.address);
+            for (qword k = 0 ; k < PDE_PER_TAB ; k ++) {
+                PagingTableEntry *pde = &pd[k].ref_pt_entry;
+                if (! pde->P || pde->PS) {
+                    continue;
+                }
+
+                // 共享的页表也映射在其他地址空间中 无法在此刷新它们的TLB
+                if (phys_to_frame(get_pagingtab_addr(*pde))->refcount != 1) {
+                    continue;
+                }
+
+                PTE *pt = table_ptr(pde->address);
+                for (qword l = 0 ; l < PTE_PER_TAB ; l ++) {
+                    qword entry = pt[l].ref_page_entry.address;
+                    if ((entry & PAGE_PRESENT) == 0) {
+                        continue;
+                    }
+
+                    qword pfn = (entry & PAGE_ENTRY_4K_MASK) / PAGE_SIZE;
+                    if (pfn < start || pfn >= end) {
+                        continue;
+                    }
+
+                    PageFrame *old = pfn_to_frame(pfn);
+                    if ((old->flags & FRAME_ANON) == 0 || old->refcount != 1) {
+                        continue;
+                    }
+
+                    PageFrame *new = alloc_frames_node(zone->node, 0, ALLOC_MOVABLE | ALLOC_THISNODE | ALLOC_NOCOMPACT | ALLOC_NORECLAIM);
+                    if (new == NULL) {
+                        goto out;
+                    }
+
+                    // 原子地撤销映射 取得最终的脏位
+                    entry = __atomic_exchange_n(&pt[l].ref_page_entry.address, 0, __ATOMIC_SEQ_CST);
+
+                    migrations[count].pte = &pt[l];
+                    migrations[count].entry = entry;
+                    migrations[count].old = old;
+                    migrations[count].new = new;
+                    count ++;
+
+                    tlb_batch_add(&batch, base | (j << 30) | (k << 21) | (l << 12));
+
+                    if (count == MIGRATE_BATCH) {
+                        finish_migrations(&batch, migrations, count);
+                        count = 0;
+                    }
+                }
+            }
+        }
+    }
+
+out:
+    finish_migrations(&batch, migrations, count);
+    spin_unlock(&address_space->lock);
+}
+
+/**
+ * @brief 整理一个区域
+ * 隔离区域中的页块 迁出其中的页后解除隔离 释放的页随之合并
+ *
+ * @param zone 内存区
+ * @param start 区域起始页框号
+ * @param pages 页数
+ */
+static void compact_unit(Zone *zone, qword start, qword pages) {
+    for (qword pfn = start ; pfn < start + pages ; pfn += PAGEBLOCK_PAGES) {
+        isolate_pageblock(zone, pfn);
+    }
+
+    spin_lock(&address_space_list_lock);
+    list_for_each(node, &address_space_list) {
+        migrate_address_space(list_entry(node, AddressSpace, list), zone, start, start + pages);
+    }
+    spin_unlock(&address_space_list_lock);
+
+    for (qword pfn = start ; pfn < start + pages ; pfn += PAGEBLOCK_PAGES) {
+        unisolate_pageblock(zone, pfn, MIGRATE_MOVABLE);
+    }
+}
+
+/**
+ * @brief 整理内存区 直到出现不小于2^order页的空闲块
+ * 把可移动页从几乎空闲的对齐区域中迁出
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @return 是否已有满足要求的空闲块
+ */
+bool compact_zone(Zone *zone, int order) {
+    if (order >= MAX_ORDER) {
+        return false;
+    }
+    if (zone_has_free_block(zone, order)) {
+        return true;
+    }
+    if (zone->free_frame_num < (1ull << order) || compact_deferred(zone)) {
+        return false;
+    }
+
+    Spinlock *lock = &compact_locks[zone->node];
+    if (! spin_trylock(lock)) {
+        return false;
+    }
+
+    int unit_order = order > PAGEBLOCK_ORDER ? order : PAGEBLOCK_ORDER;
+    bool success = false;
+
+    for (int attempt = 0 ; attempt < COMPACT_ATTEMPTS && ! success ; attempt ++) {
+        qword start;
+        if (! find_candidate(zone, unit_order, &start)) {
+            break;
+        }
+        compact_unit(zone, start, 1ull << unit_order);
+        success = zone_has_free_block(zone, order);
+    }
+
+    compact_record(zone, success);
+    spin_unlock(lock);
+    return success;
+}
+
+/**
+ * @brief 内存区的碎片化程度
+ * 不在页块大小以上空闲块中的空闲页所占的百分比
+ *
+ * @param zone 内存区
+ * @return 碎片化程度(百分比)
+ */
+static int zone_fragmentation(Zone *zone) {
+    if (zone->free_frame_num == 0) {
+        return 0;
+    }
+
+    qword large = 0;
+    for (int order = PAGEBLOCK_ORDER ; order < MAX_ORDER ; order ++) {
+        large += zone->free_areas[order].count << order;
+    }
+    return 100 - (int)(large * 100 / zone->free_frame_num);
+}
+
+/**
+ * @brief 后台整理
+ * 由空闲循环调用 保持每个节点都有空闲的页块供大页使用
+ * 每次每个节点最多整理一个页块
+ *
+ * @return 是否做了工作
+ */
+bool compact_background(void) {
+    bool worked = false;
+
+    for (int node = 0 ; node < numa_node_num ; node ++) {
+        Zone *zone = &zones[node];
+        if (zone->free_frame_num < PAGEBLOCK_PAGES * 2 ||
+            zone_fragmentation(zone) <= COMPACT_PROACTIVE_THRESHOLD ||
+            compact_deferred(zone)) {
+            continue;
+        }
+
+        Spinlock *lock = &compact_locks[node];
+        if (! spin_trylock(lock)) {
+            continue;
+        }
+
+        qword start;
+        bool success = find_candidate(zone, PAGEBLOCK_ORDER, &start);
+        if (success) {
+            compact_unit(zone, start, PAGEBLOCK_PAGES);
+            worked = true;
+        }
+
+        compact_record(zone, success);
+        spin_unlock(lock);
+    }
+
+    return worked;
+}
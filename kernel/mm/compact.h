@@ -0,0 +1,36 @@
+/**
+ * @file compact.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内存整理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/buddy.h>
+
+/** 整理连续失败后最多推迟的轮数(2的幂) */
+#define COMPACT_MAX_DEFER_SHIFT (6)
+
+/**
+ * @brief 整理内存区 直到出现不小于2^order页的空闲块
+ * 把可移动页从几乎空闲的对齐区域中迁出
+ *
+ * @param zone 内存区
+ * @param order 阶数
+ * @return 是否已有满足要求的空闲块
+ */
+bool compact_zone(Zone *zone, int order);
+
+/**
+ * @brief 后台整理
+ * 由空闲循环调用 保持每个节点都有空闲的页块供大页使用
+ *
+ * @return 是否做了工作
+ */
+bool compact_background(void);
@@ -0,0 +1,129 @@
+/**
+ * @file direct_map.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 物理内存直接映射
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/direct_map.h>
+#include <mm/memblock.h>
+#include <mm/vmm.h>
+#include <tay/paging.h>
+#include <tay/cpuid.h>
+#include <tay/cr.h>
+#include <basec/logger.h>
+
+/** 已映射的物理内存上界 */
+qword direct_map_end = 0;
+
+/**
+ * @brief 获取下一级页表 不存在时新建
+ * 直接映射建立之前 页表只能经加载器为内核映像建立的映射访问
+ * 新页表来自memblock 此时伙伴系统尚不存在
+ *
+ * @param entry 表项
+ * @return 下一级页表
+ */
+static void *early_table(PagingTableEntry *entry) {
+    if (entry->P) {
+        return early_phys_to_virt(get_pagingtab_addr(*entry));
+    }
+
+    qword table = memblock_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (table == MEMBLOCK_ALLOC_FAILED) {
+        log_fatal("无法为直接映射分配页表");
+        while (true);
+    }
+
+    entry->address = table | PAGE_PRESENT | PAGE_WRITE;
+    return early_phys_to_virt(table);
+}
+
+/**
+ * @brief 计算需要映射的物理内存上界
+ * 只统计内存条目 不映射末尾的设备地址空间
+ *
+ * @param boot_info 启动信息
+ * @return 上界(2MB对齐)
+ */
+static qword memory_top(BootInfo *boot_info) {
+    qword top = 0;
+
+    for (dword i = 0 ; i < boot_info->memory_entry_num ; i ++) {
+        BootMemoryEntry *entry = &boot_info->memory_map[i];
+        if (entry->type != BOOT_MEMORY_AVAILABLE &&
+            entry->type != BOOT_MEMORY_ACPI_RECLAIMABLE &&
+            entry->type != BOOT_MEMORY_NVS) {
+            continue;
+        }
+        if (entry->base + entry->length > top) {
+            top = entry->base + entry->length;
+        }
+    }
+
+    top = (top + PAGE_2M_SIZE - 1) & ~(PAGE_2M_SIZE - 1);
+    if (top > DIRECT_MAP_SIZE) {
+        top = DIRECT_MAP_SIZE;
+    }
+    return top;
+}
+
+/**
+ * @brief 建立直接映射
+ * 以1GB页(不支持时以2MB页)映射全部物理内存 并设为全局页
+ * 低4GB中的设备空洞也会被映射 其缓存类型由MTRR限定为UC
+ *
+ * @param boot_info 启动信息
+ */
+void init_direct_map(BootInfo *boot_info) {
+    qword top = memory_top(boot_info);
+
+    bool gbpages = cpuid_max_ext_leaf() >= 0x80000001 &&
+                   (cpuid(0x80000001, 0).edx & CPUID_80000001_EDX_PAGE1GB) != 0;
+
+    // 全局页在切换CR3时不会被刷新
+    qword global = 0;
+    if (cpuid(1, 0).edx & CPUID_01_EDX_PGE) {
+        CR4 cr4 = rdcr4();
+        cr4.PGE = true;
+        wrcr4(cr4);
+        global = PAGE_GLOBAL;
+    }
+
+    qword flags = PAGE_PRESENT | PAGE_WRITE | PAGE_HUGE | global;
+    void *root = early_phys_to_virt(kernel_address_space.root);
+
+    qword phys = 0;
+    while (phys < top) {
+        qword virt = DIRECT_MAP_BASE + phys;
+
+        PML4E *pml4 = root;
+        if (paging_levels == 5) {
+            pml4 = early_table(&((PML5E *)root)[PML5_INDEX(virt)].ref_pml4e_entry);
+        }
+
+        PDPTE *pdpt = early_table(&pml4[PML4_INDEX(virt)].ref_pdpt_entry);
+        PDPTE *pdpte = &pdpt[PDPT_INDEX(virt)];
+
+        // 整个1GB都在内存范围内时才使用1GB页
+        if (gbpages && phys + PAGE_1G_SIZE <= top) {
+            pdpte->ref_page_entry.address = phys | flags;
+            phys += PAGE_1G_SIZE;
+            continue;
+        }
+
+        PDE *pd = early_table(&pdpte->ref_pde_entry);
+        pd[PD_INDEX(virt)].ref_page_entry.address = phys | flags;
+        phys += PAGE_2M_SIZE;
+    }
+
+    direct_map_end = top;
+    memblock_set_limit(top);
+
+    log_info("直接映射: %dMB 物理内存, 使用%s页", (int)(top >> 20), gbpages ? "1GB" : "2MB");
+}
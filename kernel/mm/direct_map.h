@@ -0,0 +1,62 @@
+/**
+ * @file direct_map.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 物理内存直接映射
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <tay/boot.h>
+
+/** 直接映射区起始地址(内核空间的起点) */
+#define DIRECT_MAP_BASE (0xFFFF800000000000ull)
+/** 直接映射区大小上限(64TB) */
+#define DIRECT_MAP_SIZE (1ull << 46)
+
+/** 已映射的物理内存上界 */
+extern qword direct_map_end;
+
+/**
+ * @brief 物理地址在直接映射区中的虚拟地址
+ *
+ * @param phys 物理地址
+ * @return 虚拟地址
+ */
+static inline void *phys_to_virt(qword phys) {
+    return (void *)(phys + DIRECT_MAP_BASE);
+}
+
+/**
+ * @brief 直接映射区中的虚拟地址对应的物理地址
+ *
+ * @param virt 虚拟地址
+ * @return 物理地址
+ */
+static inline qword virt_to_phys(void *virt) {
+    return (qword)virt - DIRECT_MAP_BASE;
+}
+
+/**
+ * @brief 内核映像中的地址对应的物理地址
+ *
+ * @param virt 内核映像中的虚拟地址
+ * @return 物理地址
+ */
+static inline qword kernel_virt_to_phys(void *virt) {
+    return (qword)virt - KERNEL_VIRT_BASE;
+}
+
+/**
+ * @brief 建立直接映射
+ * 在memblock初始化后 任何经phys_to_virt访问物理内存之前调用
+ *
+ * @param boot_info 启动信息
+ */
+void init_direct_map(BootInfo *boot_info);
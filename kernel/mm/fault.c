@@ -0,0 +1,164 @@
+/**
+ * @file fault.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 缺页处理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/fault.h>
+#include <mm/paging.h>
+#include <mm/buddy.h>
+#include <mm/vma.h>
+#include <mm/reclaim.h>
+#include <mm/swap.h>
+#include <mm/huge.h>
+#include <mm/color.h>
+#include <tay/tlb.h>
+#include <string.h>
+
+/**
+ * @brief 处理匿名页的首次访问
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pte PTE
+ * @return 是否成功
+ */
+static bool do_anonymous_fault(AddressSpace *address_space, VMArea *vma, PTE *pte) {
+    PageFrame *frame = alloc_user_frame(address_space, true);
+    if (frame == NULL) {
+        return false;
+    }
+
+    frame->flags |= FRAME_ANON;
+    pte->ref_page_entry.address = frame_to_phys(frame) | vma_page_flags(vma);
+    lru_add(frame);
+    return true;
+}
+
+/**
+ * @brief 处理对已换出页的访问
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pte PTE(其中为换出项)
+ * @return 是否成功
+ */
+static bool do_swap_fault(AddressSpace *address_space, VMArea *vma, PTE *pte) {
+    qword entry = pte->ref_page_entry.address;
+
+    PageFrame *frame = alloc_user_frame(address_space, false);
+    if (frame == NULL) {
+        return false;
+    }
+
+    if (! swap_in(entry, frame)) {
+        free_frames(frame, 0);
+        return false;
+    }
+
+    frame->flags |= FRAME_ANON;
+    pte->ref_page_entry.address = frame_to_phys(frame) | vma_page_flags(vma);
+    swap_free(entry);
+    lru_add(frame);
+    return true;
+}
+
+/**
+ * @brief 处理对写时复制页的写入
+ * 只有本地址空间引用该页时直接恢复写权限 否则复制一份
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pte PTE
+ * @param address 页地址
+ * @return 是否成功
+ */
+static bool do_cow_fault(AddressSpace *address_space, VMArea *vma, PTE *pte, qword address) {
+    qword entry = pte->ref_page_entry.address;
+    PageFrame *old = phys_to_frame(entry & PAGE_ENTRY_4K_MASK);
+
+    if (__atomic_load_n(&old->refcount, __ATOMIC_SEQ_CST) == 1) {
+        // 其他地址空间都已经复制走了
+        pte->ref_page_entry.address = (entry & ~PAGE_COW_BIT) | PAGE_WRITE;
+        invlpg((void *)address);
+        return true;
+    }
+
+    PageFrame *copy = alloc_user_frame(address_space, false);
+    if (copy == NULL) {
+        return false;
+    }
+
+    copy->flags |= FRAME_ANON;
+    memcpy(frame_to_ptr(copy), frame_to_ptr(old), PAGE_SIZE);
+
+    pte->ref_page_entry.address = frame_to_phys(copy) | vma_page_flags(vma);
+    lru_add(copy);
+
+    // 其他CPU上可能缓存着指向旧页的只读项
+    tlb_flush_range(address_space, address, address + PAGE_SIZE, false);
+    frame_put(old);
+
+    return true;
+}
+
+/**
+ * @brief 处理缺页
+ *
+ * @param address_space 地址空间
+ * @param address 引发缺页的地址(CR2)
+ * @param error_code 错误码
+ * @return 是否已解决
+ */
+bool handle_page_fault(AddressSpace *address_space, qword address, qword error_code) {
+    bool write = (error_code & PF_WRITE) != 0;
+    qword page = address & ~(qword)(PAGE_SIZE - 1);
+
+    spin_lock(&address_space->lock);
+
+    VMArea *vma = find_vma(address_space, address);
+    if (vma == NULL || (write && (vma->flags & VMA_WRITE) == 0)) {
+        spin_unlock(&address_space->lock);
+        return false;
+    }
+
+    bool solved = false;
+    PDE *pde = walk_pde(address_space, page, WALK_CREATE);
+    PTE *pte = NULL;
+
+    if (pde == NULL) {
+        solved = false;
+    }
+    else if (pde->ref_pt_entry.P && pde->ref_pt_entry.PS) {
+        solved = do_huge_pmd_fault(address_space, vma, pde, page, write);
+    }
+    else if (! pde->ref_pt_entry.P && do_huge_anonymous_fault(address_space, vma, pde, page)) {
+        solved = true;
+    }
+    else if ((pte = walk_pte(address_space, page, WALK_CREATE | WALK_WRITE)) == NULL) {
+        solved = false;
+    }
+    else if (is_swap_entry(pte->ref_page_entry.address)) {
+        solved = do_swap_fault(address_space, vma, pte);
+    }
+    else if (! pte->ref_page_entry.P) {
+        solved = do_anonymous_fault(address_space, vma, pte);
+    }
+    else if (write && ! pte->ref_page_entry.RW) {
+        solved = do_cow_fault(address_space, vma, pte, page);
+    }
+    else {
+        // 其他CPU已经处理过 本CPU的TLB项已过期
+        invlpg((void *)page);
+        solved = true;
+    }
+
+    spin_unlock(&address_space->lock);
+    return solved;
+}
\ No newline at end of file
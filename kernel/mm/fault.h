@@ -0,0 +1,34 @@
+/**
+ * @file fault.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 缺页处理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/vmm.h>
+
+/** 错误码: 页存在(保护违例) */
+#define PF_PRESENT (1 << 0)
+/** 错误码: 写访问 */
+#define PF_WRITE   (1 << 1)
+/** 错误码: 用户态访问 */
+#define PF_USER    (1 << 2)
+/** 错误码: 取指 */
+#define PF_INSTR   (1 << 4)
+
+/**
+ * @brief 处理缺页
+ *
+ * @param address_space 地址空间
+ * @param address 引发缺页的地址(CR2)
+ * @param error_code 错误码
+ * @return 是否已解决
+ */
+bool handle_page_fault(AddressSpace *address_space, qword address, qword error_code);
\ No newline at end of file
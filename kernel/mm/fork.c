@@ -0,0 +1,134 @@
+/**
+ * @file fork.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 地址空间的写时复制
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/fork.h>
+#include <mm/paging.h>
+#include <mm/buddy.h>
+#include <mm/vma.h>
+
+/**
+ * @brief 新建一张空的用户页表
+ *
+ * @param entry 指向该页表的表项
+ * @return 页表 失败时为NULL
+ */
+static void *new_user_table(PagingTableEntry *entry) {
+    PageFrame *frame = alloc_zeroed_frame(0);
+    if (frame == NULL) {
+        return NULL;
+    }
+    frame->flags |= FRAME_PAGETABLE;
+    entry->address = frame_to_phys(frame) | PAGE_PRESENT | PAGE_WRITE | PAGE_USER;
+    return frame_to_ptr(frame);
+}
+
+/**
+ * @brief 复制一张PD
+ * PDE指向的页表与大页都与父地址空间共享
+ *
+ * @param child_pd 子PD
+ * @param parent_pd 父PD
+ */
+static void share_pd(PDE *child_pd, PDE *parent_pd) {
+    for (int i = 0 ; i < PDE_PER_TAB ; i ++) {
+        qword pde = parent_pd[i].ref_pt_entry.address;
+        if ((pde & PAGE_PRESENT) == 0) {
+            continue;
+        }
+
+        if (pde & PAGE_HUGE) {
+            // 大页按页写时复制
+            if (pde & PAGE_WRITE) {
+                pde = (pde & ~PAGE_WRITE) | PAGE_COW_BIT;
+            }
+            frame_get(phys_to_frame(pde & PAGE_ENTRY_2M_MASK));
+        }
+        else {
+            // 写保护整张页表 首次写入时再复制页表
+            pde &= ~PAGE_WRITE;
+            frame_get(phys_to_frame(pde & PAGING_TABLE_ENTRY_MASK));
+        }
+
+        parent_pd[i].ref_pt_entry.address = pde;
+        child_pd[i].ref_pt_entry.address = pde;
+    }
+}
+
+/**
+ * @brief 以写时复制方式复制地址空间
+ * 只复制PML5, PML4, PDPT与PD 最后一级页表由父子共享并通过PDE写保护
+ * 开销与映射的2MB区域数成正比 与页数无关
+ *
+ * @param child 子地址空间(未初始化)
+ * @param parent 父地址空间
+ * @return 是否成功
+ */
+bool fork_address_space(AddressSpace *child, AddressSpace *parent) {
+    if (! create_address_space(child)) {
+        return false;
+    }
+
+    // 子进程与父进程共用缓存分区
+    child->color_first = parent->color_first;
+    child->color_num = parent->color_num;
+
+    spin_lock(&parent->lock);
+
+    bool success = copy_vmas(child, parent);
+
+    PML4E *parent_pml4e;
+    for_each_user_pml4e(parent_pml4e, address, parent) {
+        if (! success) {
+            break;
+        }
+
+        PML4E *child_pml4e = walk_pml4e(child, address, WALK_CREATE);
+        if (child_pml4e == NULL) {
+            success = false;
+            break;
+        }
+
+        PDPTE *parent_pdpt = table_ptr(parent_pml4e->ref_pdpt_entry.address);
+        PDPTE *child_pdpt = new_user_table(&child_pml4e->ref_pdpt_entry);
+        if (child_pdpt == NULL) {
+            success = false;
+            break;
+        }
+
+        for (int j = 0 ; j < PDPTE_PER_TAB ; j ++) {
+            if (! parent_pdpt[j].ref_pde_entry.P) {
+                continue;
+            }
+
+            PDE *parent_pd = table_ptr(parent_pdpt[j].ref_pde_entry.address);
+            PDE *child_pd = new_user_table(&child_pdpt[j].ref_pde_entry);
+            if (child_pd == NULL) {
+                success = false;
+                break;
+            }
+
+            share_pd(child_pd, parent_pd);
+        }
+    }
+
+    spin_unlock(&parent->lock);
+
+    // 父地址空间中的页被写保护 已缓存的可写项必须作废
+    tlb_flush_range(parent, USER_SPACE_START, TLB_FLUSH_ALL, false);
+
+    if (! success) {
+        destroy_address_space(child);
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+/**
+ * @file fork.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 地址空间的写时复制
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/vmm.h>
+
+/**
+ * @brief 以写时复制方式复制地址空间
+ * 只复制PML5, PML4, PDPT与PD 最后一级页表由父子共享并通过PDE写保护
+ * 开销与映射的2MB区域数成正比 与页数无关
+ *
+ * @param child 子地址空间(未初始化)
+ * @param parent 父地址空间
+ * @return 是否成功
+ */
+bool fork_address_space(AddressSpace *child, AddressSpace *parent);
\ No newline at end of file
@@ -0,0 +1,35 @@
+/**
+ * @file frame.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 物理页框
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/frame.h>
+#include <mm/buddy.h>
+#include <mm/reclaim.h>
+
+/** 页框描述符表(由memblock分配 经直接映射访问) */
+PageFrame *frames = NULL;
+
+/** 实际页框数 */
+qword frame_num = 0;
+
+/**
+ * @brief 减少页框引用 减为0时释放
+ *
+ * @param frame 页框
+ */
+void frame_put(PageFrame *frame) {
+    if (__atomic_sub_fetch(&frame->refcount, 1, __ATOMIC_SEQ_CST) == 0) {
+        if (frame->flags & FRAME_LRU) {
+            lru_del(frame);
+        }
+        free_frames(frame, frame->order);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+/**
+ * @file frame.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 物理页框
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <tay/paging.h>
+#include <lib/list.h>
+#include <mm/direct_map.h>
+
+/**
+ * @brief 页框标志
+ *
+ */
+enum FrameFlags {
+    /** 保留(不可分配) */
+    FRAME_RESERVED   = 1 << 0,
+    /** 空闲块的首页框 */
+    FRAME_FREE       = 1 << 1,
+    /** 页表 */
+    FRAME_PAGETABLE  = 1 << 2,
+    /** slab */
+    FRAME_SLAB       = 1 << 3,
+    /** 匿名页 */
+    FRAME_ANON       = 1 << 4,
+    /** 在LRU链表中 */
+    FRAME_LRU        = 1 << 5,
+    /** 在活跃链表中 */
+    FRAME_ACTIVE     = 1 << 6,
+    /** 上次扫描后被访问过 */
+    FRAME_REFERENCED = 1 << 7,
+    /** 已被选为回收对象 下次扫描页表时换出 */
+    FRAME_RECLAIM    = 1 << 8,
+    /** 由KSM合并的只读共享页 */
+    FRAME_KSM        = 1 << 9
+};
+
+/**
+ * @brief 页框描述符
+ *
+ */
+typedef struct {
+    /** 空闲链表/slab链表 */
+    ListNode list;
+    /**
+     * @brief 引用计数
+     * 对页表页框而言为共享该页表的地址空间数
+     *
+     */
+    int refcount;
+    /** 标志 */
+    dword flags;
+    /** 块阶数 */
+    byte order;
+    /** 所在NUMA节点 */
+    byte node;
+    /** KSM上次扫描时的内容校验和 */
+    dword checksum;
+    /** 使用者私有数据 */
+    void *private;
+} PageFrame;
+
+/** 页框描述符表(由memblock分配 经直接映射访问) */
+extern PageFrame *frames;
+
+/** 实际页框数 */
+extern qword frame_num;
+
+/**
+ * @brief 页框号
+ *
+ * @param frame 页框
+ * @return 页框号
+ */
+static inline qword frame_to_pfn(PageFrame *frame) {
+    return frame - frames;
+}
+
+/**
+ * @brief 页框号对应的页框
+ *
+ * @param pfn 页框号
+ * @return 页框
+ */
+static inline PageFrame *pfn_to_frame(qword pfn) {
+    return &frames[pfn];
+}
+
+/**
+ * @brief 页框的物理地址
+ *
+ * @param frame 页框
+ * @return 物理地址
+ */
+static inline qword frame_to_phys(PageFrame *frame) {
+    return frame_to_pfn(frame) * PAGE_SIZE;
+}
+
+/**
+ * @brief 物理地址所在的页框
+ *
+ * @param phys 物理地址
+ * @return 页框
+ */
+static inline PageFrame *phys_to_frame(qword phys) {
+    return pfn_to_frame(phys / PAGE_SIZE);
+}
+
+/**
+ * @brief 页框在内核中的访问地址
+ * 经直接映射访问
+ *
+ * @param frame 页框
+ * @return 访问地址
+ */
+static inline void *frame_to_ptr(PageFrame *frame) {
+    return phys_to_virt(frame_to_phys(frame));
+}
+
+/**
+ * @brief 内核访问地址所在的页框
+ *
+ * @param ptr 访问地址
+ * @return 页框
+ */
+static inline PageFrame *ptr_to_frame(void *ptr) {
+    return phys_to_frame(virt_to_phys(ptr));
+}
+
+/**
+ * @brief 增加页框引用
+ *
+ * @param frame 页框
+ */
+static inline void frame_get(PageFrame *frame) {
+    __atomic_add_fetch(&frame->refcount, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 减少页框引用 减为0时释放
+ *
+ * @param frame 页框
+ */
+void frame_put(PageFrame *frame);
\ No newline at end of file
@@ -0,0 +1,377 @@
+/**
+ * @file huge.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 匿名内存的透明大页
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/huge.h>
+#include <mm/paging.h>
+#include <mm/buddy.h>
+#include <mm/reclaim.h>
+#include <mm/swap.h>
+#include <mm/tlb.h>
+#include <mm/color.h>
+#include <tay/tlb.h>
+#include <string.h>
+
+/**
+ * @brief 后台合并的扫描位置
+ *
+ */
+typedef struct {
+    /** 地址空间 为NULL时从链表头开始新的一遍 */
+    AddressSpace *address_space;
+    /** 下一个要扫描的地址(2MB对齐) */
+    qword address;
+} KhugepagedCursor;
+
+// 是否启用透明大页
+static bool thp_enabled = true;
+// 每轮扫描的页数
+static dword khugepaged_scan_rate = KHUGEPAGED_DEFAULT_SCAN_RATE;
+// 同一时刻只有一个CPU扫描
+static Spinlock khugepaged_lock = SPINLOCK_INIT;
+// 扫描位置
+static KhugepagedCursor khugepaged_cursor = { .address_space = NULL, .address = USER_SPACE_START };
+
+/**
+ * @brief 启用或停用透明大页
+ * 停用后缺页只分配4K页 后台也不再合并
+ *
+ * @param enabled 是否启用
+ */
+void thp_set_enabled(bool enabled) {
+    __atomic_store_n(&thp_enabled, enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 设置后台合并的扫描速度
+ *
+ * @param pages 每轮扫描的页数 为0时停止扫描
+ */
+void khugepaged_set_scan_rate(dword pages) {
+    __atomic_store_n(&khugepaged_scan_rate, pages, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 能否用大页映射地址所在的2MB对齐范围
+ * 区域须完整覆盖该范围 大页覆盖所有缓存颜色 设置了颜色的地址空间不使用大页
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param address 地址
+ * @return 是否能
+ */
+static bool thp_suitable(AddressSpace *address_space, VMArea *vma, qword address) {
+    qword start = address & ~(PAGE_2M_SIZE - 1);
+    return __atomic_load_n(&thp_enabled, __ATOMIC_RELAXED) && address_space->color_num == 0 &&
+        (vma->flags & VMA_ANON) != 0 && start >= vma->start && start + PAGE_2M_SIZE <= vma->end;
+}
+
+/**
+ * @brief 分配大页
+ * 不整理也不回收 拿不到时立即回退到4K页
+ *
+ * @return 页框 失败时为NULL
+ */
+static PageFrame *alloc_huge_frame(void) {
+    PageFrame *frame = alloc_frames_node(current_node(), THP_ORDER, ALLOC_MOVABLE | ALLOC_NOCOMPACT | ALLOC_NORECLAIM);
+    if (frame != NULL) {
+        frame->flags |= FRAME_ANON;
+    }
+    return frame;
+}
+
+/**
+ * @brief 以大页处理匿名区域的首次访问
+ * 区域完整覆盖该地址所在的2MB对齐范围时才分配大页
+ * 大页覆盖所有缓存颜色 设置了颜色的地址空间不使用大页
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pde PDE(不存在)
+ * @param address 地址
+ * @return 是否已映射大页 为false时应回退到4K页
+ */
+bool do_huge_anonymous_fault(AddressSpace *address_space, VMArea *vma, PDE *pde, qword address) {
+    if (! thp_suitable(address_space, vma, address)) {
+        return false;
+    }
+
+    PageFrame *frame = alloc_huge_frame();
+    if (frame == NULL) {
+        return false;
+    }
+
+    memset(frame_to_ptr(frame), 0, PAGE_2M_SIZE);
+    pde->ref_page_entry.address = frame_to_phys(frame) | vma_page_flags(vma) | PAGE_HUGE;
+    return true;
+}
+
+/**
+ * @brief 把共享的大页拆分为本地址空间独占的4K页
+ * 新页表中的每一页都是大页对应部分的副本
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pde PDE(大页)
+ * @param old 大页
+ * @return 是否成功
+ */
+static bool split_huge_copy(AddressSpace *address_space, VMArea *vma, PDE *pde, PageFrame *old) {
+    PageFrame *table = alloc_zeroed_frame(0);
+    if (table == NULL) {
+        return false;
+    }
+    table->flags |= FRAME_PAGETABLE;
+
+    PTE *pt = frame_to_ptr(table);
+    byte *source = frame_to_ptr(old);
+
+    for (int i = 0 ; i < PTE_PER_TAB ; i ++) {
+        PageFrame *copy = alloc_user_frame(address_space, false);
+        if (copy == NULL) {
+            // 释放已复制的页与页表
+            put_page_table(table);
+            return false;
+        }
+        copy->flags |= FRAME_ANON;
+        memcpy(frame_to_ptr(copy), source + i * PAGE_SIZE, PAGE_SIZE);
+        pt[i].ref_page_entry.address = frame_to_phys(copy) | vma_page_flags(vma);
+    }
+
+    for (int i = 0 ; i < PTE_PER_TAB ; i ++) {
+        lru_add(phys_to_frame(get_4k_page_addr(pt[i].ref_page_entry)));
+    }
+
+    pde->ref_pt_entry.address = frame_to_phys(table) | PAGE_PRESENT | PAGE_WRITE | PAGE_USER;
+    return true;
+}
+
+/**
+ * @brief 处理对已映射大页的访问
+ * 写时复制优先复制为新的大页 失败时拆分为4K页逐页复制
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pde PDE(大页)
+ * @param address 地址
+ * @param write 是否为写入
+ * @return 是否成功
+ */
+bool do_huge_pmd_fault(AddressSpace *address_space, VMArea *vma, PDE *pde, qword address, bool write) {
+    qword start = address & ~(PAGE_2M_SIZE - 1);
+    qword entry = pde->ref_page_entry.address;
+
+    if (! write || (entry & PAGE_WRITE)) {
+        // 其他CPU已经处理过 本CPU的TLB项已过期
+        invlpg((void *)start);
+        return true;
+    }
+
+    PageFrame *old = phys_to_frame(entry & PAGE_ENTRY_2M_MASK);
+
+    if (__atomic_load_n(&old->refcount, __ATOMIC_SEQ_CST) == 1) {
+        // 其他地址空间都已经复制走了
+        pde->ref_page_entry.address = (entry & ~PAGE_COW_BIT) | PAGE_WRITE;
+        invlpg((void *)start);
+        return true;
+    }
+
+    PageFrame *copy = alloc_huge_frame();
+    if (copy != NULL) {
+        memcpy(frame_to_ptr(copy), frame_to_ptr(old), PAGE_2M_SIZE);
+        pde->ref_page_entry.address = frame_to_phys(copy) | vma_page_flags(vma) | PAGE_HUGE;
+    }
+    else if (! split_huge_copy(address_space, vma, pde, old)) {
+        return false;
+    }
+
+    // 其他CPU上可能缓存着指向旧页的只读项
+    tlb_flush_range(address_space, start, start + PAGE_2M_SIZE, false);
+    frame_put(old);
+
+    return true;
+}
+
+/**
+ * @brief 页表中的页能否合并为大页
+ * 页都须为仅映射一次的匿名页 不能有换出项 空项不能太多
+ *
+ * @param pt 页表
+ * @return 是否能
+ */
+static bool collapse_candidate(PTE *pt) {
+    int none = 0;
+    for (int i = 0 ; i < PTE_PER_TAB ; i ++) {
+        qword entry = pt[i].ref_page_entry.address;
+        if ((entry & PAGE_PRESENT) == 0) {
+            if (is_swap_entry(entry) || ++ none > KHUGEPAGED_MAX_PTES_NONE) {
+                return false;
+            }
+            continue;
+        }
+
+        PageFrame *frame = phys_to_frame(entry & PAGE_ENTRY_4K_MASK);
+        if ((frame->flags & (FRAME_ANON | FRAME_KSM)) != FRAME_ANON || frame->refcount != 1) {
+            return false;
+        }
+    }
+    return none != PTE_PER_TAB;
+}
+
+/**
+ * @brief 把页表映射的4K页合并为大页
+ * 先撤销整张页表并刷新TLB使内容固定 再复制到大页
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pde PDE(指向页表)
+ * @param start 2MB对齐的地址
+ * @return 是否成功
+ */
+static bool collapse_huge_page(AddressSpace *address_space, VMArea *vma, PDE *pde, qword start) {
+    PageFrame *huge = alloc_huge_frame();
+    if (huge == NULL) {
+        return false;
+    }
+
+    qword entry = __atomic_exchange_n(&pde->ref_pt_entry.address, 0, __ATOMIC_SEQ_CST);
+    tlb_flush_range(address_space, start, start + PAGE_2M_SIZE, true);
+
+    PageFrame *table = phys_to_frame(entry & PAGING_TABLE_ENTRY_MASK);
+    PTE *pt = frame_to_ptr(table);
+    byte *destination = frame_to_ptr(huge);
+
+    for (int i = 0 ; i < PTE_PER_TAB ; i ++) {
+        if (pt[i].ref_page_entry.P) {
+            memcpy(destination + i * PAGE_SIZE, frame_to_ptr(phys_to_frame(get_4k_page_addr(pt[i].ref_page_entry))), PAGE_SIZE);
+        }
+        else {
+            memset(destination + i * PAGE_SIZE, 0, PAGE_SIZE);
+        }
+    }
+
+    pde->ref_page_entry.address = frame_to_phys(huge) | vma_page_flags(vma) | PAGE_HUGE;
+
+    // 页表只被本地址空间引用 释放时一并释放原来的4K页
+    put_page_table(table);
+    return true;
+}
+
+/**
+ * @brief 从扫描位置起扫描地址空间
+ *
+ * @param address_space 地址空间
+ * @param budget 剩余可扫描的页数
+ * @return 是否已扫描完该地址空间
+ */
+static bool scan_address_space(AddressSpace *address_space, int *budget) {
+    // 持有地址空间锁的路径可能正在等待 不能在此等待 本遍跳过
+    if (! spin_trylock(&address_space->lock)) {
+        return true;
+    }
+
+    qword address = khugepaged_cursor.address;
+    PML4E *pml4e;
+    qword base = address & ~(PML4E_SPAN - 1);
+
+    for ( ; (pml4e = next_user_pml4e(address_space, &base)) != NULL ; base += PML4E_SPAN) {
+        qword start = address > base ? address - base : 0;
+        qword k0 = (start >> 21) & (PDE_PER_TAB - 1);
+
+        PDPTE *pdpt = table_ptr(pml4e->ref_pdpt_entry.address);
+        for (qword j = start >> 30 ; j < PDPTE_PER_TAB ; j ++, k0 = 0) {
+            if (! pdpt[j].ref_pde_entry.P || pdpt[j].ref_pde_entry.PS) {
+                continue;
+            }
+
+            PDE *pd = table_ptr(pdpt[j].ref_pde_entry.address);
+            for (qword k = k0 ; k < PDE_PER_TAB ; k ++) {
+                PagingTableEntry *pde = &pd[k].ref_pt_entry;
+                // 共享的页表也映射在其他地址空间中 无法在此刷新它们的TLB
+                if (! pde->P || pde->PS || phys_to_frame(get_pagingtab_addr(*pde))->refcount != 1) {
+                    continue;
+                }
+
+                qword huge_start = base | (j << 30) | (k << 21);
+                if (*budget <= 0) {
+                    khugepaged_cursor.address = huge_start;
+                    spin_unlock(&address_space->lock);
+                    return false;
+                }
+                *budget -= PTE_PER_TAB;
+
+                VMArea *vma = find_vma(address_space, huge_start);
+                if (vma != NULL && thp_suitable(address_space, vma, huge_start) && collapse_candidate(table_ptr(pde->address))) {
+                    collapse_huge_page(address_space, vma, &pd[k], huge_start);
+                }
+            }
+        }
+    }
+
+    spin_unlock(&address_space->lock);
+    return true;
+}
+
+/**
+ * @brief 扫描位置所在的地址空间
+ *
+ * @return 地址空间 没有用户地址空间时为NULL
+ */
+static AddressSpace *cursor_address_space(void) {
+    list_for_each(node, &address_space_list) {
+        if (list_entry(node, AddressSpace, list) == khugepaged_cursor.address_space) {
+            return khugepaged_cursor.address_space;
+        }
+    }
+
+    // 新的一遍 或地址空间已被销毁
+    khugepaged_cursor.address = USER_SPACE_START;
+    if (list_empty(&address_space_list)) {
+        return NULL;
+    }
+    return list_entry(address_space_list.next, AddressSpace, list);
+}
+
+/**
+ * @brief 后台合并扫描一轮
+ * 由空闲循环调用 把匿名区域中由4K页映射的2MB范围合并为大页
+ *
+ * @return 是否做了工作
+ */
+bool khugepaged_run(void) {
+    int rate = __atomic_load_n(&khugepaged_scan_rate, __ATOMIC_RELAXED);
+    if (! __atomic_load_n(&thp_enabled, __ATOMIC_RELAXED) || rate == 0 || ! spin_trylock(&khugepaged_lock)) {
+        return false;
+    }
+
+    int budget = rate;
+
+    spin_lock(&address_space_list_lock);
+
+    AddressSpace *address_space = cursor_address_space();
+    while (address_space != NULL && budget > 0) {
+        if (! scan_address_space(address_space, &budget)) {
+            break;
+        }
+
+        address_space = address_space->list.next != &address_space_list ?
+            list_entry(address_space->list.next, AddressSpace, list) : NULL;
+        khugepaged_cursor.address = USER_SPACE_START;
+    }
+    khugepaged_cursor.address_space = address_space;
+
+    spin_unlock(&address_space_list_lock);
+
+    spin_unlock(&khugepaged_lock);
+    return budget != rate;
+}
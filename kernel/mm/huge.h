@@ -0,0 +1,76 @@
+/**
+ * @file huge.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 匿名内存的透明大页
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/vma.h>
+
+/** 大页阶数 */
+#define THP_ORDER (9)
+/** 大页页数 */
+#define THP_PAGES (1ull << THP_ORDER)
+
+/** 默认每轮扫描的页数 */
+#define KHUGEPAGED_DEFAULT_SCAN_RATE (4096)
+/** 合并时页表中最多允许的空项数 空项合并后为零页 */
+#define KHUGEPAGED_MAX_PTES_NONE (64)
+
+/**
+ * @brief 启用或停用透明大页
+ * 停用后缺页只分配4K页 后台也不再合并
+ *
+ * @param enabled 是否启用
+ */
+void thp_set_enabled(bool enabled);
+
+/**
+ * @brief 设置后台合并的扫描速度
+ *
+ * @param pages 每轮扫描的页数 为0时停止扫描
+ */
+void khugepaged_set_scan_rate(dword pages);
+
+/**
+ * @brief 以大页处理匿名区域的首次访问
+ * 区域完整覆盖该地址所在的2MB对齐范围时才分配大页
+ * 大页覆盖所有缓存颜色 设置了颜色的地址空间不使用大页
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pde PDE(不存在)
+ * @param address 地址
+ * @return 是否已映射大页 为false时应回退到4K页
+ */
+bool do_huge_anonymous_fault(AddressSpace *address_space, VMArea *vma, PDE *pde, qword address);
+
+/**
+ * @brief 处理对已映射大页的访问
+ * 写时复制优先复制为新的大页 失败时拆分为4K页逐页复制
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param vma 区域
+ * @param pde PDE(大页)
+ * @param address 地址
+ * @param write 是否为写入
+ * @return 是否成功
+ */
+bool do_huge_pmd_fault(AddressSpace *address_space, VMArea *vma, PDE *pde, qword address, bool write);
+
+/**
+ * @brief 后台合并扫描一轮
+ * 由空闲循环调用 把匿名区域中由4K页映射的2MB范围合并为大页
+ *
+ * @return 是否做了工作
+ */
+bool khugepaged_run(void);
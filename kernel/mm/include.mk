@@ -0,0 +1,25 @@
+objects += mm/vmm.o
+objects += mm/pcid.o
+objects += mm/tlb.o
+objects += mm/frame.o
+objects += mm/buddy.o
+objects += mm/slab.o
+objects += mm/paging.o
+objects += mm/vma.o
+objects += mm/fault.o
+objects += mm/fork.o
+objects += mm/zero.o
+objects += mm/direct_map.o
+objects += mm/numa.o
+objects += mm/compact.o
+objects += mm/vmalloc.o
+objects += mm/memblock.o
+objects += mm/kstack.o
+objects += mm/swap.o
+objects += mm/reclaim.o
+objects += mm/zsmalloc.o
+objects += mm/zswap.o
+objects += mm/ksm.o
+objects += mm/huge.o
+objects += mm/color.o
+objects += mm/pat.o
\ No newline at end of file
@@ -0,0 +1,421 @@
+/**
+ * @file ksm.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 相同匿名页合并
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/ksm.h>
+#include <mm/paging.h>
+#include <mm/reclaim.h>
+#include <mm/slab.h>
+#include <mm/tlb.h>
+#include <mm/vmm.h>
+#include <lib/rbtree.h>
+
+/**
+ * @brief 按页内容排序的树中的节点
+ *
+ */
+typedef struct {
+    /** 树节点 */
+    RBNode node;
+    /** 页框 */
+    PageFrame *frame;
+} KsmNode;
+
+/**
+ * @brief 扫描位置
+ *
+ */
+typedef struct {
+    /** 地址空间 为NULL时从链表头开始新的一遍 */
+    AddressSpace *address_space;
+    /** 下一个要扫描的地址 */
+    qword address;
+} KsmCursor;
+
+/** 被合并后的共享页数 */
+qword ksm_pages_shared = 0;
+
+/** 映射到共享页的次数(不含第一次) 即节省的页数 */
+qword ksm_pages_sharing = 0;
+
+// 树节点
+static KMemCache ksm_node_cache;
+// 已合并的共享页 持有页框的一个引用
+static RBTree stable_tree = RB_TREE_INIT;
+// 本遍扫描过的页 不持有引用 内容可能已变化 每遍结束后清空
+static RBTree unstable_tree = RB_TREE_INIT;
+// 同一时刻只有一个CPU扫描 保护两棵树与扫描位置
+static Spinlock ksm_lock = SPINLOCK_INIT;
+// 每轮扫描的页数
+static dword ksm_scan_rate = KSM_DEFAULT_SCAN_RATE;
+// 扫描位置
+static KsmCursor ksm_cursor = { .address_space = NULL, .address = USER_SPACE_START };
+// 是否已初始化
+static bool ksm_initialized = false;
+
+/**
+ * @brief 初始化KSM
+ * 需在init_slab之后调用
+ *
+ */
+void init_ksm(void) {
+    kmem_cache_init(&ksm_node_cache, "ksm_node", sizeof(KsmNode));
+    ksm_initialized = true;
+}
+
+/**
+ * @brief 设置扫描速度
+ *
+ * @param pages 每轮扫描的页数 为0时停止扫描
+ */
+void ksm_set_scan_rate(dword pages) {
+    __atomic_store_n(&ksm_scan_rate, pages, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 页内容的校验和
+ *
+ * @param page 页
+ * @return 校验和
+ */
+static dword page_checksum(qword *page) {
+    qword hash = 0;
+    for (int i = 0 ; i < PAGE_SIZE / sizeof(qword) ; i ++) {
+        hash = (hash ^ page[i]) * 0x100000001B3ull;
+    }
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief 比较两页的内容
+ *
+ * @param page1 页1
+ * @param page2 页2
+ * @return 小于/等于/大于时分别为负数/0/正数
+ */
+static int page_compare(qword *page1, qword *page2) {
+    for (int i = 0 ; i < PAGE_SIZE / sizeof(qword) ; i ++) {
+        if (page1[i] != page2[i]) {
+            return page1[i] < page2[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 在树中查找内容相同的页
+ *
+ * @param tree 树
+ * @param page 页
+ * @param link 未找到时返回插入位置 可为NULL
+ * @param parent 未找到时返回插入位置的父节点 可为NULL
+ * @return 节点 未找到时为NULL
+ */
+static KsmNode *tree_search(RBTree *tree, qword *page, RBNode ***link, RBNode **parent) {
+    RBNode **cursor = &tree->root;
+    RBNode *cursor_parent = NULL;
+
+    while (*cursor != NULL) {
+        KsmNode *node = rb_entry(*cursor, KsmNode, node);
+        int cmp = page_compare(page, frame_to_ptr(node->frame));
+        if (cmp == 0) {
+            return node;
+        }
+        cursor_parent = *cursor;
+        cursor = cmp < 0 ? &(*cursor)->left : &(*cursor)->right;
+    }
+
+    if (link != NULL) {
+        *link = cursor;
+        *parent = cursor_parent;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 在查找得到的位置插入节点
+ *
+ * @param tree 树
+ * @param frame 页框
+ * @param link 插入位置
+ * @param parent 插入位置的父节点
+ * @return 是否成功
+ */
+static bool tree_insert(RBTree *tree, PageFrame *frame, RBNode **link, RBNode *parent) {
+    KsmNode *node = kmem_cache_alloc(&ksm_node_cache);
+    if (node == NULL) {
+        return false;
+    }
+
+    node->frame = frame;
+    rb_link_node(&node->node, parent, link);
+    rb_insert_color(tree, &node->node, NULL);
+    return true;
+}
+
+/**
+ * @brief 将页改为映射内容相同的共享页
+ * 先撤销映射并刷新TLB使内容固定 再确认内容仍然相同
+ *
+ * @param address_space 地址空间
+ * @param pte PTE
+ * @param address 页地址
+ * @param frame 原页框
+ * @param stable 共享页
+ */
+static void merge_page(AddressSpace *address_space, PTE *pte, qword address, PageFrame *frame, KsmNode *stable) {
+    qword entry = __atomic_exchange_n(&pte->ref_page_entry.address, 0, __ATOMIC_SEQ_CST);
+    tlb_flush_range(address_space, address, address + PAGE_SIZE, false);
+
+    if (page_compare(frame_to_ptr(frame), frame_to_ptr(stable->frame)) != 0) {
+        pte->ref_page_entry.address = entry;
+        return;
+    }
+
+    frame_get(stable->frame);
+    pte->ref_page_entry.address = frame_to_phys(stable->frame) | (entry & ~PAGE_ENTRY_4K_MASK & ~PAGE_WRITE) | PAGE_COW_BIT;
+    frame_put(frame);
+    ksm_pages_sharing ++;
+}
+
+/**
+ * @brief 将页原地转为共享页
+ * 写保护并刷新TLB使内容固定 再确认仍与本遍扫描过的页相同
+ * 与之相同的页在下一遍扫描时合并进来
+ *
+ * @param address_space 地址空间
+ * @param pte PTE
+ * @param address 页地址
+ * @param frame 页框
+ * @param unstable 本遍扫描过的相同页
+ */
+static void promote_page(AddressSpace *address_space, PTE *pte, qword address, PageFrame *frame, KsmNode *unstable) {
+    qword entry = __atomic_fetch_and(&pte->ref_page_entry.address, ~PAGE_WRITE, __ATOMIC_SEQ_CST);
+    tlb_flush_range(address_space, address, address + PAGE_SIZE, false);
+
+    RBNode **link;
+    RBNode *parent;
+    if (page_compare(frame_to_ptr(frame), frame_to_ptr(unstable->frame)) != 0 ||
+        tree_search(&stable_tree, frame_to_ptr(frame), &link, &parent) != NULL ||
+        ! tree_insert(&stable_tree, frame, link, parent)) {
+        __atomic_fetch_or(&pte->ref_page_entry.address, entry & PAGE_WRITE, __ATOMIC_SEQ_CST);
+        return;
+    }
+
+    // 共享页不再参与回收 其引用计数总大于1 写入时总会复制
+    lru_del(frame);
+    __atomic_fetch_or(&frame->flags, FRAME_KSM, __ATOMIC_SEQ_CST);
+    __atomic_fetch_or(&pte->ref_page_entry.address, PAGE_COW_BIT, __ATOMIC_SEQ_CST);
+    frame_get(frame);
+    ksm_pages_shared ++;
+
+    rb_erase(&unstable_tree, &unstable->node, NULL);
+    kmem_cache_free(&ksm_node_cache, unstable);
+}
+
+/**
+ * @brief 扫描一页
+ *
+ * @param address_space 地址空间
+ * @param pte PTE
+ * @param address 页地址
+ */
+static void scan_page(AddressSpace *address_space, PTE *pte, qword address) {
+    qword entry = pte->ref_page_entry.address;
+    if ((entry & PAGE_PRESENT) == 0 || (entry & (PAGE_WRITE | PAGE_COW_BIT)) == 0) {
+        return;
+    }
+
+    // 只处理仅映射一次的私有匿名页
+    PageFrame *frame = phys_to_frame(entry & PAGE_ENTRY_4K_MASK);
+    if ((frame->flags & (FRAME_ANON | FRAME_KSM)) != FRAME_ANON || frame->refcount != 1) {
+        return;
+    }
+
+    // 两次扫描之间内容变化过的页很可能还会变化 不值得合并
+    qword *page = frame_to_ptr(frame);
+    dword checksum = page_checksum(page);
+    if (checksum != frame->checksum) {
+        frame->checksum = checksum;
+        return;
+    }
+
+    KsmNode *stable = tree_search(&stable_tree, page, NULL, NULL);
+    if (stable != NULL) {
+        merge_page(address_space, pte, address, frame, stable);
+        return;
+    }
+
+    RBNode **link;
+    RBNode *parent;
+    KsmNode *unstable = tree_search(&unstable_tree, page, &link, &parent);
+    if (unstable == NULL) {
+        tree_insert(&unstable_tree, frame, link, parent);
+    }
+    else if (unstable->frame != frame) {
+        promote_page(address_space, pte, address, frame, unstable);
+    }
+}
+
+/**
+ * @brief 从扫描位置起扫描地址空间
+ *
+ * @param address_space 地址空间
+ * @param budget 剩余可扫描的页数
+ * @return 是否已扫描完该地址空间
+ */
+static bool scan_address_space(AddressSpace *address_space, int *budget) {
+    // 持有地址空间锁的路径可能正在等待 不能在此等待 本遍跳过
+    if (! spin_trylock(&address_space->lock)) {
+        return true;
+    }
+
+    qword address = ksm_cursor.address;
+    PML4E *pml4e;
+    qword base = address & ~(PML4E_SPAN - 1);
+
+    for ( ; (pml4e = next_user_pml4e(address_space, &base)) != NULL ; base += PML4E_SPAN) {
+        qword start = address > base ? address - base : 0;
+        qword k0 = (start >> 21) & (PDE_PER_TAB - 1);
+        qword l0 = (start >> 12) & (PTE_PER_TAB - 1);
+
+        PDPTE *pdpt = table_ptr(pml4e->ref_pdpt_entry.address);
+        for (qword j = start >> 30 ; j < PDPTE_PER_TAB ; j ++, k0 = 0, l0 = 0) {
+            if (! pdpt[j].ref_pde_entry.P || pdpt[j].ref_pde_entry.PS) {
+                continue;
+            }
+
+            PDE *pd = table_ptr(pdpt[j].ref_pde_entry.address);
+            for (qword k = k0 ; k < PDE_PER_TAB ; k ++, l0 = 0) {
+                PagingTableEntry *pde = &pd[k].ref_pt_entry;
+                // 共享的页表也映射在其他地址空间中 无法在此刷新它们的TLB
+                if (! pde->P || pde->PS || phys_to_frame(get_pagingtab_addr(*pde))->refcount != 1) {
+                    continue;
+                }
+
+                PTE *pt = table_ptr(pde->address);
+                for (qword l = l0 ; l < PTE_PER_TAB ; l ++) {
+                    if ((pt[l].ref_page_entry.address & PAGE_PRESENT) == 0) {
+                        continue;
+                    }
+
+                    qword page = base | (j << 30) | (k << 21) | (l << 12);
+                    if (*budget == 0) {
+                        ksm_cursor.address = page;
+                        spin_unlock(&address_space->lock);
+                        return false;
+                    }
+
+                    (*budget) --;
+                    scan_page(address_space, &pt[l], page);
+                }
+            }
+        }
+    }
+
+    spin_unlock(&address_space->lock);
+    return true;
+}
+
+/**
+ * @brief 结束一遍扫描
+ * 清空不稳定树 释放已不再被映射的共享页
+ *
+ */
+static void finish_pass(void) {
+    while (unstable_tree.root != NULL) {
+        KsmNode *node = rb_entry(unstable_tree.root, KsmNode, node);
+        rb_erase(&unstable_tree, &node->node, NULL);
+        kmem_cache_free(&ksm_node_cache, node);
+    }
+
+    qword sharing = 0;
+    RBNode *cursor = rb_first(&stable_tree);
+    while (cursor != NULL) {
+        RBNode *next = rb_next(cursor);
+        KsmNode *node = rb_entry(cursor, KsmNode, node);
+
+        // 只剩稳定树的引用
+        if (__atomic_load_n(&node->frame->refcount, __ATOMIC_SEQ_CST) == 1) {
+            rb_erase(&stable_tree, cursor, NULL);
+            __atomic_fetch_and(&node->frame->flags, ~FRAME_KSM, __ATOMIC_SEQ_CST);
+            frame_put(node->frame);
+            kmem_cache_free(&ksm_node_cache, node);
+            ksm_pages_shared --;
+        }
+        else {
+            sharing += node->frame->refcount - 2;
+        }
+
+        cursor = next;
+    }
+    ksm_pages_sharing = sharing;
+}
+
+/**
+ * @brief 扫描位置所在的地址空间
+ *
+ * @return 地址空间 没有用户地址空间时为NULL
+ */
+static AddressSpace *cursor_address_space(void) {
+    list_for_each(node, &address_space_list) {
+        if (list_entry(node, AddressSpace, list) == ksm_cursor.address_space) {
+            return ksm_cursor.address_space;
+        }
+    }
+
+    // 新的一遍 或地址空间已被销毁
+    ksm_cursor.address = USER_SPACE_START;
+    if (list_empty(&address_space_list)) {
+        return NULL;
+    }
+    return list_entry(address_space_list.next, AddressSpace, list);
+}
+
+/**
+ * @brief 扫描一轮
+ * 由空闲循环调用 内容在两次扫描间未变化的匿名页才参与合并
+ * 与已合并的页相同时改为映射该页 与本遍扫描过的页相同时将其转为共享页
+ * 共享页只读 写入时经写时复制分开
+ *
+ * @return 是否做了工作
+ */
+bool ksm_run(void) {
+    int rate = __atomic_load_n(&ksm_scan_rate, __ATOMIC_RELAXED);
+    if (! ksm_initialized || rate == 0 || ! spin_trylock(&ksm_lock)) {
+        return false;
+    }
+
+    int budget = rate;
+
+    spin_lock(&address_space_list_lock);
+
+    AddressSpace *address_space = cursor_address_space();
+    while (address_space != NULL && budget > 0) {
+        if (! scan_address_space(address_space, &budget)) {
+            break;
+        }
+
+        address_space = address_space->list.next != &address_space_list ?
+            list_entry(address_space->list.next, AddressSpace, list) : NULL;
+        ksm_cursor.address = USER_SPACE_START;
+    }
+    ksm_cursor.address_space = address_space;
+
+    spin_unlock(&address_space_list_lock);
+
+    if (address_space == NULL) {
+        finish_pass();
+    }
+
+    spin_unlock(&ksm_lock);
+    return budget != rate;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file ksm.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 相同匿名页合并
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** 默认每轮扫描的页数 */
+#define KSM_DEFAULT_SCAN_RATE (100)
+
+/** 被合并后的共享页数 */
+extern qword ksm_pages_shared;
+
+/** 映射到共享页的次数(不含第一次) 即节省的页数 */
+extern qword ksm_pages_sharing;
+
+/**
+ * @brief 初始化KSM
+ * 需在init_slab之后调用
+ *
+ */
+void init_ksm(void);
+
+/**
+ * @brief 设置扫描速度
+ *
+ * @param pages 每轮扫描的页数 为0时停止扫描
+ */
+void ksm_set_scan_rate(dword pages);
+
+/**
+ * @brief 扫描一轮
+ * 由空闲循环调用 内容在两次扫描间未变化的匿名页才参与合并
+ * 与已合并的页相同时改为映射该页 与本遍扫描过的页相同时将其转为共享页
+ * 共享页只读 写入时经写时复制分开
+ *
+ * @return 是否做了工作
+ */
+bool ksm_run(void);
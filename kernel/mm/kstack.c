@@ -0,0 +1,78 @@
+/**
+ * @file kstack.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内核栈分配
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/kstack.h>
+#include <mm/vmalloc.h>
+#include <cpu/cpu.h>
+#include <sync/spinlock.h>
+
+/**
+ * @brief 内核栈缓存
+ * 缓存中的栈保持映射 再次分配时无需修改页表
+ *
+ */
+typedef struct {
+    /** 缓存的栈 */
+    void *stacks[KSTACK_CACHE_NUM];
+    /** 栈数 */
+    int num;
+    /** 锁 */
+    Spinlock lock;
+} KStackCache;
+
+// 各CPU的内核栈缓存
+static KStackCache kstack_caches[MAX_CPU_NUM];
+
+/**
+ * @brief 分配内核栈
+ * 优先取本CPU缓存中已映射好的栈 栈底之下为未映射的保护页 溢出时立即缺页
+ *
+ * @return 栈的最低地址 失败时为NULL
+ */
+void *alloc_kernel_stack(void) {
+    KStackCache *cache = &kstack_caches[current_cpu_id()];
+
+    spin_lock(&cache->lock);
+    if (cache->num > 0) {
+        void *stack = cache->stacks[-- cache->num];
+        spin_unlock(&cache->lock);
+        return stack;
+    }
+    spin_unlock(&cache->lock);
+
+    // vmalloc区域之间总隔着未映射的保护页
+    return vmalloc(KERNEL_STACK_SIZE);
+}
+
+/**
+ * @brief 释放内核栈
+ * 本CPU缓存未满时保留映射放回缓存 否则交还vmalloc
+ *
+ * @param stack 栈的最低地址
+ */
+void free_kernel_stack(void *stack) {
+    if (stack == NULL) {
+        return;
+    }
+
+    KStackCache *cache = &kstack_caches[current_cpu_id()];
+
+    spin_lock(&cache->lock);
+    if (cache->num < KSTACK_CACHE_NUM) {
+        cache->stacks[cache->num ++] = stack;
+        spin_unlock(&cache->lock);
+        return;
+    }
+    spin_unlock(&cache->lock);
+
+    vfree(stack);
+}
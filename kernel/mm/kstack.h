@@ -0,0 +1,48 @@
+/**
+ * @file kstack.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内核栈分配
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <tay/paging.h>
+
+/** 内核栈大小(16KB) */
+#define KERNEL_STACK_SIZE (4 * PAGE_SIZE)
+
+/** 每个CPU缓存的内核栈数 */
+#define KSTACK_CACHE_NUM (4)
+
+/**
+ * @brief 分配内核栈
+ * 优先取本CPU缓存中已映射好的栈 栈底之下为未映射的保护页 溢出时立即缺页
+ *
+ * @return 栈的最低地址 失败时为NULL
+ */
+void *alloc_kernel_stack(void);
+
+/**
+ * @brief 释放内核栈
+ * 本CPU缓存未满时保留映射放回缓存 否则交还vmalloc
+ *
+ * @param stack 栈的最低地址
+ */
+void free_kernel_stack(void *stack);
+
+/**
+ * @brief 栈顶地址
+ *
+ * @param stack 栈的最低地址
+ * @return 栈顶(初始栈指针)
+ */
+static inline void *kernel_stack_top(void *stack) {
+    return (byte *)stack + KERNEL_STACK_SIZE;
+}
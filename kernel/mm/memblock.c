@@ -0,0 +1,269 @@
+/**
+ * @file memblock.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 启动早期的内存区域分配器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/memblock.h>
+#include <mm/buddy.h>
+#include <mm/direct_map.h>
+#include <basec/logger.h>
+#include <string.h>
+
+/** 内核映像结束地址 */
+extern byte __kernel_end[];
+
+/** 可用内存 */
+MemblockType memblock_memory;
+
+/** 已保留的内存 */
+MemblockType memblock_reserved;
+
+// 可分配地址的上界
+static qword memblock_limit = KERNEL_MAP_SIZE;
+// 是否已交给伙伴系统
+static bool memblock_retired = false;
+
+/**
+ * @brief 加入区域 与重叠或相邻的区域合并
+ *
+ * @param type 区域类型
+ * @param base 基址
+ * @param size 大小
+ */
+static void add_region(MemblockType *type, qword base, qword size) {
+    if (size == 0) {
+        return;
+    }
+
+    qword end = base + size;
+
+    // [first, last)为与新区域重叠或相邻的区域
+    int first = 0;
+    while (first < type->num && type->regions[first].base + type->regions[first].size < base) {
+        first ++;
+    }
+
+    int last = first;
+    while (last < type->num && type->regions[last].base <= end) {
+        MemblockRegion *region = &type->regions[last];
+        if (region->base < base) {
+            base = region->base;
+        }
+        if (region->base + region->size > end) {
+            end = region->base + region->size;
+        }
+        last ++;
+    }
+
+    if (first == last) {
+        if (type->num == MEMBLOCK_MAX_REGIONS) {
+            log_error("memblock区域数超过上限 [%p, %p)被忽略", base, end);
+            return;
+        }
+        memmove(&type->regions[first + 1], &type->regions[first], (type->num - first) * sizeof(MemblockRegion));
+        type->num ++;
+    }
+    else if (last - first > 1) {
+        memmove(&type->regions[first + 1], &type->regions[last], (type->num - last) * sizeof(MemblockRegion));
+        type->num -= last - first - 1;
+    }
+
+    type->regions[first].base = base;
+    type->regions[first].size = end - base;
+}
+
+/**
+ * @brief 查找与范围重叠的保留区域
+ *
+ * @param start 范围起始
+ * @param end 范围结束
+ * @return 区域 不存在时为NULL
+ */
+static MemblockRegion *find_reserved(qword start, qword end) {
+    for (int i = 0 ; i < memblock_reserved.num ; i ++) {
+        MemblockRegion *region = &memblock_reserved.regions[i];
+        if (region->base < end && region->base + region->size > start) {
+            return region;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 由启动信息中的内存布局表初始化
+ * 内核映像及其以下的内存均保留
+ *
+ * @param boot_info 启动信息
+ */
+void init_memblock(BootInfo *boot_info) {
+    memblock_memory.num = 0;
+    memblock_reserved.num = 0;
+
+    for (dword i = 0 ; i < boot_info->memory_entry_num ; i ++) {
+        BootMemoryEntry *entry = &boot_info->memory_map[i];
+        if (entry->type == BOOT_MEMORY_AVAILABLE) {
+            memblock_add(entry->base, entry->length);
+        }
+    }
+
+    // 内核映像及其以下(栈, 启动信息, BIOS数据等)
+    memblock_reserve(0, kernel_virt_to_phys(__kernel_end));
+
+    log_info("memblock: %d个内存区域, 上界%dMB", memblock_memory.num, (int)(memblock_end() >> 20));
+}
+
+/**
+ * @brief 加入可用内存
+ *
+ * @param base 基址
+ * @param size 大小
+ */
+void memblock_add(qword base, qword size) {
+    add_region(&memblock_memory, base, size);
+}
+
+/**
+ * @brief 保留内存
+ *
+ * @param base 基址
+ * @param size 大小
+ */
+void memblock_reserve(qword base, qword size) {
+    add_region(&memblock_reserved, base, size);
+}
+
+/**
+ * @brief 设置可分配地址的上界
+ * 直接映射建立之后才能分配KERNEL_MAP_SIZE以上的内存
+ *
+ * @param limit 上界
+ */
+void memblock_set_limit(qword limit) {
+    memblock_limit = limit;
+}
+
+/**
+ * @brief 在指定范围内分配清零的内存
+ * 自高地址向低地址查找 把低端内存留给有地址限制的设备
+ *
+ * @param size 大小
+ * @param align 对齐(2的幂)
+ * @param min 范围下界
+ * @param max 范围上界
+ * @return 物理地址 失败时为MEMBLOCK_ALLOC_FAILED
+ */
+qword memblock_alloc_range(qword size, qword align, qword min, qword max) {
+    if (memblock_retired) {
+        log_error("memblock已交给伙伴系统 不能再分配");
+        return MEMBLOCK_ALLOC_FAILED;
+    }
+
+    if (max > memblock_limit) {
+        max = memblock_limit;
+    }
+
+    for (int i = memblock_memory.num - 1 ; i >= 0 ; i --) {
+        MemblockRegion *region = &memblock_memory.regions[i];
+        qword start = region->base > min ? region->base : min;
+        qword end = region->base + region->size < max ? region->base + region->size : max;
+
+        // 候选位置与保留区域重叠时 移到该保留区域之下继续查找
+        while (end > start && end - start >= size) {
+            qword candidate = (end - size) & ~(align - 1);
+            if (candidate < start) {
+                break;
+            }
+
+            MemblockRegion *reserved = find_reserved(candidate, candidate + size);
+            if (reserved == NULL) {
+                memblock_reserve(candidate, size);
+                memset(direct_map_end != 0 ? phys_to_virt(candidate) : early_phys_to_virt(candidate), 0, size);
+                return candidate;
+            }
+            end = reserved->base;
+        }
+    }
+
+    return MEMBLOCK_ALLOC_FAILED;
+}
+
+/**
+ * @brief 分配清零的内存
+ *
+ * @param size 大小
+ * @param align 对齐(2的幂)
+ * @return 物理地址 失败时为MEMBLOCK_ALLOC_FAILED
+ */
+qword memblock_alloc(qword size, qword align) {
+    return memblock_alloc_range(size, align, 0, memblock_limit);
+}
+
+/**
+ * @brief 可用内存的上界
+ *
+ * @return 上界
+ */
+qword memblock_end(void) {
+    if (memblock_memory.num == 0) {
+        return 0;
+    }
+    MemblockRegion *last = &memblock_memory.regions[memblock_memory.num - 1];
+    return last->base + last->size;
+}
+
+/**
+ * @brief 将范围内完整的页交给伙伴系统
+ *
+ * @param start 范围起始
+ * @param end 范围结束
+ */
+static void free_range(qword start, qword end) {
+    qword start_pfn = (start + PAGE_SIZE - 1) / PAGE_SIZE;
+    qword end_pfn = end / PAGE_SIZE;
+    if (end_pfn > frame_num) {
+        end_pfn = frame_num;
+    }
+
+    for (qword pfn = start_pfn ; pfn < end_pfn ; pfn ++) {
+        free_frames(pfn_to_frame(pfn), 0);
+    }
+}
+
+/**
+ * @brief 将所有未保留的内存交给伙伴系统
+ * 此后memblock不再可用
+ *
+ */
+void memblock_free_all(void) {
+    for (int i = 0 ; i < memblock_memory.num ; i ++) {
+        MemblockRegion *region = &memblock_memory.regions[i];
+        qword cursor = region->base;
+        qword end = region->base + region->size;
+
+        // 保留区域按基址排序 依次跳过
+        for (int j = 0 ; j < memblock_reserved.num && cursor < end ; j ++) {
+            MemblockRegion *reserved = &memblock_reserved.regions[j];
+            if (reserved->base + reserved->size <= cursor) {
+                continue;
+            }
+            if (reserved->base >= end) {
+                break;
+            }
+            free_range(cursor, reserved->base);
+            cursor = reserved->base + reserved->size;
+        }
+
+        if (cursor < end) {
+            free_range(cursor, end);
+        }
+    }
+
+    memblock_retired = true;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file memblock.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 启动早期的内存区域分配器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <tay/boot.h>
+
+/** 每类区域的最大数量 */
+#define MEMBLOCK_MAX_REGIONS (128)
+
+/** 分配失败 */
+#define MEMBLOCK_ALLOC_FAILED (~0ull)
+
+/**
+ * @brief 内存区域
+ *
+ */
+typedef struct {
+    /** 基址 */
+    qword base;
+    /** 大小 */
+    qword size;
+} MemblockRegion;
+
+/**
+ * @brief 按基址排序且互不重叠的一组区域
+ *
+ */
+typedef struct {
+    /** 区域数 */
+    int num;
+    /** 区域 */
+    MemblockRegion regions[MEMBLOCK_MAX_REGIONS];
+} MemblockType;
+
+/** 可用内存 */
+extern MemblockType memblock_memory;
+
+/** 已保留的内存 */
+extern MemblockType memblock_reserved;
+
+/**
+ * @brief 直接映射建立之前访问物理内存的地址
+ * 经加载器为内核映像建立的映射访问 只能访问低KERNEL_MAP_SIZE
+ *
+ * @param phys 物理地址
+ * @return 访问地址
+ */
+static inline void *early_phys_to_virt(qword phys) {
+    return (void *)(phys + KERNEL_VIRT_BASE);
+}
+
+/**
+ * @brief 由启动信息中的内存布局表初始化
+ * 内核映像及其以下的内存均保留
+ *
+ * @param boot_info 启动信息
+ */
+void init_memblock(BootInfo *boot_info);
+
+/**
+ * @brief 加入可用内存
+ *
+ * @param base 基址
+ * @param size 大小
+ */
+void memblock_add(qword base, qword size);
+
+/**
+ * @brief 保留内存
+ *
+ * @param base 基址
+ * @param size 大小
+ */
+void memblock_reserve(qword base, qword size);
+
+/**
+ * @brief 设置可分配地址的上界
+ * 直接映射建立之后才能分配KERNEL_MAP_SIZE以上的内存
+ *
+ * @param limit 上界
+ */
+void memblock_set_limit(qword limit);
+
+/**
+ * @brief 在指定范围内分配清零的内存
+ * 自高地址向低地址查找 把低端内存留给有地址限制的设备
+ *
+ * @param size 大小
+ * @param align 对齐(2的幂)
+ * @param min 范围下界
+ * @param max 范围上界
+ * @return 物理地址 失败时为MEMBLOCK_ALLOC_FAILED
+ */
+qword memblock_alloc_range(qword size, qword align, qword min, qword max);
+
+/**
+ * @brief 分配清零的内存
+ *
+ * @param size 大小
+ * @param align 对齐(2的幂)
+ * @return 物理地址 失败时为MEMBLOCK_ALLOC_FAILED
+ */
+qword memblock_alloc(qword size, qword align);
+
+/**
+ * @brief 可用内存的上界
+ *
+ * @return 上界
+ */
+qword memblock_end(void);
+
+/**
+ * @brief 将所有未保留的内存交给伙伴系统
+ * 此后memblock不再可用
+ *
+ */
+void memblock_free_all(void);
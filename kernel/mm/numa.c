@@ -0,0 +1,294 @@
+/**
+ * @file numa.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief NUMA拓扑
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/numa.h>
+#include <acpi/acpi.h>
+#include <cpu/cpu.h>
+#include <basec/logger.h>
+#include <stddef.h>
+
+/**
+ * @brief 内存区间
+ *
+ */
+typedef struct {
+    /** 起始物理地址 */
+    qword start;
+    /** 结束物理地址 */
+    qword end;
+    /** 节点号 */
+    int node;
+} NUMAMemblk;
+
+/**
+ * @brief CPU亲和
+ *
+ */
+typedef struct {
+    /** APIC ID */
+    dword apic_id;
+    /** 节点号 */
+    int node;
+} NUMACPUAffinity;
+
+/** 节点数 */
+int numa_node_num = 1;
+
+/** 各节点的后备顺序 */
+int numa_fallback[MAX_NUMA_NODES][MAX_NUMA_NODES];
+
+// 各节点对应的邻近域
+static dword node_proximity[MAX_NUMA_NODES];
+// 内存区间
+static NUMAMemblk memblks[MAX_NUMA_MEMBLKS];
+static int memblk_num = 0;
+// CPU亲和
+static NUMACPUAffinity cpu_affinities[MAX_CPU_NUM];
+static int cpu_affinity_num = 0;
+// 各CPU的节点号缓存 -1表示尚未查找
+static int cpu_nodes[MAX_CPU_NUM];
+// SLIT
+static ACPISLIT *slit = NULL;
+
+/**
+ * @brief 邻近域对应的节点 不存在时分配新节点
+ *
+ * @param proximity 邻近域
+ * @return 节点号 节点数超限时为0
+ */
+static int proximity_to_node(dword proximity) {
+    for (int node = 0 ; node < numa_node_num ; node ++) {
+        if (node_proximity[node] == proximity) {
+            return node;
+        }
+    }
+
+    if (numa_node_num >= MAX_NUMA_NODES) {
+        log_warn("邻近域%d超出节点数上限, 归入0号节点", (int)proximity);
+        return 0;
+    }
+
+    node_proximity[numa_node_num] = proximity;
+    return numa_node_num ++;
+}
+
+/**
+ * @brief 登记CPU亲和
+ *
+ * @param apic_id APIC ID
+ * @param proximity 邻近域
+ */
+static void add_cpu_affinity(dword apic_id, dword proximity) {
+    if (cpu_affinity_num >= MAX_CPU_NUM) {
+        return;
+    }
+    cpu_affinities[cpu_affinity_num].apic_id = apic_id;
+    cpu_affinities[cpu_affinity_num].node = proximity_to_node(proximity);
+    cpu_affinity_num ++;
+}
+
+/**
+ * @brief 登记内存区间
+ *
+ * @param base 基址
+ * @param length 长度
+ * @param proximity 邻近域
+ */
+static void add_memblk(qword base, qword length, dword proximity) {
+    if (memblk_num >= MAX_NUMA_MEMBLKS) {
+        log_warn("SRAT内存区间过多, 多余部分归入0号节点");
+        return;
+    }
+    memblks[memblk_num].start = base;
+    memblks[memblk_num].end = base + length;
+    memblks[memblk_num].node = proximity_to_node(proximity);
+    memblk_num ++;
+}
+
+/**
+ * @brief 解析SRAT
+ *
+ * @param srat SRAT
+ */
+static void parse_srat(ACPISRAT *srat) {
+    byte *ptr = ((byte *)srat) + sizeof(ACPISRAT);
+    byte *end = ((byte *)srat) + srat->header.length;
+
+    while (ptr + sizeof(ACPISRATEntry) <= end) {
+        ACPISRATEntry *entry = (ACPISRATEntry *)ptr;
+        if (entry->length == 0) {
+            break;
+        }
+
+        switch (entry->type) {
+        case SRAT_PROCESSOR_AFFINITY: {
+            ACPISRATProcessor *processor = (ACPISRATProcessor *)entry;
+            if (processor->flags & SRAT_ENABLED) {
+                dword proximity = processor->proximity_low |
+                                  (processor->proximity_high[0] << 8) |
+                                  (processor->proximity_high[1] << 16) |
+                                  (processor->proximity_high[2] << 24);
+                add_cpu_affinity(processor->apic_id, proximity);
+            }
+            break;
+        }
+        case SRAT_MEMORY_AFFINITY: {
+            ACPISRATMemory *memory = (ACPISRATMemory *)entry;
+            if ((memory->flags & SRAT_ENABLED) && memory->length != 0) {
+                add_memblk(memory->base, memory->length, memory->proximity);
+            }
+            break;
+        }
+        case SRAT_X2APIC_AFFINITY: {
+            ACPISRATX2APIC *x2apic = (ACPISRATX2APIC *)entry;
+            if (x2apic->flags & SRAT_ENABLED) {
+                add_cpu_affinity(x2apic->x2apic_id, x2apic->proximity);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        ptr += entry->length;
+    }
+}
+
+/**
+ * @brief 节点间距离
+ *
+ * @param from 源节点
+ * @param to 目标节点
+ * @return 距离 本地为NUMA_LOCAL_DISTANCE
+ */
+int node_distance(int from, int to) {
+    if (slit != NULL) {
+        qword i = node_proximity[from];
+        qword j = node_proximity[to];
+        if (i < slit->locality_num && j < slit->locality_num) {
+            return slit->entries[i * slit->locality_num + j];
+        }
+    }
+    return from == to ? NUMA_LOCAL_DISTANCE : NUMA_REMOTE_DISTANCE;
+}
+
+/**
+ * @brief 按距离为各节点生成后备顺序
+ *
+ */
+static void build_fallback(void) {
+    for (int node = 0 ; node < numa_node_num ; node ++) {
+        int *order = numa_fallback[node];
+        for (int i = 0 ; i < numa_node_num ; i ++) {
+            order[i] = i;
+        }
+
+        // 插入排序 距离相同时按节点号 保证自身排在第一位
+        for (int i = 1 ; i < numa_node_num ; i ++) {
+            int candidate = order[i];
+            int distance = node_distance(node, candidate);
+            int j = i - 1;
+            while (j >= 0) {
+                int other = node_distance(node, order[j]);
+                bool before = distance < other || (distance == other && candidate == node);
+                if (! before) {
+                    break;
+                }
+                order[j + 1] = order[j];
+                j --;
+            }
+            order[j + 1] = candidate;
+        }
+    }
+}
+
+/**
+ * @brief 从SRAT/SLIT中解析NUMA拓扑
+ * 没有SRAT时所有CPU与内存都属于0号节点
+ *
+ */
+void init_numa(void) {
+    for (int cpu = 0 ; cpu < MAX_CPU_NUM ; cpu ++) {
+        cpu_nodes[cpu] = -1;
+    }
+
+    numa_node_num = 0;
+
+    ACPISRAT *srat = (ACPISRAT *)acpi_find_table("SRAT");
+    if (srat != NULL) {
+        parse_srat(srat);
+    }
+
+    if (numa_node_num == 0 || memblk_num == 0) {
+        // 没有可用的亲和信息 视为单节点
+        numa_node_num = 1;
+        node_proximity[0] = 0;
+        memblk_num = 0;
+        cpu_affinity_num = 0;
+    }
+    else {
+        slit = (ACPISLIT *)acpi_find_table("SLIT");
+    }
+
+    build_fallback();
+
+    log_info("NUMA: %d个节点, %d个内存区间, SLIT%s", numa_node_num, memblk_num, slit != NULL ? "可用" : "不可用");
+}
+
+/**
+ * @brief 物理地址所在的节点
+ *
+ * @param phys 物理地址
+ * @return 节点号
+ */
+int phys_to_node(qword phys) {
+    for (int i = 0 ; i < memblk_num ; i ++) {
+        if (phys >= memblks[i].start && phys < memblks[i].end) {
+            return memblks[i].node;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief CPU所在的节点
+ *
+ * @param cpu CPU号
+ * @return 节点号
+ */
+int cpu_to_node(int cpu) {
+    int node = cpu_nodes[cpu];
+    if (node >= 0) {
+        return node;
+    }
+
+    // SRAT中没有该CPU时归入0号节点
+    node = 0;
+    for (int i = 0 ; i < cpu_affinity_num ; i ++) {
+        if (cpu_affinities[i].apic_id == cpu_apic_ids[cpu]) {
+            node = cpu_affinities[i].node;
+            break;
+        }
+    }
+
+    cpu_nodes[cpu] = node;
+    return node;
+}
+
+/**
+ * @brief 当前CPU所在的节点
+ *
+ * @return 节点号
+ */
+int current_node(void) {
+    return cpu_to_node(current_cpu_id());
+}
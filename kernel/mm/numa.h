@@ -0,0 +1,74 @@
+/**
+ * @file numa.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief NUMA拓扑
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** 最大节点数 */
+#define MAX_NUMA_NODES  (8)
+/** 最大内存区间数 */
+#define MAX_NUMA_MEMBLKS (32)
+
+/** 本地距离(SLIT约定) */
+#define NUMA_LOCAL_DISTANCE  (10)
+/** 无SLIT时的远端距离 */
+#define NUMA_REMOTE_DISTANCE (20)
+
+/** 节点数 */
+extern int numa_node_num;
+
+/**
+ * @brief 各节点的后备顺序
+ * numa_fallback[node]按距离从近到远列出全部节点 第一个总是node本身
+ *
+ */
+extern int numa_fallback[MAX_NUMA_NODES][MAX_NUMA_NODES];
+
+/**
+ * @brief 从SRAT/SLIT中解析NUMA拓扑
+ * 没有SRAT时所有CPU与内存都属于0号节点
+ *
+ */
+void init_numa(void);
+
+/**
+ * @brief 物理地址所在的节点
+ *
+ * @param phys 物理地址
+ * @return 节点号
+ */
+int phys_to_node(qword phys);
+
+/**
+ * @brief CPU所在的节点
+ *
+ * @param cpu CPU号
+ * @return 节点号
+ */
+int cpu_to_node(int cpu);
+
+/**
+ * @brief 当前CPU所在的节点
+ *
+ * @return 节点号
+ */
+int current_node(void);
+
+/**
+ * @brief 节点间距离
+ *
+ * @param from 源节点
+ * @param to 目标节点
+ * @return 距离 本地为NUMA_LOCAL_DISTANCE
+ */
+int node_distance(int from, int to);
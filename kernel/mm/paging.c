@@ -0,0 +1,486 @@
+/**
+ * @file paging.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 页表管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/paging.h>
+#include <mm/buddy.h>
+#include <mm/vma.h>
+#include <mm/swap.h>
+#include <tay/cr.h>
+#include <basec/logger.h>
+#include <string.h>
+
+// 内核映像的起止地址 由链接脚本定义
+extern byte __kernel_start[];
+extern byte __kernel_end[];
+
+// 复制共享页表时持有 防止两个地址空间同时修改同一张共享页表
+static Spinlock share_lock = SPINLOCK_INIT;
+
+/**
+ * @brief 新建页表
+ *
+ * @param user 是否为用户空间页表
+ * @return 指向新页表的表项 失败时为0
+ */
+static qword new_table(bool user) {
+    PageFrame *frame = alloc_zeroed_frame(0);
+    if (frame == NULL) {
+        return 0;
+    }
+    frame->flags |= FRAME_PAGETABLE;
+    return frame_to_phys(frame) | PAGE_PRESENT | PAGE_WRITE | (user ? PAGE_USER : 0);
+}
+
+/**
+ * @brief 获取下一级页表
+ *
+ * @param entry 表项
+ * @param user 是否为用户空间
+ * @param create 不存在时是否新建
+ * @return 下一级页表 不存在时为NULL
+ */
+static void *next_table(PagingTableEntry *entry, bool user, bool create) {
+    if (! entry->P) {
+        if (! create) {
+            return NULL;
+        }
+        qword table = new_table(user);
+        if (table == 0) {
+            return NULL;
+        }
+        entry->address = table;
+    }
+    return table_ptr(entry->address);
+}
+
+/**
+ * @brief 释放对页表的引用
+ * 最后一个引用释放时同时释放其映射的页框
+ *
+ * @param table 页表页框
+ */
+void put_page_table(PageFrame *table) {
+    if (__atomic_sub_fetch(&table->refcount, 1, __ATOMIC_SEQ_CST) != 0) {
+        return;
+    }
+
+    PTE *pt = frame_to_ptr(table);
+    for (int i = 0 ; i < PTE_PER_TAB ; i ++) {
+        if (pt[i].ref_page_entry.P) {
+            frame_put(phys_to_frame(get_4k_page_addr(pt[i].ref_page_entry)));
+        }
+        else if (is_swap_entry(pt[i].ref_page_entry.address)) {
+            swap_free(pt[i].ref_page_entry.address);
+        }
+    }
+
+    table->flags &= ~FRAME_PAGETABLE;
+    free_frames(table, 0);
+}
+
+/**
+ * @brief 使PDE指向的页表为本地址空间独占
+ * fork后父子地址空间共享最后一级页表 并通过清除PDE.RW写保护整张页表
+ * 首次修改时才复制页表 复制时两份页表中的可写页都被改为写时复制
+ *
+ * @param pde PDE
+ * @return 是否成功
+ */
+static bool unshare_table(PDE *pde) {
+    PagingTableEntry *entry = &pde->ref_pt_entry;
+
+    // 大页与未共享的页表
+    if (! entry->P || entry->PS || entry->RW) {
+        return true;
+    }
+
+    spin_lock(&share_lock);
+
+    PageFrame *table = phys_to_frame(get_pagingtab_addr(*entry));
+
+    // 其他地址空间都已经复制走了
+    if (__atomic_load_n(&table->refcount, __ATOMIC_SEQ_CST) == 1) {
+        entry->RW = true;
+        spin_unlock(&share_lock);
+        return true;
+    }
+
+    PageFrame *copy = alloc_frame();
+    if (copy == NULL) {
+        spin_unlock(&share_lock);
+        return false;
+    }
+    copy->flags |= FRAME_PAGETABLE;
+
+    PTE *old_pt = frame_to_ptr(table);
+    PTE *new_pt = frame_to_ptr(copy);
+
+    for (int i = 0 ; i < PTE_PER_TAB ; i ++) {
+        qword pte = old_pt[i].ref_page_entry.address;
+        if (pte & PAGE_PRESENT) {
+            if (pte & PAGE_WRITE) {
+                pte = (pte & ~PAGE_WRITE) | PAGE_COW_BIT;
+                old_pt[i].ref_page_entry.address = pte;
+            }
+            // 新页表持有一份引用
+            frame_get(phys_to_frame(pte & PAGE_ENTRY_4K_MASK));
+        }
+        else if (is_swap_entry(pte)) {
+            swap_dup(pte);
+        }
+        new_pt[i].ref_page_entry.address = pte;
+    }
+
+    entry->address = frame_to_phys(copy) | (entry->address & ~PAGING_TABLE_ENTRY_MASK) | PAGE_WRITE;
+
+    spin_unlock(&share_lock);
+
+    put_page_table(table);
+    return true;
+}
+
+/**
+ * @brief 获取地址对应的PML4项
+ * 5级分页时经过PML5 4级分页时即为顶级页表项
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @param flags 遍历标志
+ * @return PML4项 不存在时为NULL
+ */
+PML4E *walk_pml4e(AddressSpace *address_space, qword address, dword flags) {
+    if (paging_levels == 4) {
+        PML4E *pml4 = table_ptr(address_space->root);
+        return &pml4[PML4_INDEX(address)];
+    }
+
+    PML5E *pml5 = table_ptr(address_space->root);
+    PML4E *pml4 = next_table(&pml5[PML5_INDEX(address)].ref_pml4e_entry, address < USER_SPACE_END, (flags & WALK_CREATE) != 0);
+    if (pml4 == NULL) {
+        return NULL;
+    }
+    return &pml4[PML4_INDEX(address)];
+}
+
+/**
+ * @brief 查找下一个存在的用户空间PML4项
+ * 用于遍历用户空间 对4级与5级分页通用
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 开始查找的地址(PML4项对齐) 返回时为找到的项对应的地址
+ * @return PML4项 已到用户空间末尾时为NULL
+ */
+PML4E *next_user_pml4e(AddressSpace *address_space, qword *address) {
+    while (*address < USER_SPACE_END) {
+        PML4E *entry = walk_pml4e(address_space, *address, 0);
+        if (entry == NULL) {
+            // 整个PML5项都不存在
+            *address = (*address + PML5E_SPAN) & ~(PML5E_SPAN - 1);
+            continue;
+        }
+        if (entry->ref_pdpt_entry.P) {
+            return entry;
+        }
+        *address += PML4E_SPAN;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 获取地址对应的PDE
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @param flags 遍历标志
+ * @return PDE 不存在时为NULL
+ */
+PDE *walk_pde(AddressSpace *address_space, qword address, dword flags) {
+    bool user = address < USER_SPACE_END;
+    bool create = (flags & WALK_CREATE) != 0;
+
+    PML4E *pml4e = walk_pml4e(address_space, address, flags);
+    if (pml4e == NULL) {
+        return NULL;
+    }
+
+    PDPTE *pdpt = next_table(&pml4e->ref_pdpt_entry, user, create);
+    if (pdpt == NULL) {
+        return NULL;
+    }
+
+    PagingTableEntry *pdpte = &pdpt[PDPT_INDEX(address)].ref_pde_entry;
+    if (pdpte->P && pdpte->PS) {
+        return NULL;
+    }
+
+    PDE *pd = next_table(pdpte, user, create);
+    if (pd == NULL) {
+        return NULL;
+    }
+
+    return &pd[PD_INDEX(address)];
+}
+
+/**
+ * @brief 获取地址对应的PTE
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @param flags 遍历标志
+ * @return PTE 不存在或该地址由大页映射时为NULL
+ */
+PTE *walk_pte(AddressSpace *address_space, qword address, dword flags) {
+    PDE *pde = walk_pde(address_space, address, flags);
+    if (pde == NULL) {
+        return NULL;
+    }
+
+    if (pde->ref_pt_entry.P && pde->ref_pt_entry.PS) {
+        return NULL;
+    }
+
+    if ((flags & WALK_WRITE) && ! unshare_table(pde)) {
+        return NULL;
+    }
+
+    PTE *pt = next_table(&pde->ref_pt_entry, address < USER_SPACE_END, (flags & WALK_CREATE) != 0);
+    if (pt == NULL) {
+        return NULL;
+    }
+
+    return &pt[PT_INDEX(address)];
+}
+
+/**
+ * @brief 映射一页
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 虚拟地址
+ * @param phys 物理地址
+ * @param flags 页表项标志
+ * @return 是否成功
+ */
+bool map_page(AddressSpace *address_space, qword address, qword phys, qword flags) {
+    PTE *pte = walk_pte(address_space, address, WALK_CREATE | WALK_WRITE);
+    if (pte == NULL) {
+        return false;
+    }
+
+    pte->ref_page_entry.address = (phys & PAGE_ENTRY_4K_MASK) | flags | PAGE_PRESENT;
+    return true;
+}
+
+/**
+ * @brief 解除一页的映射
+ * 返回的页框需要在批次刷新后再释放
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 虚拟地址
+ * @param batch TLB刷新批次
+ * @return 原先映射的页框 未映射时为NULL
+ */
+PageFrame *unmap_page(AddressSpace *address_space, qword address, TLBBatch *batch) {
+    PTE *pte = walk_pte(address_space, address, WALK_WRITE);
+    if (pte == NULL || ! pte->ref_page_entry.P) {
+        return NULL;
+    }
+
+    PageFrame *frame = phys_to_frame(get_4k_page_addr(pte->ref_page_entry));
+    pte->ref_page_entry.address = 0;
+    tlb_batch_add(batch, address);
+
+    return frame;
+}
+
+/**
+ * @brief 将映射地址的叶子项设为全局页
+ *
+ * @param address 地址
+ * @return 该叶子项之后的下一个地址
+ */
+static qword set_global(qword address) {
+    qword next = (address | (PAGE_SIZE - 1)) + 1;
+
+    PML4E *pml4e = walk_pml4e(&kernel_address_space, address, 0);
+    if (pml4e == NULL || ! pml4e->ref_pdpt_entry.P) {
+        return next;
+    }
+
+    PDPTE *pdpte = &((PDPTE *)table_ptr(pml4e->ref_pdpt_entry.address))[PDPT_INDEX(address)];
+    if (! pdpte->ref_pde_entry.P) {
+        return next;
+    }
+    if (pdpte->ref_pde_entry.PS) {
+        pdpte->ref_page_entry.address |= PAGE_GLOBAL;
+        return (address | (PAGE_1G_SIZE - 1)) + 1;
+    }
+
+    PDE *pde = &((PDE *)table_ptr(pdpte->ref_pde_entry.address))[PD_INDEX(address)];
+    if (! pde->ref_pt_entry.P) {
+        return next;
+    }
+    if (pde->ref_pt_entry.PS) {
+        pde->ref_page_entry.address |= PAGE_GLOBAL;
+        return (address | (PAGE_2M_SIZE - 1)) + 1;
+    }
+
+    PTE *pte = &((PTE *)table_ptr(pde->ref_pt_entry.address))[PT_INDEX(address)];
+    if (pte->ref_page_entry.P) {
+        pte->ref_page_entry.address |= PAGE_GLOBAL;
+    }
+    return next;
+}
+
+/**
+ * @brief 初始化内核空间
+ * 预先分配内核部分的全部次级页表 此后内核的顶级页表项不再变化
+ * 新地址空间复制顶级页表项即共享全部内核页表 无需同步
+ * 内核映像设为全局页 切换地址空间时其TLB项得以保留
+ *
+ */
+void init_kernel_space(void) {
+    PagingTableEntry *root = table_ptr(kernel_address_space.root);
+    for (int i = top_index(USER_SPACE_END - 1) + 1 ; i < PML4E_PER_TAB ; i ++) {
+        if (root[i].P) {
+            continue;
+        }
+        qword table = new_table(false);
+        if (table == 0) {
+            log_error("无法分配内核页表");
+            return;
+        }
+        root[i].address = table;
+    }
+
+    if (! rdcr4().PGE) {
+        return;
+    }
+
+    qword address = (qword)__kernel_start;
+    while (address < (qword)__kernel_end) {
+        address = set_global(address);
+    }
+}
+
+/**
+ * @brief 新建地址空间
+ * 共享内核地址空间的内核部分
+ *
+ * @param address_space 地址空间
+ * @return 是否成功
+ */
+bool create_address_space(AddressSpace *address_space) {
+    qword root_entry = new_table(false);
+    if (root_entry == 0) {
+        return false;
+    }
+
+    address_space->root = root_entry & PAGING_TABLE_ENTRY_MASK;
+    address_space->pcid_context = 0;
+    address_space->cpumask = 0;
+    address_space->tlb_generation = 0;
+    list_init(&address_space->vmas);
+    address_space->color_first = 0;
+    address_space->color_num = 0;
+    address_space->color_next = 0;
+    address_space->scanners = 0;
+    address_space->reclaim_cursor = USER_SPACE_START;
+    address_space->lock = (Spinlock)SPINLOCK_INIT;
+
+    // 用户部分以外的顶级页表项指向内核的页表
+    PagingTableEntry *root = table_ptr(address_space->root);
+    PagingTableEntry *kernel_root = table_ptr(kernel_address_space.root);
+    for (int i = 0 ; i < PML4E_PER_TAB ; i ++) {
+        if (i < top_index(USER_SPACE_START) || i > top_index(USER_SPACE_END - 1)) {
+            root[i] = kernel_root[i];
+        }
+    }
+
+    // 5级分页时第0个PML5项下既有内核恒等映射又有用户空间 需要独立的PML4
+    if (paging_levels == 5) {
+        PML4E *low = walk_pml4e(address_space, 0, WALK_CREATE);
+        PML4E *kernel_low = walk_pml4e(&kernel_address_space, 0, 0);
+        if (low == NULL) {
+            free_frames(phys_to_frame(address_space->root), 0);
+            return false;
+        }
+        for (int i = 0 ; kernel_low != NULL && i < PML4_INDEX(USER_SPACE_START) ; i ++) {
+            low[i] = kernel_low[i];
+        }
+    }
+
+    register_address_space(address_space);
+
+    return true;
+}
+
+/**
+ * @brief 销毁地址空间
+ * 释放用户部分的所有页表, 页框与区域
+ *
+ * @param address_space 地址空间
+ */
+void destroy_address_space(AddressSpace *address_space) {
+    unregister_address_space(address_space);
+
+    // 惰性TLB模式下的CPU可能仍在引用这些页表
+    tlb_flush_range(address_space, USER_SPACE_START, TLB_FLUSH_ALL, true);
+
+    PML4E *pml4e;
+    for_each_user_pml4e(pml4e, address, address_space) {
+        PDPTE *pdpt = table_ptr(pml4e->ref_pdpt_entry.address);
+        for (int j = 0 ; j < PDPTE_PER_TAB ; j ++) {
+            if (! pdpt[j].ref_pde_entry.P) {
+                continue;
+            }
+
+            PDE *pd = table_ptr(pdpt[j].ref_pde_entry.address);
+            for (int k = 0 ; k < PDE_PER_TAB ; k ++) {
+                if (! pd[k].ref_pt_entry.P) {
+                    continue;
+                }
+
+                if (pd[k].ref_pt_entry.PS) {
+                    frame_put(phys_to_frame(get_2m_page_addr(pd[k].ref_page_entry)));
+                }
+                else {
+                    put_page_table(phys_to_frame(get_pagingtab_addr(pd[k].ref_pt_entry)));
+                }
+            }
+
+            free_frames(ptr_to_frame(pd), 0);
+        }
+
+        free_frames(ptr_to_frame(pdpt), 0);
+    }
+
+    // 5级分页时用户部分的PML4也属于本地址空间
+    if (paging_levels == 5) {
+        PML5E *pml5 = table_ptr(address_space->root);
+        for (int i = PML5_INDEX(USER_SPACE_START) ; i <= PML5_INDEX(USER_SPACE_END - 1) ; i ++) {
+            if (pml5[i].ref_pml4e_entry.P) {
+                free_frames(phys_to_frame(get_pagingtab_addr(pml5[i].ref_pml4e_entry)), 0);
+            }
+        }
+    }
+
+    free_frames(phys_to_frame(address_space->root), 0);
+    address_space->root = 0;
+
+    destroy_vmas(address_space);
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * @file paging.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 页表管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/vmm.h>
+#include <mm/frame.h>
+#include <mm/tlb.h>
+#include <tay/paging.h>
+
+/**
+ * @brief 页表遍历标志
+ *
+ */
+enum WalkFlags {
+    /** 缺少的页表自动分配 */
+    WALK_CREATE = 1 << 0,
+    /**
+     * @brief 将修改页表项
+     * 与其他地址空间共享的页表会先被复制
+     *
+     */
+    WALK_WRITE  = 1 << 1
+};
+
+/**
+ * @brief 页表项中的表地址在内核中的访问地址
+ *
+ * @param entry 页表项
+ * @return 访问地址
+ */
+static inline void *table_ptr(qword entry) {
+    return phys_to_virt(entry & PAGING_TABLE_ENTRY_MASK);
+}
+
+/**
+ * @brief 地址在顶级页表中的索引
+ *
+ * @param address 地址
+ * @return 索引
+ */
+static inline int top_index(qword address) {
+    return paging_levels == 5 ? PML5_INDEX(address) : PML4_INDEX(address);
+}
+
+/**
+ * @brief 获取地址对应的PML4项
+ * 5级分页时经过PML5 4级分页时即为顶级页表项
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @param flags 遍历标志
+ * @return PML4项 不存在时为NULL
+ */
+PML4E *walk_pml4e(AddressSpace *address_space, qword address, dword flags);
+
+/**
+ * @brief 查找下一个存在的用户空间PML4项
+ * 用于遍历用户空间 对4级与5级分页通用
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 开始查找的地址(PML4项对齐) 返回时为找到的项对应的地址
+ * @return PML4项 已到用户空间末尾时为NULL
+ */
+PML4E *next_user_pml4e(AddressSpace *address_space, qword *address);
+
+/**
+ * @brief 遍历用户空间中存在的PML4项
+ *
+ */
+#define for_each_user_pml4e(entry, address, address_space) \
+    for (qword address = USER_SPACE_START ; \
+         (entry = next_user_pml4e((address_space), &address)) != NULL ; \
+         address += PML4E_SPAN)
+
+/**
+ * @brief 获取地址对应的PDE
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @param flags 遍历标志
+ * @return PDE 不存在时为NULL
+ */
+PDE *walk_pde(AddressSpace *address_space, qword address, dword flags);
+
+/**
+ * @brief 获取地址对应的PTE
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @param flags 遍历标志
+ * @return PTE 不存在或该地址由大页映射时为NULL
+ */
+PTE *walk_pte(AddressSpace *address_space, qword address, dword flags);
+
+/**
+ * @brief 映射一页
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 虚拟地址
+ * @param phys 物理地址
+ * @param flags 页表项标志
+ * @return 是否成功
+ */
+bool map_page(AddressSpace *address_space, qword address, qword phys, qword flags);
+
+/**
+ * @brief 解除一页的映射
+ * 返回的页框需要在批次刷新后再释放
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 虚拟地址
+ * @param batch TLB刷新批次
+ * @return 原先映射的页框 未映射时为NULL
+ */
+PageFrame *unmap_page(AddressSpace *address_space, qword address, TLBBatch *batch);
+
+/**
+ * @brief 释放对页表的引用
+ * 最后一个引用释放时同时释放其映射的页框
+ *
+ * @param table 页表页框
+ */
+void put_page_table(PageFrame *table);
+
+/**
+ * @brief 初始化内核空间
+ * 预先分配内核部分的全部次级页表 此后内核的顶级页表项不再变化
+ * 新地址空间复制顶级页表项即共享全部内核页表 无需同步
+ * 内核映像设为全局页 切换地址空间时其TLB项得以保留
+ *
+ */
+void init_kernel_space(void);
+
+/**
+ * @brief 新建地址空间
+ * 共享内核地址空间的内核部分
+ *
+ * @param address_space 地址空间
+ * @return 是否成功
+ */
+bool create_address_space(AddressSpace *address_space);
+
+/**
+ * @brief 销毁地址空间
+ * 释放用户部分的所有页表, 页框与区域
+ *
+ * @param address_space 地址空间
+ */
+void destroy_address_space(AddressSpace *address_space);
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+ * @file pat.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 页属性表与映射的缓存类型
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/pat.h>
+#include <tay/cr.h>
+#include <tay/cpuid.h>
+#include <tay/paging.h>
+#include <basec/logger.h>
+
+/** PAT项中的内存类型编码 */
+#define PAT_UC       (0x00)
+#define PAT_WC       (0x01)
+#define PAT_WT       (0x04)
+#define PAT_WP       (0x05)
+#define PAT_WB       (0x06)
+#define PAT_UC_MINUS (0x07)
+
+/** 第index项的内存类型 */
+#define PAT_ENTRY(index, type) ((qword)(type) << ((index) * 8))
+
+/*
+ * 页表项以PAT:PCD:PWT三位选择PAT中的一项
+ * 前4项中只把1号项(上电默认为WT)改为WC 只设PCD或PCD|PWT的映射含义不变
+ * 后4项补上WT与WP
+ */
+#define PAT_VALUE ( \
+    PAT_ENTRY(0, PAT_WB) | PAT_ENTRY(1, PAT_WC) | PAT_ENTRY(2, PAT_UC_MINUS) | PAT_ENTRY(3, PAT_UC) | \
+    PAT_ENTRY(4, PAT_WB) | PAT_ENTRY(5, PAT_WP) | PAT_ENTRY(6, PAT_UC_MINUS) | PAT_ENTRY(7, PAT_WT))
+
+// 是否支持PAT
+static bool pat_supported = false;
+
+// 启用PAT时各缓存类型的页表项标志
+static const qword pat_flags[CACHE_MODE_NUM] = {
+    [CACHE_WB]       = 0,
+    [CACHE_WC]       = PAGE_PWT,
+    [CACHE_UC_MINUS] = PAGE_PCD,
+    [CACHE_UC]       = PAGE_PCD | PAGE_PWT,
+    [CACHE_WT]       = PAGE_PAT | PAGE_PCD | PAGE_PWT,
+    [CACHE_WP]       = PAGE_PAT | PAGE_PWT,
+};
+
+// 不支持PAT时各缓存类型的页表项标志(上电默认的前4项)
+static const qword legacy_flags[CACHE_MODE_NUM] = {
+    [CACHE_WB]       = 0,
+    [CACHE_WC]       = PAGE_PCD,
+    [CACHE_UC_MINUS] = PAGE_PCD,
+    [CACHE_UC]       = PAGE_PCD | PAGE_PWT,
+    [CACHE_WT]       = PAGE_PWT,
+    [CACHE_WP]       = PAGE_PWT,
+};
+
+/**
+ * @brief 在当前CPU上加载页属性表
+ * 所有CPU的页属性表必须一致 其它CPU上线时调用
+ *
+ */
+void load_pat(void) {
+    if (! pat_supported) {
+        return;
+    }
+
+    // 写回并作废缓存 避免旧类型下缓存的行残留
+    asm volatile ("wbinvd" : : : "memory");
+    wrmsr(MSR_PAT_ADDR, PAT_VALUE);
+    asm volatile ("wbinvd" : : : "memory");
+
+    // TLB项中缓存了内存类型 需一并刷新
+    CR4 cr4 = rdcr4();
+    if (cr4.PGE) {
+        cr4.PGE = false;
+        wrcr4(cr4);
+        cr4.PGE = true;
+        wrcr4(cr4);
+    }
+    else {
+        wrcr3(rdcr3());
+    }
+}
+
+/**
+ * @brief 初始化页属性表
+ * 在0号CPU上检测PAT并加载 须在建立任何非写回映射之前调用
+ *
+ */
+void init_pat(void) {
+    pat_supported = (cpuid(0x01, 0).edx & CPUID_01_EDX_PAT) != 0;
+    if (! pat_supported) {
+        log_warn("PAT: 不支持 写合并映射退化为不缓存");
+        return;
+    }
+
+    load_pat();
+    log_info("PAT: 已启用写合并");
+}
+
+/**
+ * @brief 缓存类型对应的4K页表项标志
+ * 不支持PAT时写合并退化为UC-, 写透与写保护退化为写透
+ *
+ * @param mode 缓存类型
+ * @return PWT/PCD/PAT位
+ */
+qword cache_mode_flags(CacheMode mode) {
+    if (mode >= CACHE_MODE_NUM) {
+        mode = CACHE_UC;
+    }
+    return pat_supported ? pat_flags[mode] : legacy_flags[mode];
+}
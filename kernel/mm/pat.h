@@ -0,0 +1,59 @@
+/**
+ * @file pat.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 页属性表与映射的缓存类型
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/**
+ * @brief 映射的缓存类型
+ *
+ */
+typedef enum {
+    /** 写回 普通内存 */
+    CACHE_WB = 0,
+    /** 写合并 帧缓冲与设备环形缓冲 */
+    CACHE_WC,
+    /** 不缓存 可被MTRR的写合并覆盖 */
+    CACHE_UC_MINUS,
+    /** 强不缓存 设备寄存器 */
+    CACHE_UC,
+    /** 写透 */
+    CACHE_WT,
+    /** 写保护 */
+    CACHE_WP,
+    /** 缓存类型数 */
+    CACHE_MODE_NUM
+} CacheMode;
+
+/**
+ * @brief 初始化页属性表
+ * 在0号CPU上检测PAT并加载 须在建立任何非写回映射之前调用
+ *
+ */
+void init_pat(void);
+
+/**
+ * @brief 在当前CPU上加载页属性表
+ * 所有CPU的页属性表必须一致 其它CPU上线时调用
+ *
+ */
+void load_pat(void);
+
+/**
+ * @brief 缓存类型对应的4K页表项标志
+ * 不支持PAT时写合并退化为UC-, 写透与写保护退化为写透
+ *
+ * @param mode 缓存类型
+ * @return PWT/PCD/PAT位
+ */
+qword cache_mode_flags(CacheMode mode);
@@ -0,0 +1,195 @@
+/**
+ * @file pcid.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief PCID管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/pcid.h>
+#include <cpu/cpu.h>
+#include <sync/spinlock.h>
+#include <tay/cpuid.h>
+#include <tay/tlb.h>
+#include <basec/logger.h>
+#include <string.h>
+
+// 是否启用PCID
+static bool pcid_on = false;
+// 是否支持INVPCID
+static bool invpcid_on = false;
+
+// 当前世代(低PCID_BITS位恒为0)
+static qword pcid_generation = PCID_NUM;
+// 当前世代中已分配的PCID
+static qword pcid_map[PCID_NUM / 64];
+// 下一个尝试分配的PCID
+static word pcid_next = PCID_KERNEL + 1;
+// 进入新世代后 尚未刷新TLB的CPU
+static CPUMask pcid_flush_pending = 0;
+// PCID分配锁
+static Spinlock pcid_lock = SPINLOCK_INIT;
+
+/**
+ * @brief 刷新所有PCID的TLB项
+ *
+ */
+static void flush_all_pcid(void) {
+    if (invpcid_on) {
+        invpcid(INVPCID_ALL, 0, NULL);
+        return;
+    }
+
+    // 改变CR4.PGE会刷新所有PCID的全部TLB项
+    CR4 cr4 = rdcr4();
+    cr4.PGE = ! cr4.PGE;
+    wrcr4(cr4);
+    cr4.PGE = ! cr4.PGE;
+    wrcr4(cr4);
+}
+
+/**
+ * @brief 进入新世代
+ * 旧世代的PCID全部作废 可以重新分配
+ *
+ */
+static void new_generation(void) {
+    pcid_generation += PCID_NUM;
+
+    memset(pcid_map, 0, sizeof(pcid_map));
+    pcid_map[PCID_KERNEL / 64] |= 1ull << (PCID_KERNEL % 64);
+    pcid_next = PCID_KERNEL + 1;
+
+    // 旧PCID的TLB项仍然残留在各CPU上 使用新PCID前必须刷新
+    __atomic_store_n(&pcid_flush_pending, cpu_online_mask, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 在当前世代中分配PCID
+ *
+ * @return PCID
+ */
+static word alloc_pcid(void) {
+    while (true) {
+        for (word pcid = pcid_next ; pcid < PCID_NUM ; pcid ++) {
+            if ((pcid_map[pcid / 64] & (1ull << (pcid % 64))) == 0) {
+                pcid_map[pcid / 64] |= 1ull << (pcid % 64);
+                pcid_next = pcid + 1;
+                return pcid;
+            }
+        }
+
+        // 4095个PCID已用尽
+        new_generation();
+    }
+}
+
+/**
+ * @brief 初始化PCID
+ * 若CPU支持则启用CR4.PCIDE
+ *
+ */
+void init_pcid(void) {
+    if ((cpuid(0x01, 0).ecx & CPUID_01_ECX_PCID) == 0) {
+        log_info("CPU不支持PCID, 切换地址空间时将刷新TLB");
+        return;
+    }
+
+    if (cpuid_max_leaf() >= 0x07) {
+        invpcid_on = (cpuid(0x07, 0).ebx & CPUID_07_EBX_INVPCID) != 0;
+    }
+
+    // 启用PCIDE时CR3[11:0]必须为0 此时运行在PCID_KERNEL下
+    CR4 cr4 = rdcr4();
+    cr4.PCIDE = true;
+    wrcr4(cr4);
+
+    pcid_map[PCID_KERNEL / 64] |= 1ull << (PCID_KERNEL % 64);
+    pcid_on = true;
+
+    log_info("已启用PCID(INVPCID: %s)", invpcid_on ? "支持" : "不支持");
+}
+
+/**
+ * @brief 在当前CPU上启用CR4.PCIDE
+ * 其它CPU上线时调用 须运行在内核地址空间(PCID_KERNEL)下
+ *
+ */
+void load_pcid(void) {
+    if (! pcid_on) {
+        return;
+    }
+
+    CR4 cr4 = rdcr4();
+    cr4.PCIDE = true;
+    wrcr4(cr4);
+}
+
+/**
+ * @brief 是否启用了PCID
+ *
+ * @return 启用了PCID
+ */
+bool pcid_enabled(void) {
+    return pcid_on;
+}
+
+/**
+ * @brief 构造切换到地址空间所用的CR3
+ * 地址空间的PCID属于当前世代时沿用该PCID 并置NOFLUSH保留其TLB项
+ * 否则为其分配新的PCID 分配用尽时进入新世代并刷新全部TLB
+ *
+ * @param address_space 地址空间
+ * @return CR3
+ */
+CR3 pcid_build_cr3(AddressSpace *address_space) {
+    CR3 cr3 = {};
+    cr3.page_entry = address_space->root & CR3_PAGE_ENTRY_MASK;
+
+    if (! pcid_on) {
+        return cr3;
+    }
+
+    word pcid = PCID_KERNEL;
+
+    // 取PCID与补刷新须在同一次持锁内完成
+    // 否则其它CPU可能在两者之间进入新世代 本CPU清除了待刷新标志却加载旧世代的PCID
+    // 击落IPI中也会切换到内核地址空间 须关中断持锁
+    qword flags = spin_lock_irqsave(&pcid_lock);
+    if (address_space != &kernel_address_space) {
+        if ((address_space->pcid_context & ~(qword)PCID_MASK) != pcid_generation) {
+            // 新分配的PCID在本世代内未被使用过 不含残留TLB项
+            pcid = alloc_pcid();
+            address_space->pcid_context = pcid_generation | pcid;
+        }
+        pcid = address_space->pcid_context & PCID_MASK;
+    }
+
+    int cpu = current_cpu_id();
+    if (cpumask_test(__atomic_load_n(&pcid_flush_pending, __ATOMIC_SEQ_CST), cpu)) {
+        cpumask_clear(&pcid_flush_pending, cpu);
+        flush_all_pcid();
+    }
+    spin_unlock_irqrestore(&pcid_lock, flags);
+
+    cr3.PCID = pcid;
+    cr3.NOFLUSH = true;
+
+    return cr3;
+}
+
+/**
+ * @brief 作废地址空间的PCID
+ * 下次切换到该地址空间时会分配新的PCID 相当于刷新了它在所有CPU上的TLB项
+ *
+ * @param address_space 地址空间
+ */
+void pcid_invalidate(AddressSpace *address_space) {
+    if (address_space != &kernel_address_space) {
+        __atomic_store_n(&address_space->pcid_context, 0, __ATOMIC_SEQ_CST);
+    }
+}
\ No newline at end of file
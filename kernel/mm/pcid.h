@@ -0,0 +1,64 @@
+/**
+ * @file pcid.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief PCID管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/cr.h>
+#include <mm/vmm.h>
+
+/** PCID位数 */
+#define PCID_BITS (12)
+/** PCID数 */
+#define PCID_NUM  (1 << PCID_BITS)
+/** PCID上下文中的PCID掩码 */
+#define PCID_MASK (PCID_NUM - 1)
+/** 内核使用的PCID */
+#define PCID_KERNEL (0)
+
+/**
+ * @brief 初始化PCID
+ * 若CPU支持则启用CR4.PCIDE
+ *
+ */
+void init_pcid(void);
+
+/**
+ * @brief 在当前CPU上启用CR4.PCIDE
+ * 其它CPU上线时调用 须运行在内核地址空间(PCID_KERNEL)下
+ *
+ */
+void load_pcid(void);
+
+/**
+ * @brief 是否启用了PCID
+ *
+ * @return 启用了PCID
+ */
+bool pcid_enabled(void);
+
+/**
+ * @brief 构造切换到地址空间所用的CR3
+ * 地址空间的PCID属于当前世代时沿用该PCID 并置NOFLUSH保留其TLB项
+ * 否则为其分配新的PCID 分配用尽时进入新世代并刷新全部TLB
+ *
+ * @param address_space 地址空间
+ * @return CR3
+ */
+CR3 pcid_build_cr3(AddressSpace *address_space);
+
+/**
+ * @brief 作废地址空间的PCID
+ * 下次切换到该地址空间时会分配新的PCID 相当于刷新了它在所有CPU上的TLB项
+ *
+ * @param address_space 地址空间
+ */
+void pcid_invalidate(AddressSpace *address_space);
\ No newline at end of file
@@ -0,0 +1,487 @@
+/**
+ * @file reclaim.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 页回收
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/reclaim.h>
+#include <mm/paging.h>
+#include <mm/swap.h>
+#include <mm/tlb.h>
+#include <mm/vmm.h>
+#include <mm/color.h>
+#include <cpu/cpu.h>
+#include <sched/thread.h>
+#include <sched/sched.h>
+#include <basec/logger.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+/**
+ * @brief 一次换出
+ *
+ */
+typedef struct {
+    /** 映射该页的PTE */
+    PTE *pte;
+    /** 撤销映射前的表项 */
+    qword entry;
+    /** 页框 */
+    PageFrame *frame;
+} Eviction;
+
+/**
+ * @brief 一次回收的状态
+ *
+ */
+typedef struct {
+    /** 回收的内存区 */
+    Zone *zone;
+    /** 目标页数 */
+    qword target;
+    /** 已回收的页数 */
+    qword reclaimed;
+} ReclaimControl;
+
+// 各节点的kswapd是否被唤醒
+static bool kswapd_wakeup[MAX_NUMA_NODES];
+// 各节点的kswapd线程
+static Thread *kswapd_threads[MAX_NUMA_NODES];
+
+/**
+ * @brief 清除页框标志
+ *
+ * @param frame 页框
+ * @param flag 标志
+ * @return 清除前是否置位
+ */
+static inline bool test_and_clear_flag(PageFrame *frame, dword flag) {
+    return (__atomic_fetch_and(&frame->flags, ~flag, __ATOMIC_SEQ_CST) & flag) != 0;
+}
+
+/**
+ * @brief 将新映射的匿名页加入不活跃链表
+ *
+ * @param frame 页框
+ */
+void lru_add(PageFrame *frame) {
+    Zone *zone = &zones[frame->node];
+
+    spin_lock(&zone->lru_lock);
+    __atomic_fetch_and(&frame->flags, ~(FRAME_ACTIVE | FRAME_REFERENCED | FRAME_RECLAIM), __ATOMIC_SEQ_CST);
+    __atomic_fetch_or(&frame->flags, FRAME_LRU, __ATOMIC_SEQ_CST);
+    list_add(&zone->lru[LRU_INACTIVE], &frame->list);
+    zone->lru_num[LRU_INACTIVE] ++;
+    spin_unlock(&zone->lru_lock);
+}
+
+/**
+ * @brief 将页移出LRU链表
+ *
+ * @param frame 页框
+ */
+void lru_del(PageFrame *frame) {
+    Zone *zone = &zones[frame->node];
+
+    spin_lock(&zone->lru_lock);
+    if (frame->flags & FRAME_LRU) {
+        list_del(&frame->list);
+        zone->lru_num[(frame->flags & FRAME_ACTIVE) ? LRU_ACTIVE : LRU_INACTIVE] --;
+        __atomic_fetch_and(&frame->flags, ~(FRAME_LRU | FRAME_ACTIVE | FRAME_REFERENCED | FRAME_RECLAIM), __ATOMIC_SEQ_CST);
+    }
+    spin_unlock(&zone->lru_lock);
+}
+
+/**
+ * @brief 老化活跃链表
+ * 末尾上次扫描后未被访问的页降入不活跃链表 被访问过的再获得一次机会
+ *
+ * @param zone 内存区
+ */
+static void shrink_active(Zone *zone) {
+    ListNode *active = &zone->lru[LRU_ACTIVE];
+
+    spin_lock(&zone->lru_lock);
+    for (int i = 0 ; i < RECLAIM_BATCH && ! list_empty(active) ; i ++) {
+        PageFrame *frame = list_entry(active->prev, PageFrame, list);
+        list_del(&frame->list);
+
+        if (test_and_clear_flag(frame, FRAME_REFERENCED)) {
+            list_add(active, &frame->list);
+            continue;
+        }
+
+        __atomic_fetch_and(&frame->flags, ~FRAME_ACTIVE, __ATOMIC_SEQ_CST);
+        list_add(&zone->lru[LRU_INACTIVE], &frame->list);
+        zone->lru_num[LRU_ACTIVE] --;
+        zone->lru_num[LRU_INACTIVE] ++;
+    }
+    spin_unlock(&zone->lru_lock);
+}
+
+/**
+ * @brief 扫描不活跃链表
+ * 末尾被访问过的页升入活跃链表 其余选为回收对象
+ *
+ * @param zone 内存区
+ */
+static void shrink_inactive(Zone *zone) {
+    ListNode *inactive = &zone->lru[LRU_INACTIVE];
+
+    spin_lock(&zone->lru_lock);
+    for (int i = 0 ; i < RECLAIM_BATCH && ! list_empty(inactive) ; i ++) {
+        PageFrame *frame = list_entry(inactive->prev, PageFrame, list);
+        list_del(&frame->list);
+
+        if (test_and_clear_flag(frame, FRAME_REFERENCED)) {
+            __atomic_fetch_and(&frame->flags, ~FRAME_RECLAIM, __ATOMIC_SEQ_CST);
+            __atomic_fetch_or(&frame->flags, FRAME_ACTIVE, __ATOMIC_SEQ_CST);
+            list_add(&zone->lru[LRU_ACTIVE], &frame->list);
+            zone->lru_num[LRU_INACTIVE] --;
+            zone->lru_num[LRU_ACTIVE] ++;
+            continue;
+        }
+
+        __atomic_fetch_or(&frame->flags, FRAME_RECLAIM, __ATOMIC_SEQ_CST);
+        list_add(inactive, &frame->list);
+    }
+    spin_unlock(&zone->lru_lock);
+}
+
+/**
+ * @brief 完成一批换出
+ * 映射已在撤销时清空 刷新TLB后页的内容才不会再变化
+ * 换出失败的页恢复原映射
+ *
+ * @param batch TLB刷新批次
+ * @param evictions 换出
+ * @param count 换出数
+ * @param rc 回收状态
+ */
+static void finish_evictions(TLBBatch *batch, Eviction *evictions, int count, ReclaimControl *rc) {
+    if (count == 0) {
+        return;
+    }
+
+    tlb_batch_flush(batch);
+
+    for (int i = 0 ; i < count ; i ++) {
+        Eviction *eviction = &evictions[i];
+
+        qword entry = swap_out(eviction->frame);
+        if (entry == 0) {
+            eviction->pte->ref_page_entry.address = eviction->entry;
+            __atomic_fetch_and(&eviction->frame->flags, ~FRAME_RECLAIM, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        eviction->pte->ref_page_entry.address = entry;
+        frame_put(eviction->frame);
+        rc->reclaimed ++;
+    }
+}
+
+/**
+ * @brief 扫描地址空间的页表
+ * 相当于时钟算法的指针: 收集并清除访问位 换出被选为回收对象且之后未被访问的页
+ * 清除访问位后不刷新TLB 仍缓存着该项的CPU不会再置位访问位 页因此可能显得较冷
+ * 这只影响回收的准确性 而刷新的代价要大得多
+ * 每次至多扫描RECLAIM_SCAN_LIMIT个页表项 下次从停下的位置继续
+ *
+ * @param address_space 地址空间
+ * @param rc 回收状态
+ */
+static void scan_address_space(AddressSpace *address_space, ReclaimControl *rc) {
+    // 持有地址空间锁的路径可能正在等待回收 不能在此等待
+    if (! spin_trylock(&address_space->lock)) {
+        return;
+    }
+
+    Eviction evictions[EVICT_BATCH];
+    int count = 0;
+    int scanned = 0;
+    bool evict = swap_available();
+    qword cursor = address_space->reclaim_cursor;
+    // 扫描到用户空间末尾时下次从头开始
+    qword next_cursor = USER_SPACE_START;
+
+    TLBBatch batch;
+    tlb_batch_init(&batch, address_space);
+
+    PML4E *pml4e;
+    for (qword base = cursor & ~(PML4E_SPAN - 1) ; (pml4e = next_user_pml4e(address_space, &base)) != NULL ;
+        base += PML4E_SPAN) {
+        PDPTE *pdpt = table_ptr(pml4e->ref_pdpt_entry.address);
+        for (qword j = 0 ; j < PDPTE_PER_TAB ; j ++) {
+            if (! pdpt[j].ref_pde_entry.P || pdpt[j].ref_pde_entry.PS || base + ((j + 1) << 30) <= cursor) {
+                continue;
+            }
+
+            PDE *pd = table_ptr(pdpt[j].ref_pde_entry.address);
+            for (qword k = 0 ; k < PDE_PER_TAB ; k ++) {
+                PagingTableEntry *pde = &pd[k].ref_pt_entry;
+                if (! pde->P || pde->PS || (base | (j << 30)) + ((k + 1) << 21) <= cursor) {
+                    continue;
+                }
+
+                // 共享的页表也映射在其他地址空间中 无法在此刷新它们的TLB
+                bool shared = phys_to_frame(get_pagingtab_addr(*pde))->refcount != 1;
+
+                PTE *pt = table_ptr(pde->address);
+                for (qword l = 0 ; l < PTE_PER_TAB ; l ++) {
+                    qword address = base | (j << 30) | (k << 21) | (l << 12);
+                    if (address < cursor) {
+                        continue;
+                    }
+
+                    // 限制一次持有地址空间锁的时长
+                    if (scanned == RECLAIM_SCAN_LIMIT) {
+                        next_cursor = address;
+                        goto out;
+                    }
+
+                    qword entry = pt[l].ref_page_entry.address;
+                    if ((entry & PAGE_PRESENT) == 0) {
+                        continue;
+                    }
+                    scanned ++;
+
+                    PageFrame *frame = phys_to_frame(entry & PAGE_ENTRY_4K_MASK);
+                    if ((frame->flags & FRAME_LRU) == 0) {
+                        continue;
+                    }
+
+                    if (entry & PAGE_ACCESSED) {
+                        __atomic_fetch_and(&pt[l].ref_page_entry.address, ~PAGE_ACCESSED, __ATOMIC_SEQ_CST);
+                        __atomic_fetch_or(&frame->flags, FRAME_REFERENCED, __ATOMIC_SEQ_CST);
+                        __atomic_fetch_and(&frame->flags, ~FRAME_RECLAIM, __ATOMIC_SEQ_CST);
+                        continue;
+                    }
+
+                    if (! evict || shared || frame->node != rc->zone->node ||
+                        (frame->flags & FRAME_RECLAIM) == 0 || frame->refcount != 1 ||
+                        rc->reclaimed + count >= rc->target) {
+                        continue;
+                    }
+
+                    // 原子地撤销映射 取得最终的访问位与脏位
+                    entry = __atomic_exchange_n(&pt[l].ref_page_entry.address, 0, __ATOMIC_SEQ_CST);
+
+                    evictions[count].pte = &pt[l];
+                    evictions[count].entry = entry;
+                    evictions[count].frame = frame;
+                    count ++;
+
+                    tlb_batch_add(&batch, address);
+
+                    if (count == EVICT_BATCH) {
+                        finish_evictions(&batch, evictions, count, rc);
+                        count = 0;
+                    }
+                }
+            }
+        }
+    }
+
+out:
+    address_space->reclaim_cursor = next_cursor;
+    finish_evictions(&batch, evictions, count, rc);
+    spin_unlock(&address_space->lock);
+}
+
+/**
+ * @brief 回收内存区
+ * 先老化LRU链表选出回收对象 再扫描所有地址空间的页表将其换出
+ *
+ * @param zone 内存区
+ * @param target 目标页数
+ * @return 回收的页数
+ */
+static qword shrink_zone(Zone *zone, qword target) {
+    ReclaimControl rc = {
+        .zone = zone,
+        .target = target,
+        .reclaimed = 0
+    };
+
+    // 不活跃链表不少于活跃链表时才老化活跃页
+    if (zone->lru_num[LRU_INACTIVE] < zone->lru_num[LRU_ACTIVE]) {
+        shrink_active(zone);
+    }
+    shrink_inactive(zone);
+
+    // 扫描时不持有链表锁 以引用保证地址空间不被销毁
+    spin_lock(&address_space_list_lock);
+    AddressSpace *address_space = list_empty(&address_space_list) ? NULL :
+        list_entry(address_space_list.next, AddressSpace, list);
+    if (address_space != NULL) {
+        address_space_get(address_space);
+    }
+    spin_unlock(&address_space_list_lock);
+
+    while (address_space != NULL) {
+        scan_address_space(address_space, &rc);
+
+        spin_lock(&address_space_list_lock);
+        // 扫描期间被注销的地址空间已不在链表中(节点指向自身) 就此结束
+        AddressSpace *next = NULL;
+        if (rc.reclaimed < target && address_space->list.next != &address_space->list &&
+            address_space->list.next != &address_space_list) {
+            next = list_entry(address_space->list.next, AddressSpace, list);
+            address_space_get(next);
+        }
+        address_space_put(address_space);
+        spin_unlock(&address_space_list_lock);
+
+        address_space = next;
+    }
+
+    return rc.reclaimed;
+}
+
+/**
+ * @brief 进入回收
+ *
+ * @return 是否成功(已在回收中时为false)
+ */
+static bool reclaim_enter(void) {
+    Thread *current = current_thread();
+    if (current->flags & THREAD_RECLAIM) {
+        return false;
+    }
+    current->flags |= THREAD_RECLAIM;
+    return true;
+}
+
+/**
+ * @brief 退出回收
+ *
+ */
+static void reclaim_exit(void) {
+    current_thread()->flags &= ~THREAD_RECLAIM;
+}
+
+/**
+ * @brief 当前线程是否正在回收
+ * 回收路径中的分配可以动用保留内存 且不会再次进入回收
+ *
+ * @return 是否正在回收
+ */
+bool in_reclaim(void) {
+    return (current_thread()->flags & THREAD_RECLAIM) != 0;
+}
+
+/**
+ * @brief 唤醒节点的kswapd
+ * 分配后空闲页低于低水位时调用
+ *
+ * @param node 节点号
+ */
+void wakeup_kswapd(int node) {
+    // 已被唤醒 kswapd清除标志后才会回收 不会漏掉这次请求
+    if (__atomic_load_n(&kswapd_wakeup[node], __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    // 先置位再唤醒 与thread_wait中在运行队列的锁下检查标志相对应
+    __atomic_store_n(&kswapd_wakeup[node], true, __ATOMIC_SEQ_CST);
+    Thread *kswapd = __atomic_load_n(&kswapd_threads[node], __ATOMIC_SEQ_CST);
+    if (kswapd != NULL) {
+        wake_up_thread(kswapd);
+    }
+}
+
+/**
+ * @brief 同步回收
+ * 分配失败时的最后手段 依次回收各节点直到可以满足分配
+ *
+ * @param node 节点号
+ * @param order 阶数
+ * @return 回收的页数
+ */
+qword try_to_free_pages(int node, int order) {
+    if (! reclaim_enter()) {
+        return 0;
+    }
+
+    // 颜色缓存中暂存的空闲页无需换出即可归还
+    for (int i = 0 ; i < numa_node_num ; i ++) {
+        drain_color_cache(numa_fallback[node][i]);
+    }
+
+    qword target = (1ull << order) > RECLAIM_BATCH ? (1ull << order) : RECLAIM_BATCH;
+    qword reclaimed = 0;
+
+    for (int round = 0 ; round < DIRECT_RECLAIM_ROUNDS && reclaimed < target ; round ++) {
+        for (int i = 0 ; i < numa_node_num && reclaimed < target ; i ++) {
+            reclaimed += shrink_zone(&zones[numa_fallback[node][i]], target - reclaimed);
+        }
+    }
+
+    reclaim_exit();
+    return reclaimed;
+}
+
+/**
+ * @brief 把节点回收到高水位
+ *
+ * @param node 节点号
+ */
+static void kswapd_balance(int node) {
+    if (! reclaim_enter()) {
+        return;
+    }
+
+    Zone *zone = &zones[node];
+    qword reclaimed = 0;
+    for (int round = 0 ; round < KSWAPD_MAX_ROUNDS && zone->free_frame_num < zone->watermarks[WMARK_HIGH] ; round ++) {
+        reclaimed += shrink_zone(zone, zone->watermarks[WMARK_HIGH] - zone->free_frame_num);
+    }
+
+    reclaim_exit();
+
+    // 有进展但仍低于低水位 下一轮继续
+    if (reclaimed != 0 && zone->free_frame_num < zone->watermarks[WMARK_LOW]) {
+        wakeup_kswapd(node);
+    }
+}
+
+/**
+ * @brief kswapd的主循环
+ * 睡眠直到分配路径唤醒 之后把节点回收到高水位
+ *
+ * @param arg 节点号
+ */
+static void kswapd_main(void *arg) {
+    int node = (int)(qword)arg;
+    while (true) {
+        thread_wait(&kswapd_wakeup[node]);
+        __atomic_store_n(&kswapd_wakeup[node], false, __ATOMIC_SEQ_CST);
+        kswapd_balance(node);
+    }
+}
+
+/**
+ * @brief 为每个节点启动kswapd线程
+ * 需在调度器初始化之后调用 此前的唤醒请求在线程启动后处理
+ *
+ */
+void start_kswapd(void) {
+    for (int node = 0 ; node < numa_node_num ; node ++) {
+        char name[THREAD_NAME_LEN];
+        sprintf(name, "kswapd%d", node);
+
+        Thread *kswapd = create_kernel_thread(name, kswapd_main, (void *)(qword)node);
+        if (kswapd == NULL) {
+            log_error("无法创建节点%d的kswapd", node);
+            continue;
+        }
+        __atomic_store_n(&kswapd_threads[node], kswapd, __ATOMIC_SEQ_CST);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file reclaim.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 页回收
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/buddy.h>
+
+/** 每轮从各LRU链表末尾扫描的页数 */
+#define RECLAIM_BATCH (32)
+/** 一次换出前最多积累的页数(共用一次TLB刷新) */
+#define EVICT_BATCH (32)
+/** kswapd被唤醒后对每个节点最多回收的轮数 */
+#define KSWAPD_MAX_ROUNDS (16)
+/** 每次对一个地址空间最多扫描的页表项数 限制持有其锁的时长 */
+#define RECLAIM_SCAN_LIMIT (4096)
+/** 同步回收最多进行的轮数 */
+#define DIRECT_RECLAIM_ROUNDS (4)
+
+/**
+ * @brief 将新映射的匿名页加入不活跃链表
+ *
+ * @param frame 页框
+ */
+void lru_add(PageFrame *frame);
+
+/**
+ * @brief 将页移出LRU链表
+ *
+ * @param frame 页框
+ */
+void lru_del(PageFrame *frame);
+
+/**
+ * @brief 唤醒节点的kswapd
+ * 分配后空闲页低于低水位时调用
+ *
+ * @param node 节点号
+ */
+void wakeup_kswapd(int node);
+
+/**
+ * @brief 当前线程是否正在回收
+ * 回收路径中的分配可以动用保留内存 且不会再次进入回收
+ *
+ * @return 是否正在回收
+ */
+bool in_reclaim(void);
+
+/**
+ * @brief 同步回收
+ * 分配失败时的最后手段 依次回收各节点直到可以满足分配
+ *
+ * @param node 节点号
+ * @param order 阶数
+ * @return 回收的页数
+ */
+qword try_to_free_pages(int node, int order);
+
+/**
+ * @brief 为每个节点启动kswapd线程
+ * 需在调度器初始化之后调用 此前的唤醒请求在线程启动后处理
+ *
+ */
+void start_kswapd(void);
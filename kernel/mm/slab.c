@@ -0,0 +1,271 @@
+/**
+ * @file slab.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief slab对象分配器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/slab.h>
+#include <mm/buddy.h>
+#include <mm/reclaim.h>
+#include <string.h>
+
+/**
+ * @brief slab头
+ * 位于slab页框的起始处
+ *
+ */
+typedef struct {
+    /** 所在链表 */
+    ListNode list;
+    /** 所属对象缓存 */
+    KMemCache *cache;
+    /** 空闲对象链表 */
+    void *freelist;
+    /** 已分配对象数 */
+    dword inuse;
+} Slab;
+
+/** slab头所占大小 */
+#define SLAB_HEADER_SIZE ((sizeof(Slab) + 15) & ~15)
+
+/** kmalloc最小对象 */
+#define KMALLOC_MIN_SHIFT (4)
+/** kmalloc最大对象 */
+#define KMALLOC_MAX_SHIFT (11)
+
+// kmalloc对象缓存 16B ~ 2KB
+static KMemCache kmalloc_caches[KMALLOC_MAX_SHIFT - KMALLOC_MIN_SHIFT + 1];
+
+// kmalloc对象缓存名
+static const char *kmalloc_names[] = {
+    "kmalloc-16", "kmalloc-32", "kmalloc-64", "kmalloc-128",
+    "kmalloc-256", "kmalloc-512", "kmalloc-1024", "kmalloc-2048"
+};
+
+/**
+ * @brief 初始化对象缓存
+ *
+ * @param cache 对象缓存
+ * @param name 名称
+ * @param size 对象大小
+ */
+void kmem_cache_init(KMemCache *cache, const char *name, size_t size) {
+    // 对象中需要放下空闲链表指针
+    if (size < sizeof(void *)) {
+        size = sizeof(void *);
+    }
+    size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+    cache->name = name;
+    cache->size = size;
+    cache->objects_per_slab = (PAGE_SIZE - SLAB_HEADER_SIZE) / size;
+    for (int node = 0 ; node < MAX_NUMA_NODES ; node ++) {
+        list_init(&cache->nodes[node].partial);
+        list_init(&cache->nodes[node].full);
+        cache->nodes[node].lock = (Spinlock)SPINLOCK_INIT;
+    }
+}
+
+/**
+ * @brief 在节点上新建slab
+ * 调用者需持有该节点的锁
+ *
+ * @param cache 对象缓存
+ * @param node 节点号
+ * @return slab 失败时为NULL
+ */
+static Slab *new_slab(KMemCache *cache, int node) {
+    // 持有节点锁时不能同步回收 由kmem_cache_alloc_node在锁外回收
+    PageFrame *frame = alloc_frames_node(node, 0, ALLOC_THISNODE | ALLOC_NORECLAIM);
+    if (frame == NULL) {
+        return NULL;
+    }
+
+    frame->flags |= FRAME_SLAB;
+    frame->private = cache;
+
+    Slab *slab = (Slab *)frame_to_ptr(frame);
+    slab->cache = cache;
+    slab->inuse = 0;
+    slab->freelist = NULL;
+
+    // 串起所有对象
+    byte *objects = ((byte *)slab) + SLAB_HEADER_SIZE;
+    for (int i = cache->objects_per_slab - 1 ; i >= 0 ; i --) {
+        void **object = (void **)(objects + i * cache->size);
+        *object = slab->freelist;
+        slab->freelist = object;
+    }
+
+    list_add(&cache->nodes[node].partial, &slab->list);
+    return slab;
+}
+
+/**
+ * @brief 从节点上的slab分配对象
+ * 没有空闲对象时从该节点分配新的slab
+ *
+ * @param cache 对象缓存
+ * @param node 节点号
+ * @return 对象 该节点内存不足时为NULL
+ */
+static void *cache_alloc_node(KMemCache *cache, int node) {
+    KMemCacheNode *cache_node = &cache->nodes[node];
+    spin_lock(&cache_node->lock);
+
+    Slab *slab;
+    if (list_empty(&cache_node->partial)) {
+        slab = new_slab(cache, node);
+        if (slab == NULL) {
+            spin_unlock(&cache_node->lock);
+            return NULL;
+        }
+    }
+    else {
+        slab = list_entry(cache_node->partial.next, Slab, list);
+    }
+
+    void **object = (void **)slab->freelist;
+    slab->freelist = *object;
+    slab->inuse ++;
+
+    if (slab->freelist == NULL) {
+        list_del(&slab->list);
+        list_add(&cache_node->full, &slab->list);
+    }
+
+    spin_unlock(&cache_node->lock);
+    return object;
+}
+
+/**
+ * @brief 从对象缓存分配对象 优先使用指定节点上的内存
+ * 指定节点内存不足时按距离依次尝试其他节点
+ *
+ * @param cache 对象缓存
+ * @param node 节点号
+ * @return 对象 失败时为NULL
+ */
+void *kmem_cache_alloc_node(KMemCache *cache, int node) {
+    for (int i = 0 ; i < numa_node_num ; i ++) {
+        void *object = cache_alloc_node(cache, numa_fallback[node][i]);
+        if (object != NULL) {
+            return object;
+        }
+    }
+
+    // 所有节点都不足 同步回收后再试一次
+    if (try_to_free_pages(node, 0) == 0) {
+        return NULL;
+    }
+    return cache_alloc_node(cache, node);
+}
+
+/**
+ * @brief 释放对象
+ *
+ * @param cache 对象缓存
+ * @param object 对象
+ */
+void kmem_cache_free(KMemCache *cache, void *object) {
+    Slab *slab = (Slab *)((qword)object & ~(qword)(PAGE_SIZE - 1));
+    PageFrame *frame = ptr_to_frame(slab);
+    KMemCacheNode *cache_node = &cache->nodes[frame->node];
+
+    spin_lock(&cache_node->lock);
+
+    bool was_full = slab->freelist == NULL;
+
+    *(void **)object = slab->freelist;
+    slab->freelist = object;
+    slab->inuse --;
+
+    if (slab->inuse == 0) {
+        // 归还空slab
+        list_del(&slab->list);
+        frame->flags &= ~FRAME_SLAB;
+        frame->private = NULL;
+        frame_put(frame);
+    }
+    else if (was_full) {
+        list_del(&slab->list);
+        list_add(&cache_node->partial, &slab->list);
+    }
+
+    spin_unlock(&cache_node->lock);
+}
+
+/**
+ * @brief 初始化通用内存分配
+ *
+ */
+void init_slab(void) {
+    for (int shift = KMALLOC_MIN_SHIFT ; shift <= KMALLOC_MAX_SHIFT ; shift ++) {
+        kmem_cache_init(&kmalloc_caches[shift - KMALLOC_MIN_SHIFT], kmalloc_names[shift - KMALLOC_MIN_SHIFT], 1 << shift);
+    }
+}
+
+/**
+ * @brief 分配内存
+ * 大于一页一半的请求直接从伙伴系统分配
+ *
+ * @param size 大小
+ * @return 内存 失败时为NULL
+ */
+void *kmalloc(size_t size) {
+    for (int shift = KMALLOC_MIN_SHIFT ; shift <= KMALLOC_MAX_SHIFT ; shift ++) {
+        if (size <= (1ull << shift)) {
+            return kmem_cache_alloc(&kmalloc_caches[shift - KMALLOC_MIN_SHIFT]);
+        }
+    }
+
+    int order = 0;
+    while ((PAGE_SIZE << order) < size) {
+        order ++;
+    }
+
+    PageFrame *frame = alloc_frames(order);
+    if (frame == NULL) {
+        return NULL;
+    }
+    return frame_to_ptr(frame);
+}
+
+/**
+ * @brief 分配清零的内存
+ *
+ * @param size 大小
+ * @return 内存 失败时为NULL
+ */
+void *kzalloc(size_t size) {
+    void *ptr = kmalloc(size);
+    if (ptr != NULL) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+/**
+ * @brief 释放内存
+ *
+ * @param ptr 内存
+ */
+void kfree(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    PageFrame *frame = ptr_to_frame(ptr);
+    if (frame->flags & FRAME_SLAB) {
+        kmem_cache_free((KMemCache *)frame->private, ptr);
+        return;
+    }
+
+    frame_put(frame);
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+/**
+ * @file slab.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief slab对象分配器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+#include <mm/numa.h>
+#include <sync/spinlock.h>
+#include <stddef.h>
+
+/**
+ * @brief 对象缓存在一个节点上的slab
+ *
+ */
+typedef struct {
+    /** 有空闲对象的slab */
+    ListNode partial;
+    /** 已满的slab */
+    ListNode full;
+    /** 锁 */
+    Spinlock lock;
+} KMemCacheNode;
+
+/**
+ * @brief 对象缓存
+ * 每个slab占一个页框 页首为slab头 其后为等大的对象
+ * slab按所在页框的节点分开管理
+ *
+ */
+typedef struct {
+    /** 名称 */
+    const char *name;
+    /** 对象大小 */
+    size_t size;
+    /** 每个slab的对象数 */
+    dword objects_per_slab;
+    /** 各节点的slab */
+    KMemCacheNode nodes[MAX_NUMA_NODES];
+} KMemCache;
+
+/**
+ * @brief 初始化对象缓存
+ *
+ * @param cache 对象缓存
+ * @param name 名称
+ * @param size 对象大小
+ */
+void kmem_cache_init(KMemCache *cache, const char *name, size_t size);
+
+/**
+ * @brief 从对象缓存分配对象 优先使用指定节点上的内存
+ *
+ * @param cache 对象缓存
+ * @param node 节点号
+ * @return 对象 失败时为NULL
+ */
+void *kmem_cache_alloc_node(KMemCache *cache, int node);
+
+/**
+ * @brief 从对象缓存分配对象 优先使用当前CPU所在节点的内存
+ *
+ * @param cache 对象缓存
+ * @return 对象 失败时为NULL
+ */
+static inline void *kmem_cache_alloc(KMemCache *cache) {
+    return kmem_cache_alloc_node(cache, current_node());
+}
+
+/**
+ * @brief 释放对象
+ *
+ * @param cache 对象缓存
+ * @param object 对象
+ */
+void kmem_cache_free(KMemCache *cache, void *object);
+
+/**
+ * @brief 初始化通用内存分配
+ *
+ */
+void init_slab(void);
+
+/**
+ * @brief 分配内存
+ * 大于一页一半的请求直接从伙伴系统分配
+ *
+ * @param size 大小
+ * @return 内存 失败时为NULL
+ */
+void *kmalloc(size_t size);
+
+/**
+ * @brief 分配清零的内存
+ *
+ * @param size 大小
+ * @return 内存 失败时为NULL
+ */
+void *kzalloc(size_t size);
+
+/**
+ * @brief 释放内存
+ *
+ * @param ptr 内存
+ */
+void kfree(void *ptr);
\ No newline at end of file
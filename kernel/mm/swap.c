@@ -0,0 +1,96 @@
+/**
+ * @file swap.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 匿名页换出
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/swap.h>
+#include <mm/zswap.h>
+#include <basec/logger.h>
+
+// 当前的换出设备
+static SwapOps *swap_ops = NULL;
+
+/**
+ * @brief 注册换出设备
+ * 压缩缓存始终位于设备之前 设备只接收压缩缓存拒绝的页
+ *
+ * @param ops 后端
+ */
+void register_swap(SwapOps *ops) {
+    swap_ops = ops;
+    log_info("换出后端: %s", ops->name);
+}
+
+/**
+ * @brief 是否可以换出(压缩缓存或换出设备)
+ *
+ * @return 是否可以
+ */
+bool swap_available(void) {
+    return zswap_enabled() || swap_ops != NULL;
+}
+
+/**
+ * @brief 换出一页
+ * 先尝试压缩缓存 失败时交给换出设备
+ *
+ * @param frame 页框(已解除映射且TLB已刷新)
+ * @return 用于替换PTE的换出项 失败时为0
+ */
+qword swap_out(PageFrame *frame) {
+    qword slot;
+    if (zswap_store(frame, &slot)) {
+        return (slot << SWAP_SLOT_SHIFT) | SWAP_ENTRY_ZSWAP | SWAP_ENTRY_MARK;
+    }
+    if (swap_ops == NULL || ! swap_ops->store(frame, &slot)) {
+        return 0;
+    }
+    return (slot << SWAP_SLOT_SHIFT) | SWAP_ENTRY_MARK;
+}
+
+/**
+ * @brief 换入一页 不释放换出项
+ *
+ * @param entry 换出项
+ * @param frame 目标页框
+ * @return 是否成功
+ */
+bool swap_in(qword entry, PageFrame *frame) {
+    if (entry & SWAP_ENTRY_ZSWAP) {
+        return zswap_load(entry >> SWAP_SLOT_SHIFT, frame);
+    }
+    return swap_ops->load(entry >> SWAP_SLOT_SHIFT, frame);
+}
+
+/**
+ * @brief 增加换出项的引用
+ *
+ * @param entry 换出项
+ */
+void swap_dup(qword entry) {
+    if (entry & SWAP_ENTRY_ZSWAP) {
+        zswap_dup(entry >> SWAP_SLOT_SHIFT);
+        return;
+    }
+    swap_ops->dup(entry >> SWAP_SLOT_SHIFT);
+}
+
+/**
+ * @brief 释放对换出项的引用
+ *
+ * @param entry 换出项
+ */
+void swap_free(qword entry) {
+    if (entry & SWAP_ENTRY_ZSWAP) {
+        zswap_release(entry >> SWAP_SLOT_SHIFT);
+        return;
+    }
+    swap_ops->release(entry >> SWAP_SLOT_SHIFT);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file swap.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 匿名页换出
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+
+/** 换出项中槽号的偏移 */
+#define SWAP_SLOT_SHIFT (12)
+/** 换出项标记 P位为0时用于与空表项区分 */
+#define SWAP_ENTRY_MARK (1ull << 1)
+/** 换出项位于压缩缓存中 否则位于换出设备中 */
+#define SWAP_ENTRY_ZSWAP (1ull << 2)
+
+/**
+ * @brief 换出后端
+ * 槽由后端分配 并自行维护其引用计数
+ *
+ */
+typedef struct {
+    /** 名称 */
+    const char *name;
+    /**
+     * @brief 保存一页
+     * 调用时该页已解除映射且TLB已刷新 内容不会再变化
+     *
+     * @param frame 页框
+     * @param slot 返回槽号
+     * @return 是否成功
+     */
+    bool (*store)(PageFrame *frame, qword *slot);
+    /**
+     * @brief 读回一页
+     *
+     * @param slot 槽号
+     * @param frame 目标页框
+     * @return 是否成功
+     */
+    bool (*load)(qword slot, PageFrame *frame);
+    /**
+     * @brief 增加槽的引用
+     * 复制含有换出项的页表时调用
+     *
+     * @param slot 槽号
+     */
+    void (*dup)(qword slot);
+    /**
+     * @brief 释放对槽的引用 最后一个引用释放时回收槽
+     *
+     * @param slot 槽号
+     */
+    void (*release)(qword slot);
+} SwapOps;
+
+/**
+ * @brief 表项是否为换出项
+ *
+ * @param entry 表项
+ * @return 是否为换出项
+ */
+static inline bool is_swap_entry(qword entry) {
+    return (entry & PAGE_PRESENT) == 0 && (entry & SWAP_ENTRY_MARK) != 0;
+}
+
+/**
+ * @brief 注册换出设备
+ * 压缩缓存始终位于设备之前 设备只接收压缩缓存拒绝的页
+ *
+ * @param ops 后端
+ */
+void register_swap(SwapOps *ops);
+
+/**
+ * @brief 是否可以换出(压缩缓存或换出设备)
+ *
+ * @return 是否可以
+ */
+bool swap_available(void);
+
+/**
+ * @brief 换出一页
+ * 先尝试压缩缓存 失败时交给换出设备
+ *
+ * @param frame 页框(已解除映射且TLB已刷新)
+ * @return 用于替换PTE的换出项 失败时为0
+ */
+qword swap_out(PageFrame *frame);
+
+/**
+ * @brief 换入一页 不释放换出项
+ *
+ * @param entry 换出项
+ * @param frame 目标页框
+ * @return 是否成功
+ */
+bool swap_in(qword entry, PageFrame *frame);
+
+/**
+ * @brief 增加换出项的引用
+ *
+ * @param entry 换出项
+ */
+void swap_dup(qword entry);
+
+/**
+ * @brief 释放对换出项的引用
+ *
+ * @param entry 换出项
+ */
+void swap_free(qword entry);
@@ -0,0 +1,392 @@
+/**
+ * @file tlb.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief TLB刷新与跨CPU击落
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/tlb.h>
+#include <mm/pcid.h>
+#include <cpu/cpu.h>
+#include <cpu/apic.h>
+#include <sync/spinlock.h>
+#include <tay/paging.h>
+#include <tay/tlb.h>
+#include <tay/cr.h>
+
+/**
+ * @brief 每CPU的TLB状态
+ *
+ */
+typedef struct {
+    /** 是否处于惰性TLB模式 */
+    bool lazy;
+    /** 本CPU对当前地址空间已完成的TLB世代 */
+    qword generation;
+} TLBState;
+
+/**
+ * @brief 击落请求
+ *
+ */
+typedef struct {
+    /** 地址空间 */
+    AddressSpace *address_space;
+    /** 起始地址 */
+    qword start;
+    /** 结束地址 */
+    qword end;
+    /** 是否整体刷新 */
+    bool full;
+    /** 是否释放了页表 */
+    bool freed_tables;
+    /** 请求对应的TLB世代 */
+    qword generation;
+} ShootdownRequest;
+
+// 各CPU的TLB状态
+static TLBState tlb_states[MAX_CPU_NUM];
+
+// 当前的击落请求
+static ShootdownRequest shootdown_request;
+// 尚未完成当前请求的CPU
+static CPUMask shootdown_pending = 0;
+// 同一时刻只有一个击落请求
+static Spinlock shootdown_lock = SPINLOCK_INIT;
+
+/**
+ * @brief 在本CPU上刷新TLB
+ *
+ * @param request 请求
+ */
+static void flush_local(ShootdownRequest *request) {
+    if (request->full) {
+        if (request->address_space == &kernel_address_space) {
+            // 改变CR4.PGE会同时刷新全局页
+            CR4 cr4 = rdcr4();
+            cr4.PGE = ! cr4.PGE;
+            wrcr4(cr4);
+            cr4.PGE = ! cr4.PGE;
+            wrcr4(cr4);
+        }
+        else {
+            // 读出的CR3中NOFLUSH恒为0 写回即刷新当前PCID
+            wrcr3(rdcr3());
+        }
+        return;
+    }
+
+    for (qword address = request->start ; address < request->end ; address += PAGE_SIZE) {
+        invlpg((void *)address);
+    }
+}
+
+/**
+ * @brief 在指定CPU上执行击落请求
+ *
+ * @param cpu CPU号(必须为当前CPU)
+ * @param request 请求
+ */
+static void handle_request(int cpu, ShootdownRequest *request) {
+    AddressSpace *address_space = request->address_space;
+
+    if (address_space == &kernel_address_space) {
+        flush_local(request);
+        return;
+    }
+
+    // 已经切换走了 没有需要刷新的项
+    if (cpu_address_space(cpu) != address_space) {
+        return;
+    }
+
+    if (tlb_states[cpu].lazy) {
+        // 页表已被释放 惰性CPU不能再引用旧页表
+        if (request->freed_tables) {
+            switch_address_space(&kernel_address_space);
+        }
+        return;
+    }
+
+    flush_local(request);
+    if (tlb_states[cpu].generation < request->generation) {
+        tlb_states[cpu].generation = request->generation;
+    }
+}
+
+/**
+ * @brief 处理发给本CPU的击落请求
+ *
+ * @param cpu CPU号(必须为当前CPU)
+ */
+static void poll_shootdown(int cpu) {
+    if (! cpumask_test(__atomic_load_n(&shootdown_pending, __ATOMIC_SEQ_CST), cpu)) {
+        return;
+    }
+
+    handle_request(cpu, &shootdown_request);
+    cpumask_clear(&shootdown_pending, cpu);
+}
+
+/**
+ * @brief 向目标CPU发送击落请求并等待完成
+ *
+ * @param self 当前CPU号
+ * @param targets 目标CPU
+ * @param request 请求
+ */
+static void send_shootdown(int self, CPUMask targets, ShootdownRequest *request) {
+    // 等锁期间可能有其他CPU在等待本CPU响应
+    while (! spin_trylock(&shootdown_lock)) {
+        poll_shootdown(self);
+        cpu_relax();
+    }
+
+    shootdown_request = *request;
+    __atomic_store_n(&shootdown_pending, targets, __ATOMIC_SEQ_CST);
+
+    // 每个目标CPU一个IPI 与刷新的页数无关
+    for_each_cpu(cpu, targets) {
+        apic_send_ipi(cpu_apic_ids[cpu], TLB_SHOOTDOWN_VECTOR);
+    }
+
+    while (__atomic_load_n(&shootdown_pending, __ATOMIC_SEQ_CST) != 0) {
+        cpu_relax();
+    }
+
+    spin_unlock(&shootdown_lock);
+}
+
+/**
+ * @brief 构造请求并在本CPU与目标CPU上执行
+ *
+ * @param targets 目标CPU(可含本CPU)
+ * @param request 请求
+ */
+static void do_shootdown(CPUMask targets, ShootdownRequest *request) {
+    int self = current_cpu_id();
+
+    if (cpumask_test(targets, self)) {
+        handle_request(self, request);
+        targets &= ~(1ull << self);
+    }
+
+    if (targets != 0) {
+        send_shootdown(self, targets, request);
+    }
+}
+
+/**
+ * @brief 是否应整体刷新
+ *
+ * @param start 起始地址
+ * @param end 结束地址
+ * @return 是否整体刷新
+ */
+static bool should_flush_all(qword start, qword end) {
+    return end == TLB_FLUSH_ALL || (end - start) / PAGE_SIZE > TLB_FLUSH_CEILING;
+}
+
+/**
+ * @brief 在所有可能缓存了该地址空间的CPU上刷新TLB
+ *
+ * @param address_space 地址空间
+ * @param start 起始地址
+ * @param end 结束地址(TLB_FLUSH_ALL为全部)
+ * @param freed_tables 是否释放了页表
+ */
+void tlb_flush_range(AddressSpace *address_space, qword start, qword end, bool freed_tables) {
+    if (address_space == &kernel_address_space) {
+        tlb_flush_kernel_range(start, end);
+        return;
+    }
+
+    ShootdownRequest request = {
+        .address_space = address_space,
+        .start = start & ~(qword)(PAGE_SIZE - 1),
+        .end = end,
+        .full = should_flush_all(start, end),
+        .freed_tables = freed_tables,
+        .generation = __atomic_add_fetch(&address_space->tlb_generation, 1, __ATOMIC_SEQ_CST)
+    };
+
+    CPUMask mask = __atomic_load_n(&address_space->cpumask, __ATOMIC_SEQ_CST);
+
+    if (pcid_enabled()) {
+        // 曾经运行过该地址空间的CPU上仍残留带PCID标签的TLB项
+        // 直接作废PCID 它们下次切换回来时会使用全新的PCID
+        CPUMask stale = 0;
+        for_each_cpu(cpu, mask) {
+            if (cpu_address_space(cpu) != address_space) {
+                stale |= 1ull << cpu;
+            }
+        }
+        if (stale != 0) {
+            pcid_invalidate(address_space);
+            __atomic_fetch_and(&address_space->cpumask, ~stale, __ATOMIC_SEQ_CST);
+            mask &= ~stale;
+        }
+    }
+
+    // 只有正在运行该地址空间的CPU需要IPI
+    CPUMask targets = 0;
+    for_each_cpu(cpu, mask) {
+        if (cpu_address_space(cpu) != address_space) {
+            continue;
+        }
+        // 惰性CPU离开惰性模式时会根据TLB世代补刷新
+        if (__atomic_load_n(&tlb_states[cpu].lazy, __ATOMIC_SEQ_CST) && ! freed_tables) {
+            continue;
+        }
+        targets |= 1ull << cpu;
+    }
+
+    do_shootdown(targets, &request);
+}
+
+/**
+ * @brief 在所有CPU上刷新内核地址范围(含全局页)
+ *
+ * @param start 起始地址
+ * @param end 结束地址(TLB_FLUSH_ALL为全部)
+ */
+void tlb_flush_kernel_range(qword start, qword end) {
+    ShootdownRequest request = {
+        .address_space = &kernel_address_space,
+        .start = start & ~(qword)(PAGE_SIZE - 1),
+        .end = end,
+        .full = should_flush_all(start, end),
+        .freed_tables = false,
+        .generation = 0
+    };
+
+    do_shootdown(__atomic_load_n(&cpu_online_mask, __ATOMIC_SEQ_CST), &request);
+}
+
+/**
+ * @brief 初始化TLB刷新批次
+ *
+ * @param batch 批次
+ * @param address_space 地址空间
+ */
+void tlb_batch_init(TLBBatch *batch, AddressSpace *address_space) {
+    batch->address_space = address_space;
+    batch->start = TLB_FLUSH_ALL;
+    batch->end = 0;
+    batch->freed_tables = false;
+}
+
+/**
+ * @brief 向批次中加入一个范围
+ *
+ * @param batch 批次
+ * @param start 起始地址
+ * @param end 结束地址
+ */
+void tlb_batch_add_range(TLBBatch *batch, qword start, qword end) {
+    if (start < batch->start) {
+        batch->start = start;
+    }
+    if (end > batch->end) {
+        batch->end = end;
+    }
+}
+
+/**
+ * @brief 向批次中加入一页
+ *
+ * @param batch 批次
+ * @param address 页地址
+ */
+void tlb_batch_add(TLBBatch *batch, qword address) {
+    tlb_batch_add_range(batch, address, address + PAGE_SIZE);
+}
+
+/**
+ * @brief 刷新批次中收集的所有地址 并清空批次
+ *
+ * @param batch 批次
+ */
+void tlb_batch_flush(TLBBatch *batch) {
+    if (batch->start < batch->end) {
+        tlb_flush_range(batch->address_space, batch->start, batch->end, batch->freed_tables);
+    }
+    tlb_batch_init(batch, batch->address_space);
+}
+
+/**
+ * @brief 进入惰性TLB模式
+ * 切换到不需要用户地址空间的内核线程时调用 保留当前CR3
+ * 惰性模式下的CPU不接收该地址空间的普通击落请求 返回时再补刷新
+ *
+ */
+void tlb_enter_lazy(void) {
+    int cpu = current_cpu_id();
+    if (cpu_address_space(cpu) != &kernel_address_space) {
+        __atomic_store_n(&tlb_states[cpu].lazy, true, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * @brief 离开惰性TLB模式
+ *
+ * @param cpu CPU号
+ * @param address_space 仍然加载着的地址空间
+ */
+void tlb_leave_lazy(int cpu, AddressSpace *address_space) {
+    if (! tlb_states[cpu].lazy) {
+        return;
+    }
+
+    // 先清除惰性标志再读取世代 与tlb_flush_range中的顺序相对应
+    __atomic_store_n(&tlb_states[cpu].lazy, false, __ATOMIC_SEQ_CST);
+
+    qword generation = __atomic_load_n(&address_space->tlb_generation, __ATOMIC_SEQ_CST);
+    if (tlb_states[cpu].generation != generation) {
+        ShootdownRequest request = {
+            .address_space = address_space,
+            .full = true
+        };
+        flush_local(&request);
+        tlb_states[cpu].generation = generation;
+    }
+}
+
+/**
+ * @brief 地址空间切换完成后更新TLB状态
+ *
+ * @param cpu CPU号
+ * @param prev 原地址空间
+ * @param next 新地址空间
+ */
+void tlb_switched(int cpu, AddressSpace *prev, AddressSpace *next) {
+    // 未启用PCID时写CR3已清除了原地址空间的TLB项
+    if (! pcid_enabled()) {
+        cpumask_clear(&prev->cpumask, cpu);
+    }
+    else if (prev != &kernel_address_space &&
+        tlb_states[cpu].generation < __atomic_load_n(&prev->tlb_generation, __ATOMIC_SEQ_CST)) {
+        // 惰性期间跳过了原地址空间的刷新 其PCID下仍残留旧TLB项
+        // 作废PCID 切换回来时使用新PCID 不会以NOFLUSH沿用旧项
+        // 本CPU已公开切换到了新地址空间 此后的刷新都会把本CPU当作残留处理
+        pcid_invalidate(prev);
+        cpumask_clear(&prev->cpumask, cpu);
+    }
+
+    __atomic_store_n(&tlb_states[cpu].lazy, false, __ATOMIC_SEQ_CST);
+    tlb_states[cpu].generation = __atomic_load_n(&next->tlb_generation, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief TLB击落IPI处理程序
+ *
+ * @param frame 中断现场
+ */
+void tlb_shootdown_interrupt(InterruptFrame *frame) {
+    poll_shootdown(current_cpu_id());
+}
\ No newline at end of file
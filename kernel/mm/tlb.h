@@ -0,0 +1,131 @@
+/**
+ * @file tlb.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief TLB刷新与跨CPU击落
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/vmm.h>
+#include <cpu/interrupt.h>
+
+/** 刷新到地址空间末尾(即全部刷新) */
+#define TLB_FLUSH_ALL (~0ull)
+
+/**
+ * @brief 逐页刷新的页数上限
+ * 超过该值时直接刷新整个地址空间 比逐页invlpg更快
+ *
+ */
+#define TLB_FLUSH_CEILING (33)
+
+/** TLB击落IPI向量 */
+#define TLB_SHOOTDOWN_VECTOR (0xFD)
+
+/**
+ * @brief TLB刷新批次
+ * 在解除映射的过程中收集需要刷新的地址 最后一次性击落
+ *
+ */
+typedef struct {
+    /** 地址空间 */
+    AddressSpace *address_space;
+    /** 待刷新范围起始 */
+    qword start;
+    /** 待刷新范围结束 */
+    qword end;
+    /**
+     * @brief 是否释放了页表
+     * 释放页表时惰性TLB模式的CPU也必须响应
+     *
+     */
+    bool freed_tables;
+} TLBBatch;
+
+/**
+ * @brief 初始化TLB刷新批次
+ *
+ * @param batch 批次
+ * @param address_space 地址空间
+ */
+void tlb_batch_init(TLBBatch *batch, AddressSpace *address_space);
+
+/**
+ * @brief 向批次中加入一个范围
+ *
+ * @param batch 批次
+ * @param start 起始地址
+ * @param end 结束地址
+ */
+void tlb_batch_add_range(TLBBatch *batch, qword start, qword end);
+
+/**
+ * @brief 向批次中加入一页
+ *
+ * @param batch 批次
+ * @param address 页地址
+ */
+void tlb_batch_add(TLBBatch *batch, qword address);
+
+/**
+ * @brief 刷新批次中收集的所有地址 并清空批次
+ *
+ * @param batch 批次
+ */
+void tlb_batch_flush(TLBBatch *batch);
+
+/**
+ * @brief 在所有可能缓存了该地址空间的CPU上刷新TLB
+ *
+ * @param address_space 地址空间
+ * @param start 起始地址
+ * @param end 结束地址(TLB_FLUSH_ALL为全部)
+ * @param freed_tables 是否释放了页表
+ */
+void tlb_flush_range(AddressSpace *address_space, qword start, qword end, bool freed_tables);
+
+/**
+ * @brief 在所有CPU上刷新内核地址范围(含全局页)
+ *
+ * @param start 起始地址
+ * @param end 结束地址(TLB_FLUSH_ALL为全部)
+ */
+void tlb_flush_kernel_range(qword start, qword end);
+
+/**
+ * @brief 进入惰性TLB模式
+ * 切换到不需要用户地址空间的内核线程时调用 保留当前CR3
+ * 惰性模式下的CPU不接收该地址空间的普通击落请求 返回时再补刷新
+ *
+ */
+void tlb_enter_lazy(void);
+
+/**
+ * @brief 离开惰性TLB模式
+ *
+ * @param cpu CPU号
+ * @param address_space 仍然加载着的地址空间
+ */
+void tlb_leave_lazy(int cpu, AddressSpace *address_space);
+
+/**
+ * @brief 地址空间切换完成后更新TLB状态
+ *
+ * @param cpu CPU号
+ * @param prev 原地址空间
+ * @param next 新地址空间
+ */
+void tlb_switched(int cpu, AddressSpace *prev, AddressSpace *next);
+
+/**
+ * @brief TLB击落IPI处理程序
+ *
+ * @param frame 中断现场
+ */
+void tlb_shootdown_interrupt(InterruptFrame *frame);
\ No newline at end of file
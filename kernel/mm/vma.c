@@ -0,0 +1,111 @@
+/**
+ * @file vma.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 虚拟内存区域
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/vma.h>
+#include <mm/slab.h>
+
+/**
+ * @brief 查找包含地址的区域
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @return 区域 不存在时为NULL
+ */
+VMArea *find_vma(AddressSpace *address_space, qword address) {
+    list_for_each(node, &address_space->vmas) {
+        VMArea *vma = list_entry(node, VMArea, list);
+        if (address < vma->start) {
+            break;
+        }
+        if (address < vma->end) {
+            return vma;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 新建区域
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param start 起始地址(页对齐)
+ * @param end 结束地址(页对齐)
+ * @param flags 标志
+ * @return 区域 与已有区域重叠或内存不足时为NULL
+ */
+VMArea *create_vma(AddressSpace *address_space, qword start, qword end, dword flags) {
+    if (start >= end || start < USER_SPACE_START || end > USER_SPACE_END) {
+        return NULL;
+    }
+
+    // 找到插入位置 同时检查重叠
+    ListNode *prev = &address_space->vmas;
+    list_for_each(node, &address_space->vmas) {
+        VMArea *vma = list_entry(node, VMArea, list);
+        if (vma->start >= end) {
+            break;
+        }
+        if (vma->end > start) {
+            return NULL;
+        }
+        prev = node;
+    }
+
+    VMArea *vma = kmalloc(sizeof(VMArea));
+    if (vma == NULL) {
+        return NULL;
+    }
+
+    vma->start = start;
+    vma->end = end;
+    vma->flags = flags;
+    list_add(prev, &vma->list);
+
+    return vma;
+}
+
+/**
+ * @brief 复制地址空间的所有区域
+ *
+ * @param dst 目标地址空间
+ * @param src 源地址空间
+ * @return 是否成功
+ */
+bool copy_vmas(AddressSpace *dst, AddressSpace *src) {
+    list_for_each(node, &src->vmas) {
+        VMArea *vma = list_entry(node, VMArea, list);
+        VMArea *copy = kmalloc(sizeof(VMArea));
+        if (copy == NULL) {
+            return false;
+        }
+
+        copy->start = vma->start;
+        copy->end = vma->end;
+        copy->flags = vma->flags;
+        list_add_tail(&dst->vmas, &copy->list);
+    }
+    return true;
+}
+
+/**
+ * @brief 释放地址空间的所有区域
+ *
+ * @param address_space 地址空间
+ */
+void destroy_vmas(AddressSpace *address_space) {
+    list_for_each_safe(node, &address_space->vmas) {
+        list_del(node);
+        kfree(list_entry(node, VMArea, list));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+ * @file vma.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 虚拟内存区域
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/vmm.h>
+#include <tay/paging.h>
+
+/**
+ * @brief 虚拟内存区域标志
+ *
+ */
+enum VMAFlags {
+    /** 可读 */
+    VMA_READ  = 1 << 0,
+    /** 可写 */
+    VMA_WRITE = 1 << 1,
+    /** 可执行 */
+    VMA_EXEC  = 1 << 2,
+    /** 匿名内存(缺页时分配清零页) */
+    VMA_ANON  = 1 << 3
+};
+
+/**
+ * @brief 虚拟内存区域
+ *
+ */
+typedef struct {
+    /** 区域链表 */
+    ListNode list;
+    /** 起始地址 */
+    qword start;
+    /** 结束地址 */
+    qword end;
+    /** 标志 */
+    dword flags;
+} VMArea;
+
+/**
+ * @brief 查找包含地址的区域
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param address 地址
+ * @return 区域 不存在时为NULL
+ */
+VMArea *find_vma(AddressSpace *address_space, qword address);
+
+/**
+ * @brief 新建区域
+ * 调用者需持有地址空间的锁
+ *
+ * @param address_space 地址空间
+ * @param start 起始地址(页对齐)
+ * @param end 结束地址(页对齐)
+ * @param flags 标志
+ * @return 区域 与已有区域重叠或内存不足时为NULL
+ */
+VMArea *create_vma(AddressSpace *address_space, qword start, qword end, dword flags);
+
+/**
+ * @brief 复制地址空间的所有区域
+ *
+ * @param dst 目标地址空间
+ * @param src 源地址空间
+ * @return 是否成功
+ */
+bool copy_vmas(AddressSpace *dst, AddressSpace *src);
+
+/**
+ * @brief 释放地址空间的所有区域
+ *
+ * @param address_space 地址空间
+ */
+void destroy_vmas(AddressSpace *address_space);
+
+/**
+ * @brief 区域对应的页表项权限
+ *
+ * @param vma 区域
+ * @return 页表项权限位
+ */
+static inline qword vma_page_flags(VMArea *vma) {
+    qword flags = PAGE_PRESENT | PAGE_USER;
+    if (vma->flags & VMA_WRITE) {
+        flags |= PAGE_WRITE;
+    }
+    if ((vma->flags & VMA_EXEC) == 0) {
+        flags |= PAGE_NOEXEC;
+    }
+    return flags;
+}
\ No newline at end of file
@@ -0,0 +1,480 @@
+/**
+ * @file vmalloc.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 虚拟连续的内核内存分配
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/vmalloc.h>
+#include <mm/paging.h>
+#include <mm/buddy.h>
+#include <mm/slab.h>
+#include <mm/tlb.h>
+#include <basec/logger.h>
+
+// 空闲区域 按起始地址排序 以子树最大空闲区域增强
+static RBTree free_tree = RB_TREE_INIT;
+// 已分配区域 按起始地址排序
+static RBTree busy_tree = RB_TREE_INIT;
+// 已释放但TLB尚未刷新的区域
+static ListNode lazy_list = LIST_HEAD_INIT(lazy_list);
+// 惰性释放链表中的页数
+static qword lazy_pages = 0;
+// 保护以上结构
+static Spinlock vmap_lock = SPINLOCK_INIT;
+
+static KMemCache vmap_area_cache;
+
+/**
+ * @brief 区域大小
+ *
+ * @param area 区域
+ * @return 大小
+ */
+static inline qword area_size(VMapArea *area) {
+    return area->end - area->start;
+}
+
+/**
+ * @brief 子树中最大的空闲区域大小
+ *
+ * @param node 子树根
+ * @return 大小 空子树为0
+ */
+static inline qword subtree_max(RBNode *node) {
+    return node == NULL ? 0 : rb_entry(node, VMapArea, node)->subtree_max_size;
+}
+
+/**
+ * @brief 重新计算空闲树节点的子树最大空闲区域
+ *
+ * @param node 节点
+ */
+static void augment_free(RBNode *node) {
+    VMapArea *area = rb_entry(node, VMapArea, node);
+    qword max = area_size(area);
+    if (subtree_max(node->left) > max) {
+        max = subtree_max(node->left);
+    }
+    if (subtree_max(node->right) > max) {
+        max = subtree_max(node->right);
+    }
+    area->subtree_max_size = max;
+}
+
+/**
+ * @brief 按起始地址将区域插入树中
+ *
+ * @param tree 树
+ * @param area 区域
+ * @param augment 增强回调
+ */
+static void insert_area(RBTree *tree, VMapArea *area, RBAugment augment) {
+    RBNode **link = &tree->root;
+    RBNode *parent = NULL;
+
+    while (*link != NULL) {
+        parent = *link;
+        if (area->start < rb_entry(parent, VMapArea, node)->start) {
+            link = &parent->left;
+        }
+        else {
+            link = &parent->right;
+        }
+    }
+
+    rb_link_node(&area->node, parent, link);
+    rb_insert_color(tree, &area->node, augment);
+}
+
+/**
+ * @brief 查找地址最低且足够大的空闲区域
+ * 子树最大空闲区域不足时跳过整棵子树 复杂度为O(log n)
+ *
+ * @param size 大小
+ * @return 区域 不存在时为NULL
+ */
+static VMapArea *find_lowest_fit(qword size) {
+    RBNode *node = free_tree.root;
+    if (subtree_max(node) < size) {
+        return NULL;
+    }
+
+    while (node != NULL) {
+        VMapArea *area = rb_entry(node, VMapArea, node);
+        if (subtree_max(node->left) >= size) {
+            node = node->left;
+        }
+        else if (area_size(area) >= size) {
+            return area;
+        }
+        else {
+            node = node->right;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 将区域归还空闲树 并与相邻的空闲区域合并
+ * 调用者需持有vmap_lock
+ *
+ * @param area 区域
+ */
+static void merge_free_area(VMapArea *area) {
+    insert_area(&free_tree, area, augment_free);
+
+    RBNode *prev = rb_prev(&area->node);
+    if (prev != NULL && rb_entry(prev, VMapArea, node)->end == area->start) {
+        VMapArea *prev_area = rb_entry(prev, VMapArea, node);
+        rb_erase(&free_tree, &area->node, augment_free);
+        prev_area->end = area->end;
+        rb_propagate(prev, augment_free);
+        kmem_cache_free(&vmap_area_cache, area);
+        area = prev_area;
+    }
+
+    RBNode *next = rb_next(&area->node);
+    if (next != NULL && rb_entry(next, VMapArea, node)->start == area->end) {
+        VMapArea *next_area = rb_entry(next, VMapArea, node);
+        rb_erase(&free_tree, next, augment_free);
+        area->end = next_area->end;
+        rb_propagate(&area->node, augment_free);
+        kmem_cache_free(&vmap_area_cache, next_area);
+    }
+}
+
+/**
+ * @brief 清除所有惰性释放的区域
+ * 整个批次只刷新一次TLB 之后这些虚拟地址才能被重新分配
+ *
+ */
+static void purge_vmap_areas(void) {
+    ListNode purge_list = LIST_HEAD_INIT(purge_list);
+    qword start = ~0ull;
+    qword end = 0;
+
+    spin_lock(&vmap_lock);
+    list_for_each_safe(node, &lazy_list) {
+        VMapArea *area = list_entry(node, VMapArea, list);
+        if (area->start < start) {
+            start = area->start;
+        }
+        if (area->end > end) {
+            end = area->end;
+        }
+        list_del(node);
+        list_add_tail(&purge_list, node);
+    }
+    lazy_pages = 0;
+    spin_unlock(&vmap_lock);
+
+    if (list_empty(&purge_list)) {
+        return;
+    }
+
+    tlb_flush_kernel_range(start, end);
+
+    spin_lock(&vmap_lock);
+    list_for_each_safe(node, &purge_list) {
+        list_del(node);
+        merge_free_area(list_entry(node, VMapArea, list));
+    }
+    spin_unlock(&vmap_lock);
+}
+
+/**
+ * @brief 分配一段虚拟地址
+ * 空间不足时先清除惰性释放的区域再重试
+ *
+ * @param size 大小(页对齐)
+ * @return 区域 失败时为NULL
+ */
+static VMapArea *alloc_vmap_area(qword size) {
+    VMapArea *busy = kmem_cache_alloc(&vmap_area_cache);
+    if (busy == NULL) {
+        return NULL;
+    }
+
+    bool purged = false;
+
+    spin_lock(&vmap_lock);
+    VMapArea *area = find_lowest_fit(size);
+    while (area == NULL && ! purged) {
+        spin_unlock(&vmap_lock);
+        purge_vmap_areas();
+        purged = true;
+        spin_lock(&vmap_lock);
+        area = find_lowest_fit(size);
+    }
+
+    if (area == NULL) {
+        spin_unlock(&vmap_lock);
+        kmem_cache_free(&vmap_area_cache, busy);
+        return NULL;
+    }
+
+    busy->start = area->start;
+    busy->end = area->start + size;
+    busy->ioremap = false;
+
+    if (area_size(area) == size) {
+        rb_erase(&free_tree, &area->node, augment_free);
+        kmem_cache_free(&vmap_area_cache, area);
+    }
+    else {
+        // 从低端切出 不改变空闲区域之间的顺序
+        area->start += size;
+        rb_propagate(&area->node, augment_free);
+    }
+
+    insert_area(&busy_tree, busy, NULL);
+    spin_unlock(&vmap_lock);
+
+    return busy;
+}
+
+/**
+ * @brief 查找已分配的区域
+ * 调用者需持有vmap_lock
+ *
+ * @param start 起始地址
+ * @return 区域 不存在时为NULL
+ */
+static VMapArea *find_busy_area(qword start) {
+    RBNode *node = busy_tree.root;
+    while (node != NULL) {
+        VMapArea *area = rb_entry(node, VMapArea, node);
+        if (start < area->start) {
+            node = node->left;
+        }
+        else if (start > area->start) {
+            node = node->right;
+        }
+        else {
+            return area;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 从已分配树中取出区域
+ *
+ * @param start 起始地址
+ * @param ioremap 区域是否应为ioremap映射
+ * @return 区域 不存在或类型不符时为NULL
+ */
+static VMapArea *take_busy_area(qword start, bool ioremap) {
+    spin_lock(&vmap_lock);
+    VMapArea *area = find_busy_area(start);
+    if (area != NULL && area->ioremap == ioremap) {
+        rb_erase(&busy_tree, &area->node, NULL);
+    }
+    else {
+        area = NULL;
+    }
+    spin_unlock(&vmap_lock);
+    return area;
+}
+
+/**
+ * @brief 解除映射并释放区域中的页 不刷新TLB
+ * 残留的TLB项只指向已释放的虚拟地址 在区域被清除前这些地址不会被重新分配
+ *
+ * @param start 起始地址
+ * @param end 结束地址
+ */
+static void unmap_area_noflush(qword start, qword end) {
+    spin_lock(&kernel_address_space.lock);
+    for (qword address = start ; address < end ; address += PAGE_SIZE) {
+        PTE *pte = walk_pte(&kernel_address_space, address, 0);
+        if (pte == NULL || ! pte->ref_page_entry.P) {
+            continue;
+        }
+        PageFrame *frame = phys_to_frame(get_4k_page_addr(pte->ref_page_entry));
+        pte->ref_page_entry.address = 0;
+        free_frames(frame, 0);
+    }
+    spin_unlock(&kernel_address_space.lock);
+}
+
+/**
+ * @brief 将区域加入惰性释放链表
+ * 累计的页数超过上限时统一清除
+ *
+ * @param area 区域
+ */
+static void free_vmap_area_lazy(VMapArea *area) {
+    spin_lock(&vmap_lock);
+    list_add_tail(&lazy_list, &area->list);
+    lazy_pages += area_size(area) / PAGE_SIZE;
+    bool purge = lazy_pages > VMAP_LAZY_MAX_PAGES;
+    spin_unlock(&vmap_lock);
+
+    if (purge) {
+        purge_vmap_areas();
+    }
+}
+
+/**
+ * @brief 初始化vmalloc区
+ * 需在slab初始化之后调用
+ *
+ */
+void init_vmalloc(void) {
+    kmem_cache_init(&vmap_area_cache, "vmap_area", sizeof(VMapArea));
+
+    VMapArea *area = kmem_cache_alloc(&vmap_area_cache);
+    if (area == NULL) {
+        log_error("无法初始化vmalloc区");
+        return;
+    }
+
+    area->start = VMALLOC_START;
+    area->end = VMALLOC_END;
+    insert_area(&free_tree, area, augment_free);
+}
+
+/**
+ * @brief 分配虚拟连续的内存
+ * 物理页逐页分配 不要求物理连续 区域之后留有一页未映射的保护页
+ *
+ * @param size 大小
+ * @return 内存 失败时为NULL
+ */
+void *vmalloc(size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    qword mapped = (size + PAGE_SIZE - 1) & ~(qword)(PAGE_SIZE - 1);
+    VMapArea *area = alloc_vmap_area(mapped + PAGE_SIZE);
+    if (area == NULL) {
+        return NULL;
+    }
+
+    bool success = true;
+
+    spin_lock(&kernel_address_space.lock);
+    for (qword address = area->start ; address < area->start + mapped ; address += PAGE_SIZE) {
+        PageFrame *frame = alloc_frames_node(current_node(), 0, 0);
+        if (frame == NULL) {
+            success = false;
+            break;
+        }
+        if (! map_page(&kernel_address_space, address, frame_to_phys(frame), PAGE_WRITE | PAGE_GLOBAL)) {
+            free_frames(frame, 0);
+            success = false;
+            break;
+        }
+    }
+    spin_unlock(&kernel_address_space.lock);
+
+    if (! success) {
+        vfree((void *)area->start);
+        return NULL;
+    }
+
+    return (void *)area->start;
+}
+
+/**
+ * @brief 释放vmalloc分配的内存
+ * 虚拟地址惰性回收 累计到一定数量后统一刷新TLB
+ *
+ * @param ptr 内存
+ */
+void vfree(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    VMapArea *area = take_busy_area((qword)ptr, false);
+    if (area == NULL) {
+        log_error("vfree: %p不是vmalloc分配的地址", ptr);
+        return;
+    }
+
+    unmap_area_noflush(area->start, area->end);
+    free_vmap_area_lazy(area);
+}
+
+/**
+ * @brief 以指定缓存类型映射一段物理地址
+ * 用于设备内存 映射的页不由内核分配 也不会被释放
+ *
+ * @param phys 物理地址
+ * @param size 大小
+ * @param mode 缓存类型
+ * @return 虚拟地址 失败时为NULL
+ */
+void *ioremap_cache(qword phys, size_t size, CacheMode mode) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    qword offset = phys & (PAGE_SIZE - 1);
+    qword base = phys - offset;
+    qword mapped = (offset + size + PAGE_SIZE - 1) & ~(qword)(PAGE_SIZE - 1);
+
+    VMapArea *area = alloc_vmap_area(mapped + PAGE_SIZE);
+    if (area == NULL) {
+        return NULL;
+    }
+    area->ioremap = true;
+
+    qword flags = PAGE_WRITE | PAGE_GLOBAL | cache_mode_flags(mode);
+    bool success = true;
+
+    spin_lock(&kernel_address_space.lock);
+    for (qword i = 0 ; i < mapped ; i += PAGE_SIZE) {
+        if (! map_page(&kernel_address_space, area->start + i, base + i, flags)) {
+            success = false;
+            break;
+        }
+    }
+    spin_unlock(&kernel_address_space.lock);
+
+    if (! success) {
+        iounmap((void *)area->start);
+        return NULL;
+    }
+
+    return (void *)(area->start + offset);
+}
+
+/**
+ * @brief 解除ioremap的映射
+ * 与vfree一样惰性回收虚拟地址 只清除页表项 不释放页
+ *
+ * @param ptr ioremap返回的地址
+ */
+void iounmap(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    VMapArea *area = take_busy_area((qword)ptr & ~(qword)(PAGE_SIZE - 1), true);
+    if (area == NULL) {
+        log_error("iounmap: %p不是ioremap映射的地址", ptr);
+        return;
+    }
+
+    spin_lock(&kernel_address_space.lock);
+    for (qword address = area->start ; address < area->end ; address += PAGE_SIZE) {
+        PTE *pte = walk_pte(&kernel_address_space, address, 0);
+        if (pte != NULL) {
+            pte->ref_page_entry.address = 0;
+        }
+    }
+    spin_unlock(&kernel_address_space.lock);
+
+    free_vmap_area_lazy(area);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file vmalloc.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 虚拟连续的内核内存分配
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <lib/rbtree.h>
+#include <mm/pat.h>
+#include <stddef.h>
+
+/** vmalloc区起始地址(紧接在直接映射区之后) */
+#define VMALLOC_START (0xFFFFC90000000000ull)
+/** vmalloc区结束地址(32TB) */
+#define VMALLOC_END   (0xFFFFE90000000000ull)
+
+/**
+ * @brief 惰性释放的页数上限
+ * 超过后统一清除已释放区域 只需刷新一次TLB
+ *
+ */
+#define VMAP_LAZY_MAX_PAGES (8192)
+
+/**
+ * @brief vmalloc区中的一段虚拟地址
+ *
+ */
+typedef struct {
+    /** 空闲树或已分配树中的节点 */
+    RBNode node;
+    /** 惰性释放链表 */
+    ListNode list;
+    /** 起始地址 */
+    qword start;
+    /** 结束地址 */
+    qword end;
+    /** 子树中最大的空闲区域大小(仅空闲树) */
+    qword subtree_max_size;
+    /** 是否映射设备内存(ioremap) 其页不归内核所有 */
+    bool ioremap;
+} VMapArea;
+
+/**
+ * @brief 初始化vmalloc区
+ * 需在slab初始化之后调用
+ *
+ */
+void init_vmalloc(void);
+
+/**
+ * @brief 分配虚拟连续的内存
+ * 物理页逐页分配 不要求物理连续 区域之后留有一页未映射的保护页
+ *
+ * @param size 大小
+ * @return 内存 失败时为NULL
+ */
+void *vmalloc(size_t size);
+
+/**
+ * @brief 释放vmalloc分配的内存
+ * 虚拟地址惰性回收 累计到一定数量后统一刷新TLB
+ *
+ * @param ptr 内存
+ */
+void vfree(void *ptr);
+
+/**
+ * @brief 以指定缓存类型映射一段物理地址
+ * 用于设备内存 映射的页不由内核分配 也不会被释放
+ *
+ * @param phys 物理地址
+ * @param size 大小
+ * @param mode 缓存类型
+ * @return 虚拟地址 失败时为NULL
+ */
+void *ioremap_cache(qword phys, size_t size, CacheMode mode);
+
+/**
+ * @brief 以不缓存方式映射设备寄存器
+ *
+ * @param phys 物理地址
+ * @param size 大小
+ * @return 虚拟地址 失败时为NULL
+ */
+static inline void *ioremap_uc(qword phys, size_t size) {
+    return ioremap_cache(phys, size, CACHE_UC);
+}
+
+/**
+ * @brief 以写合并方式映射帧缓冲等只写为主的设备内存
+ * 连续写入在写合并缓冲中合并为整行的突发传输 带宽远高于不缓存映射
+ * 写入的顺序与可见时机不确定 需要时以sfence排序
+ *
+ * @param phys 物理地址
+ * @param size 大小
+ * @return 虚拟地址 失败时为NULL
+ */
+static inline void *ioremap_wc(qword phys, size_t size) {
+    return ioremap_cache(phys, size, CACHE_WC);
+}
+
+/**
+ * @brief 解除ioremap的映射
+ *
+ * @param ptr ioremap返回的地址
+ */
+void iounmap(void *ptr);
@@ -0,0 +1,161 @@
+/**
+ * @file vmm.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 虚拟内存管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/vmm.h>
+#include <mm/pcid.h>
+#include <mm/tlb.h>
+#include <sched/sched.h>
+#include <tay/cr.h>
+#include <tay/cpuid.h>
+#include <basec/logger.h>
+
+/** 内核地址空间 */
+AddressSpace kernel_address_space;
+
+/** 用户空间结束地址 */
+qword user_space_end = USER_SPACE_END_L4;
+
+/** 分页级数(4或5) */
+int paging_levels = 4;
+
+/** 所有用户地址空间 */
+ListNode address_space_list = LIST_HEAD_INIT(address_space_list);
+
+/** 保护用户地址空间链表的锁 */
+Spinlock address_space_list_lock = SPINLOCK_INIT;
+
+// 各CPU当前的地址空间
+static AddressSpace *current_spaces[MAX_CPU_NUM];
+
+/**
+ * @brief 初始化虚拟内存管理
+ *
+ */
+void init_vmm(void) {
+    // 长模式下无法切换LA57 只能沿用加载器的选择
+    if (rdcr4().LA57) {
+        paging_levels = 5;
+        user_space_end = USER_SPACE_END_L5;
+    }
+    else if (cpuid_max_leaf() >= 7 && (cpuid(7, 0).ecx & CPUID_07_ECX_LA57)) {
+        log_info("CPU支持5级分页, 但加载器未启用");
+    }
+
+    // 沿用加载器建立的页表
+    kernel_address_space.root = rdcr3().page_entry & CR3_PAGE_ENTRY_MASK;
+    kernel_address_space.pcid_context = 0;
+    kernel_address_space.cpumask = 0;
+    kernel_address_space.tlb_generation = 0;
+    kernel_address_space.scanners = 0;
+    kernel_address_space.reclaim_cursor = USER_SPACE_START;
+    list_init(&kernel_address_space.vmas);
+    list_init(&kernel_address_space.list);
+    kernel_address_space.lock = (Spinlock)SPINLOCK_INIT;
+
+    for (int cpu = 0 ; cpu < MAX_CPU_NUM ; cpu ++) {
+        current_spaces[cpu] = &kernel_address_space;
+    }
+    cpumask_set(&kernel_address_space.cpumask, current_cpu_id());
+}
+
+/**
+ * @brief 获取当前地址空间
+ *
+ * @return 当前地址空间
+ */
+AddressSpace *current_address_space(void) {
+    return current_spaces[current_cpu_id()];
+}
+
+/**
+ * @brief 获取指定CPU正在使用的地址空间
+ *
+ * @param cpu CPU号
+ * @return 地址空间
+ */
+AddressSpace *cpu_address_space(int cpu) {
+    return __atomic_load_n(&current_spaces[cpu], __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 切换地址空间
+ *
+ * @param address_space 目标地址空间
+ */
+void switch_address_space(AddressSpace *address_space) {
+    int cpu = current_cpu_id();
+    AddressSpace *prev = current_spaces[cpu];
+
+    if (address_space == prev) {
+        // 从惰性TLB模式返回 补上期间错过的刷新
+        tlb_leave_lazy(cpu, address_space);
+        return;
+    }
+
+    // 先公开本CPU将使用该地址空间 再读取其PCID
+    // 与tlb_flush_range中先作废PCID再检查各CPU的顺序相对应
+    __atomic_store_n(&current_spaces[cpu], address_space, __ATOMIC_SEQ_CST);
+    cpumask_set(&address_space->cpumask, cpu);
+
+    wrcr3(pcid_build_cr3(address_space));
+
+    tlb_switched(cpu, prev, address_space);
+}
+
+/**
+ * @brief 登记用户地址空间
+ * 登记后内存整理等后台工作才能遍历其页表
+ *
+ * @param address_space 地址空间
+ */
+void register_address_space(AddressSpace *address_space) {
+    spin_lock(&address_space_list_lock);
+    list_add_tail(&address_space_list, &address_space->list);
+    spin_unlock(&address_space_list_lock);
+}
+
+/**
+ * @brief 注销用户地址空间
+ * 返回后后台工作不再访问该地址空间
+ *
+ * @param address_space 地址空间
+ */
+void unregister_address_space(AddressSpace *address_space) {
+    // 持有链表锁遍历的后台工作 拿到锁即说明已不在使用该地址空间
+    spin_lock(&address_space_list_lock);
+    list_del(&address_space->list);
+    spin_unlock(&address_space_list_lock);
+
+    // 不持有链表锁遍历的后台工作(页回收)以引用保护 等待其结束
+    while (__atomic_load_n(&address_space->scanners, __ATOMIC_SEQ_CST) != 0) {
+        thread_yield();
+    }
+}
+
+/**
+ * @brief 引用链表中的地址空间
+ * 调用者需持有链表锁 之后可以释放链表锁遍历该地址空间
+ *
+ * @param address_space 地址空间
+ */
+void address_space_get(AddressSpace *address_space) {
+    __atomic_add_fetch(&address_space->scanners, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 释放address_space_get取得的引用
+ *
+ * @param address_space 地址空间
+ */
+void address_space_put(AddressSpace *address_space) {
+    __atomic_sub_fetch(&address_space->scanners, 1, __ATOMIC_SEQ_CST);
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+/**
+ * @file vmm.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 虚拟内存管理
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <cpu/cpu.h>
+#include <lib/list.h>
+#include <sync/spinlock.h>
+
+/**
+ * @brief 用户空间起始地址
+ * 第0个PML4项仍用于加载器建立的内核恒等映射
+ *
+ */
+#define USER_SPACE_START (0x0000008000000000)
+/** 4级分页时的用户空间结束地址(128TB) */
+#define USER_SPACE_END_L4 (0x0000800000000000)
+/** 5级分页时的用户空间结束地址(64PB) */
+#define USER_SPACE_END_L5 (0x0100000000000000)
+/** 用户空间结束地址 取决于分页级数 */
+#define USER_SPACE_END   (user_space_end)
+
+/** 用户空间结束地址 */
+extern qword user_space_end;
+
+/** 分页级数(4或5) */
+extern int paging_levels;
+
+/**
+ * @brief 地址空间
+ *
+ */
+typedef struct {
+    /** 顶级页表(PML4或PML5)物理地址 */
+    qword root;
+    /**
+     * @brief PCID上下文
+     * 低12位为PCID 其余位为分配该PCID时的世代
+     *
+     */
+    qword pcid_context;
+    /**
+     * @brief 可能缓存了该地址空间TLB项的CPU
+     * 未启用PCID时即为正在使用该地址空间的CPU
+     *
+     */
+    CPUMask cpumask;
+    /**
+     * @brief TLB世代
+     * 每次请求刷新该地址空间的TLB时递增
+     *
+     */
+    qword tlb_generation;
+    /** 虚拟内存区域链表(按地址升序) */
+    ListNode vmas;
+    /** 用户页可用的第一个缓存颜色 */
+    int color_first;
+    /** 用户页可用的缓存颜色数 为0时不着色 */
+    int color_num;
+    /** 下一次分配的颜色(相对color_first) */
+    int color_next;
+    /** 所有用户地址空间组成的链表 */
+    ListNode list;
+    /** 不持有链表锁遍历该地址空间的后台工作数 注销时等待其归零 */
+    int scanners;
+    /** 页回收下次开始扫描的地址 */
+    qword reclaim_cursor;
+    /** 保护页表与区域链表的锁 */
+    Spinlock lock;
+} AddressSpace;
+
+/** 内核地址空间 */
+extern AddressSpace kernel_address_space;
+
+/** 所有用户地址空间 */
+extern ListNode address_space_list;
+
+/** 保护用户地址空间链表的锁 */
+extern Spinlock address_space_list_lock;
+
+/**
+ * @brief 初始化虚拟内存管理
+ *
+ */
+void init_vmm(void);
+
+/**
+ * @brief 获取当前地址空间
+ *
+ * @return 当前地址空间
+ */
+AddressSpace *current_address_space(void);
+
+/**
+ * @brief 获取指定CPU正在使用的地址空间
+ *
+ * @param cpu CPU号
+ * @return 地址空间
+ */
+AddressSpace *cpu_address_space(int cpu);
+
+/**
+ * @brief 切换地址空间
+ *
+ * @param address_space 目标地址空间
+ */
+void switch_address_space(AddressSpace *address_space);
+
+/**
+ * @brief 登记用户地址空间
+ * 登记后内存整理等后台工作才能遍历其页表
+ *
+ * @param address_space 地址空间
+ */
+void register_address_space(AddressSpace *address_space);
+
+/**
+ * @brief 注销用户地址空间
+ * 返回后后台工作不再访问该地址空间
+ *
+ * @param address_space 地址空间
+ */
+void unregister_address_space(AddressSpace *address_space);
+
+/**
+ * @brief 引用链表中的地址空间
+ * 调用者需持有链表锁 之后可以释放链表锁遍历该地址空间
+ *
+ * @param address_space 地址空间
+ */
+void address_space_get(AddressSpace *address_space);
+
+/**
+ * @brief 释放address_space_get取得的引用
+ *
+ * @param address_space 地址空间
+ */
+void address_space_put(AddressSpace *address_space);
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * @file zero.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 预清零页池
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/zero.h>
+#include <mm/buddy.h>
+#include <sync/spinlock.h>
+
+/**
+ * @brief 预清零页池
+ *
+ */
+typedef struct {
+    /** 预清零页链表 */
+    ListNode list;
+    /** 锁 */
+    Spinlock lock;
+} ZeroPool;
+
+// 各节点的预清零页池
+static ZeroPool zero_pools[MAX_NUMA_NODES];
+
+/** 各节点预清零页池中的页数 */
+qword zero_pool_num[MAX_NUMA_NODES];
+
+/**
+ * @brief 用非临时存储清零一页
+ * 不经过缓存 避免清零时把有用的缓存行挤出
+ *
+ * @param page 页
+ */
+void clear_page_nocache(void *page) {
+    qword *ptr = page;
+    for (int i = 0 ; i < PAGE_SIZE / 8 ; i += 8) {
+        // 每次写满一条缓存行 写合并缓冲区可以整行写回
+        asm volatile (
+            "movnti %1, 0(%0)\n\t"
+            "movnti %1, 8(%0)\n\t"
+            "movnti %1, 16(%0)\n\t"
+            "movnti %1, 24(%0)\n\t"
+            "movnti %1, 32(%0)\n\t"
+            "movnti %1, 40(%0)\n\t"
+            "movnti %1, 48(%0)\n\t"
+            "movnti %1, 56(%0)"
+            : : "r"(ptr + i), "r"(0ull) : "memory");
+    }
+    // 非临时存储是弱序的 放入池之前必须全局可见
+    asm volatile ("sfence" : : : "memory");
+}
+
+/**
+ * @brief 从节点的预清零页池中取出一页
+ * 返回的页框引用计数为1
+ *
+ * @param node 节点号
+ * @return 页框 池为空时为NULL
+ */
+PageFrame *zero_pool_get(int node) {
+    // 无锁预检 池空时不必争用锁
+    if (__atomic_load_n(&zero_pool_num[node], __ATOMIC_RELAXED) == 0) {
+        return NULL;
+    }
+
+    ZeroPool *pool = &zero_pools[node];
+    spin_lock(&pool->lock);
+
+    if (list_empty(&pool->list)) {
+        spin_unlock(&pool->lock);
+        return NULL;
+    }
+
+    PageFrame *frame = list_entry(pool->list.next, PageFrame, list);
+    list_del(&frame->list);
+    zero_pool_num[node] --;
+
+    spin_unlock(&pool->lock);
+    return frame;
+}
+
+/**
+ * @brief 初始化预清零页池
+ *
+ */
+void init_zero_pool(void) {
+    for (int node = 0 ; node < MAX_NUMA_NODES ; node ++) {
+        list_init(&zero_pools[node].list);
+        zero_pools[node].lock = (Spinlock)SPINLOCK_INIT;
+        zero_pool_num[node] = 0;
+    }
+}
+
+/**
+ * @brief 补充当前节点的预清零页池
+ * 由空闲循环调用
+ * 池中的页不计入空闲页框 因此只在本节点空闲内存充足时补充
+ * 只使用本节点的页 避免远端页混入池中
+ *
+ * @return 是否做了工作
+ */
+bool zero_pool_refill(void) {
+    int node = current_node();
+    ZeroPool *pool = &zero_pools[node];
+    int count = 0;
+
+    while (count < ZERO_POOL_BATCH) {
+        qword pooled = __atomic_load_n(&zero_pool_num[node], __ATOMIC_RELAXED);
+        if (pooled >= ZERO_POOL_MAX || pooled >= zones[node].free_frame_num / 8) {
+            break;
+        }
+
+        PageFrame *frame = alloc_frames_node(node, 0, ALLOC_MOVABLE | ALLOC_THISNODE | ALLOC_NORECLAIM);
+        if (frame == NULL) {
+            break;
+        }
+
+        // 在锁外清零
+        clear_page_nocache(frame_to_ptr(frame));
+
+        spin_lock(&pool->lock);
+        list_add_tail(&pool->list, &frame->list);
+        zero_pool_num[node] ++;
+        spin_unlock(&pool->lock);
+
+        count ++;
+    }
+
+    return count != 0;
+}
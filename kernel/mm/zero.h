@@ -0,0 +1,55 @@
+/**
+ * @file zero.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 预清零页池
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+#include <mm/numa.h>
+
+/** 预清零页池的容量上限 */
+#define ZERO_POOL_MAX   (1024)
+/** 空闲时每轮最多清零的页数 */
+#define ZERO_POOL_BATCH (8)
+
+/** 各节点预清零页池中的页数 */
+extern qword zero_pool_num[MAX_NUMA_NODES];
+
+/**
+ * @brief 初始化预清零页池
+ *
+ */
+void init_zero_pool(void);
+
+/**
+ * @brief 用非临时存储清零一页
+ * 不经过缓存 避免清零时把有用的缓存行挤出
+ *
+ * @param page 页
+ */
+void clear_page_nocache(void *page);
+
+/**
+ * @brief 从节点的预清零页池中取出一页
+ * 返回的页框引用计数为1
+ *
+ * @param node 节点号
+ * @return 页框 池为空时为NULL
+ */
+PageFrame *zero_pool_get(int node);
+
+/**
+ * @brief 补充当前节点的预清零页池
+ * 由空闲循环调用
+ *
+ * @return 是否做了工作
+ */
+bool zero_pool_refill(void);
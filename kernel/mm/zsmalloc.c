@@ -0,0 +1,309 @@
+/**
+ * @file zsmalloc.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 压缩对象的紧凑存储池
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/zsmalloc.h>
+#include <mm/buddy.h>
+#include <mm/slab.h>
+#include <mm/direct_map.h>
+#include <lib/list.h>
+#include <sync/spinlock.h>
+#include <string.h>
+
+/** 空闲链表结束 */
+#define ZS_FREE_END (0xFFFFFFFF)
+
+/**
+ * @brief 一组存放同一大小类对象的页框
+ * 空闲对象的前4字节为下一个空闲对象的序号
+ *
+ */
+typedef struct {
+    /** 在大小类链表中的节点 */
+    ListNode list;
+    /** 大小类 */
+    int class_idx;
+    /** 已分配的对象数 */
+    dword inuse;
+    /** 第一个空闲对象的序号 */
+    dword free_idx;
+    /** 页框 */
+    PageFrame *pages[ZS_MAX_PAGES];
+} ZSPage;
+
+/**
+ * @brief 大小类
+ *
+ */
+typedef struct {
+    /** 对象大小 */
+    dword size;
+    /** 每个zspage的页框数 */
+    int pages_per_zspage;
+    /** 每个zspage的对象数 */
+    dword objects;
+    /** 有空闲对象的zspage */
+    ListNode partial;
+    /** 已满的zspage */
+    ListNode full;
+    /** 锁 */
+    Spinlock lock;
+} SizeClass;
+
+/** 池占用的页框数 */
+qword zs_pool_pages = 0;
+
+// 大小类 第i类的对象大小为(i + 1) * ZS_ALIGN
+static SizeClass size_classes[ZS_CLASS_NUM];
+// zspage描述符
+static KMemCache zspage_cache;
+
+/**
+ * @brief 初始化存储池
+ * 为每个大小类选择浪费比例最小的zspage页框数
+ *
+ */
+void init_zsmalloc(void) {
+    kmem_cache_init(&zspage_cache, "zspage", sizeof(ZSPage));
+
+    for (int i = 0 ; i < ZS_CLASS_NUM ; i ++) {
+        SizeClass *class = &size_classes[i];
+        class->size = (i + 1) * ZS_ALIGN;
+
+        // 比较 waste / (pages * PAGE_SIZE) 交叉相乘避免除法
+        qword best_waste = PAGE_SIZE;
+        int best_pages = 1;
+        for (int pages = 1 ; pages <= ZS_MAX_PAGES ; pages ++) {
+            qword waste = (pages * PAGE_SIZE) % class->size;
+            if (waste * best_pages < best_waste * pages) {
+                best_waste = waste;
+                best_pages = pages;
+            }
+        }
+
+        class->pages_per_zspage = best_pages;
+        class->objects = best_pages * PAGE_SIZE / class->size;
+        list_init(&class->partial);
+        list_init(&class->full);
+        class->lock = (Spinlock)SPINLOCK_INIT;
+    }
+}
+
+/**
+ * @brief 由句柄得到zspage
+ *
+ * @param handle 句柄
+ * @return zspage
+ */
+static inline ZSPage *handle_to_zspage(qword handle) {
+    return phys_to_virt(handle >> ZS_INDEX_BITS);
+}
+
+/**
+ * @brief 由句柄得到对象序号
+ *
+ * @param handle 句柄
+ * @return 对象序号
+ */
+static inline dword handle_to_index(qword handle) {
+    return handle & ((1 << ZS_INDEX_BITS) - 1);
+}
+
+/**
+ * @brief 对象的空闲链表字段
+ * 对象大小与页大小都是ZS_ALIGN的倍数 该字段不会跨越页框
+ *
+ * @param zspage zspage
+ * @param index 对象序号
+ * @return 字段地址
+ */
+static inline dword *free_link(ZSPage *zspage, dword index) {
+    qword offset = (qword)index * size_classes[zspage->class_idx].size;
+    return (dword *)((byte *)frame_to_ptr(zspage->pages[offset / PAGE_SIZE]) + offset % PAGE_SIZE);
+}
+
+/**
+ * @brief 释放zspage及其页框
+ *
+ * @param zspage zspage
+ * @param pages 页框数
+ */
+static void free_zspage(ZSPage *zspage, int pages) {
+    for (int i = 0 ; i < pages ; i ++) {
+        free_frames(zspage->pages[i], 0);
+    }
+    __atomic_fetch_sub(&zs_pool_pages, pages, __ATOMIC_RELAXED);
+    kmem_cache_free(&zspage_cache, zspage);
+}
+
+/**
+ * @brief 新建zspage 所有对象串入空闲链表
+ * 页框只需逐个分配 不要求连续
+ *
+ * @param class_idx 大小类
+ * @return zspage 失败时为NULL
+ */
+static ZSPage *new_zspage(int class_idx) {
+    SizeClass *class = &size_classes[class_idx];
+
+    ZSPage *zspage = kmem_cache_alloc(&zspage_cache);
+    if (zspage == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0 ; i < class->pages_per_zspage ; i ++) {
+        zspage->pages[i] = alloc_frames_node(current_node(), 0, ALLOC_NORECLAIM);
+        if (zspage->pages[i] == NULL) {
+            free_zspage(zspage, i);
+            return NULL;
+        }
+        __atomic_fetch_add(&zs_pool_pages, 1, __ATOMIC_RELAXED);
+    }
+
+    zspage->class_idx = class_idx;
+    zspage->inuse = 0;
+    zspage->free_idx = 0;
+    for (dword i = 0 ; i < class->objects ; i ++) {
+        *free_link(zspage, i) = i + 1 < class->objects ? i + 1 : ZS_FREE_END;
+    }
+
+    return zspage;
+}
+
+/**
+ * @brief 分配对象
+ * 对象按大小类放入由若干不必连续的页框组成的zspage 可以跨越页框边界
+ * 只能经zs_write/zs_read访问
+ *
+ * @param size 大小(不超过PAGE_SIZE)
+ * @return 句柄 失败时为0
+ */
+qword zs_malloc(dword size) {
+    if (size == 0 || size > PAGE_SIZE) {
+        return 0;
+    }
+
+    int class_idx = (size + ZS_ALIGN - 1) / ZS_ALIGN - 1;
+    SizeClass *class = &size_classes[class_idx];
+
+    spin_lock(&class->lock);
+
+    if (list_empty(&class->partial)) {
+        // 分配页框时不持有锁
+        spin_unlock(&class->lock);
+        ZSPage *zspage = new_zspage(class_idx);
+        if (zspage == NULL) {
+            return 0;
+        }
+        spin_lock(&class->lock);
+        list_add(&class->partial, &zspage->list);
+    }
+
+    ZSPage *zspage = list_entry(class->partial.next, ZSPage, list);
+    dword index = zspage->free_idx;
+    zspage->free_idx = *free_link(zspage, index);
+    zspage->inuse ++;
+
+    if (zspage->free_idx == ZS_FREE_END) {
+        list_del(&zspage->list);
+        list_add(&class->full, &zspage->list);
+    }
+
+    spin_unlock(&class->lock);
+
+    return (virt_to_phys(zspage) << ZS_INDEX_BITS) | index;
+}
+
+/**
+ * @brief 释放对象
+ *
+ * @param handle 句柄
+ */
+void zs_free(qword handle) {
+    ZSPage *zspage = handle_to_zspage(handle);
+    dword index = handle_to_index(handle);
+    SizeClass *class = &size_classes[zspage->class_idx];
+
+    spin_lock(&class->lock);
+
+    if (zspage->free_idx == ZS_FREE_END) {
+        list_del(&zspage->list);
+        list_add(&class->partial, &zspage->list);
+    }
+
+    *free_link(zspage, index) = zspage->free_idx;
+    zspage->free_idx = index;
+    zspage->inuse --;
+
+    if (zspage->inuse == 0) {
+        list_del(&zspage->list);
+        spin_unlock(&class->lock);
+        free_zspage(zspage, class->pages_per_zspage);
+        return;
+    }
+
+    spin_unlock(&class->lock);
+}
+
+/**
+ * @brief 在对象与缓冲区之间复制 逐页处理跨越页框边界的对象
+ *
+ * @param handle 句柄
+ * @param buffer 缓冲区
+ * @param size 大小
+ * @param write 是否写入对象
+ */
+static void zs_copy(qword handle, void *buffer, dword size, bool write) {
+    ZSPage *zspage = handle_to_zspage(handle);
+    qword offset = (qword)handle_to_index(handle) * size_classes[zspage->class_idx].size;
+    byte *cursor = buffer;
+
+    while (size > 0) {
+        byte *object = (byte *)frame_to_ptr(zspage->pages[offset / PAGE_SIZE]) + offset % PAGE_SIZE;
+        dword chunk = PAGE_SIZE - offset % PAGE_SIZE;
+        if (chunk > size) {
+            chunk = size;
+        }
+
+        if (write) {
+            memcpy(object, cursor, chunk);
+        }
+        else {
+            memcpy(cursor, object, chunk);
+        }
+
+        cursor += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+/**
+ * @brief 写入对象
+ *
+ * @param handle 句柄
+ * @param buffer 数据
+ * @param size 大小(不超过对象大小)
+ */
+void zs_write(qword handle, const void *buffer, dword size) {
+    zs_copy(handle, (void *)buffer, size, true);
+}
+
+/**
+ * @brief 读出对象
+ *
+ * @param handle 句柄
+ * @param buffer 缓冲区
+ * @param size 大小(不超过对象大小)
+ */
+void zs_read(qword handle, void *buffer, dword size) {
+    zs_copy(handle, buffer, size, false);
+}
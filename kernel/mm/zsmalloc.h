@@ -0,0 +1,68 @@
+/**
+ * @file zsmalloc.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 压缩对象的紧凑存储池
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+
+/** 大小类的粒度 */
+#define ZS_ALIGN (32)
+/** 大小类数 最大的类为PAGE_SIZE */
+#define ZS_CLASS_NUM (PAGE_SIZE / ZS_ALIGN)
+/** 每个zspage最多由这么多个页框组成 */
+#define ZS_MAX_PAGES (4)
+/** 句柄中对象序号的位数 */
+#define ZS_INDEX_BITS (10)
+
+/** 池占用的页框数 */
+extern qword zs_pool_pages;
+
+/**
+ * @brief 初始化存储池
+ *
+ */
+void init_zsmalloc(void);
+
+/**
+ * @brief 分配对象
+ * 对象按大小类放入由若干不必连续的页框组成的zspage 可以跨越页框边界
+ * 只能经zs_write/zs_read访问
+ *
+ * @param size 大小(不超过PAGE_SIZE)
+ * @return 句柄 失败时为0
+ */
+qword zs_malloc(dword size);
+
+/**
+ * @brief 释放对象
+ *
+ * @param handle 句柄
+ */
+void zs_free(qword handle);
+
+/**
+ * @brief 写入对象
+ *
+ * @param handle 句柄
+ * @param buffer 数据
+ * @param size 大小(不超过对象大小)
+ */
+void zs_write(qword handle, const void *buffer, dword size);
+
+/**
+ * @brief 读出对象
+ *
+ * @param handle 句柄
+ * @param buffer 缓冲区
+ * @param size 大小(不超过对象大小)
+ */
+void zs_read(qword handle, void *buffer, dword size);
@@ -0,0 +1,256 @@
+/**
+ * @file zswap.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 换出页的压缩缓存
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <mm/zswap.h>
+#include <mm/zsmalloc.h>
+#include <mm/buddy.h>
+#include <mm/slab.h>
+#include <mm/direct_map.h>
+#include <lib/lz4.h>
+#include <cpu/cpu.h>
+#include <sync/spinlock.h>
+#include <basec/logger.h>
+
+/**
+ * @brief 压缩缓存项
+ * 槽号为其物理地址
+ *
+ */
+typedef struct {
+    /** 压缩数据的句柄 */
+    qword handle;
+    /** 压缩数据长度 为0时整页由value填充 */
+    dword length;
+    /** 引用计数 */
+    dword refcount;
+    /** 填充值 */
+    qword value;
+} ZswapEntry;
+
+/**
+ * @brief 压缩缓冲区
+ * 首次使用时分配 前部为压缩工作区 后部存放压缩数据
+ *
+ */
+typedef struct {
+    /** 缓冲区 */
+    byte *buffer;
+    /** 锁 */
+    Spinlock lock;
+} ZswapBuffer;
+
+// 压缩缓存项
+static KMemCache zswap_entry_cache;
+// 各CPU的压缩缓冲区
+static ZswapBuffer zswap_buffers[MAX_CPU_NUM];
+// 是否已初始化
+static bool zswap_initialized = false;
+
+// 保存的页数
+static qword zswap_stored_pages = 0;
+// 其中由同一值填充的页数
+static qword zswap_same_filled_pages = 0;
+
+/**
+ * @brief 初始化压缩缓存
+ * 需在init_slab之后调用
+ *
+ */
+void init_zswap(void) {
+    init_zsmalloc();
+    kmem_cache_init(&zswap_entry_cache, "zswap_entry", sizeof(ZswapEntry));
+    for (int cpu = 0 ; cpu < MAX_CPU_NUM ; cpu ++) {
+        zswap_buffers[cpu].lock = (Spinlock)SPINLOCK_INIT;
+    }
+    zswap_initialized = true;
+
+    log_info("zswap: LZ4压缩 池上限为内存的%d%%", ZSWAP_MAX_POOL_PERCENT);
+}
+
+/**
+ * @brief 压缩缓存是否可用
+ *
+ * @return 是否可用
+ */
+bool zswap_enabled(void) {
+    return zswap_initialized;
+}
+
+/**
+ * @brief 取得并锁住本CPU的压缩缓冲区
+ * 回收路径上调用 不能再进入回收
+ *
+ * @return 缓冲区 分配失败时为NULL
+ */
+static ZswapBuffer *get_buffer(void) {
+    ZswapBuffer *buffer = &zswap_buffers[current_cpu_id()];
+
+    spin_lock(&buffer->lock);
+    if (buffer->buffer == NULL) {
+        PageFrame *frame = alloc_frames_node(current_node(), ZSWAP_BUFFER_ORDER, ALLOC_NORECLAIM | ALLOC_NOCOMPACT);
+        if (frame == NULL) {
+            spin_unlock(&buffer->lock);
+            return NULL;
+        }
+        buffer->buffer = frame_to_ptr(frame);
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief 页是否全部由同一个值填充
+ *
+ * @param page 页
+ * @param value 返回填充值
+ * @return 是否
+ */
+static bool page_same_filled(qword *page, qword *value) {
+    for (int i = 1 ; i < PAGE_SIZE / sizeof(qword) ; i ++) {
+        if (page[i] != page[0]) {
+            return false;
+        }
+    }
+    *value = page[0];
+    return true;
+}
+
+/**
+ * @brief 压缩保存一页
+ * 全部由同一值填充的页只记录该值
+ *
+ * @param frame 页框(已解除映射且TLB已刷新)
+ * @param slot 返回槽号
+ * @return 是否成功 不可压缩或池已满时失败
+ */
+bool zswap_store(PageFrame *frame, qword *slot) {
+    if (! zswap_initialized) {
+        return false;
+    }
+
+    ZswapEntry *entry = kmem_cache_alloc(&zswap_entry_cache);
+    if (entry == NULL) {
+        return false;
+    }
+    entry->refcount = 1;
+
+    qword *page = frame_to_ptr(frame);
+    if (page_same_filled(page, &entry->value)) {
+        entry->handle = 0;
+        entry->length = 0;
+        __atomic_fetch_add(&zswap_same_filled_pages, 1, __ATOMIC_RELAXED);
+        goto stored;
+    }
+
+    if (zs_pool_pages >= frame_num * ZSWAP_MAX_POOL_PERCENT / 100) {
+        goto reject;
+    }
+
+    ZswapBuffer *buffer = get_buffer();
+    if (buffer == NULL) {
+        goto reject;
+    }
+
+    // 输出缓冲区只给ZSWAP_MAX_COMPRESSED 压缩不动的页提前放弃
+    byte *compressed = buffer->buffer + LZ4_WORKMEM_SIZE;
+    int length = lz4_compress((byte *)page, PAGE_SIZE, compressed, ZSWAP_MAX_COMPRESSED, buffer->buffer);
+    if (length == 0) {
+        spin_unlock(&buffer->lock);
+        goto reject;
+    }
+
+    entry->handle = zs_malloc(length);
+    if (entry->handle == 0) {
+        spin_unlock(&buffer->lock);
+        goto reject;
+    }
+    zs_write(entry->handle, compressed, length);
+    entry->length = length;
+
+    spin_unlock(&buffer->lock);
+
+stored:
+    __atomic_fetch_add(&zswap_stored_pages, 1, __ATOMIC_RELAXED);
+    *slot = virt_to_phys(entry);
+    return true;
+
+reject:
+    kmem_cache_free(&zswap_entry_cache, entry);
+    return false;
+}
+
+/**
+ * @brief 解压读回一页
+ *
+ * @param slot 槽号
+ * @param frame 目标页框
+ * @return 是否成功
+ */
+bool zswap_load(qword slot, PageFrame *frame) {
+    ZswapEntry *entry = phys_to_virt(slot);
+    qword *page = frame_to_ptr(frame);
+
+    if (entry->length == 0) {
+        for (int i = 0 ; i < PAGE_SIZE / sizeof(qword) ; i ++) {
+            page[i] = entry->value;
+        }
+        return true;
+    }
+
+    ZswapBuffer *buffer = get_buffer();
+    if (buffer == NULL) {
+        return false;
+    }
+
+    byte *compressed = buffer->buffer + LZ4_WORKMEM_SIZE;
+    zs_read(entry->handle, compressed, entry->length);
+    int length = lz4_decompress(compressed, entry->length, (byte *)page, PAGE_SIZE);
+
+    spin_unlock(&buffer->lock);
+
+    if (length != PAGE_SIZE) {
+        log_error("zswap: 槽%p的压缩数据损坏", slot);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 增加槽的引用
+ *
+ * @param slot 槽号
+ */
+void zswap_dup(qword slot) {
+    ZswapEntry *entry = phys_to_virt(slot);
+    __atomic_fetch_add(&entry->refcount, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 释放对槽的引用 最后一个引用释放时回收压缩数据
+ *
+ * @param slot 槽号
+ */
+void zswap_release(qword slot) {
+    ZswapEntry *entry = phys_to_virt(slot);
+    if (__atomic_sub_fetch(&entry->refcount, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    if (entry->length == 0) {
+        __atomic_fetch_sub(&zswap_same_filled_pages, 1, __ATOMIC_RELAXED);
+    }
+    else {
+        zs_free(entry->handle);
+    }
+    __atomic_fetch_sub(&zswap_stored_pages, 1, __ATOMIC_RELAXED);
+    kmem_cache_free(&zswap_entry_cache, entry);
+}
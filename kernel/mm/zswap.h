@@ -0,0 +1,69 @@
+/**
+ * @file zswap.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 换出页的压缩缓存
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <mm/frame.h>
+
+/** 压缩池最多占用的内存比例(%) */
+#define ZSWAP_MAX_POOL_PERCENT (20)
+/** 压缩后超过该大小的页不值得保存 交给换出设备 */
+#define ZSWAP_MAX_COMPRESSED (PAGE_SIZE * 7 / 8)
+/** 各CPU压缩缓冲区的阶数 */
+#define ZSWAP_BUFFER_ORDER (2)
+
+/**
+ * @brief 初始化压缩缓存
+ * 需在init_slab之后调用
+ *
+ */
+void init_zswap(void);
+
+/**
+ * @brief 压缩缓存是否可用
+ *
+ * @return 是否可用
+ */
+bool zswap_enabled(void);
+
+/**
+ * @brief 压缩保存一页
+ * 全部由同一值填充的页只记录该值
+ *
+ * @param frame 页框(已解除映射且TLB已刷新)
+ * @param slot 返回槽号
+ * @return 是否成功 不可压缩或池已满时失败
+ */
+bool zswap_store(PageFrame *frame, qword *slot);
+
+/**
+ * @brief 解压读回一页
+ *
+ * @param slot 槽号
+ * @param frame 目标页框
+ * @return 是否成功
+ */
+bool zswap_load(qword slot, PageFrame *frame);
+
+/**
+ * @brief 增加槽的引用
+ *
+ * @param slot 槽号
+ */
+void zswap_dup(qword slot);
+
+/**
+ * @brief 释放对槽的引用 最后一个引用释放时回收压缩数据
+ *
+ * @param slot 槽号
+ */
+void zswap_release(qword slot);
@@ -0,0 +1,284 @@
+/**
+ * @file balance.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 负载均衡
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/sched.h>
+#include <cpu/cpu.h>
+#include <mm/numa.h>
+
+/**
+ * @brief 包含两个CPU的最近的调度域
+ *
+ * @param cpu1 CPU号
+ * @param cpu2 CPU号
+ * @return 调度域
+ */
+static SchedDomain cpu_domain(int cpu1, int cpu2) {
+    if (cpus_share_cache(cpu1, cpu2)) {
+        return SCHED_DOMAIN_LLC;
+    }
+    if (cpu_to_node(cpu1) == cpu_to_node(cpu2)) {
+        return SCHED_DOMAIN_NODE;
+    }
+    return SCHED_DOMAIN_ALL;
+}
+
+/**
+ * @brief 为线程挑选CPU
+ * 在亲和集合内的在线CPU中选负载最轻的 负载相同时优先与当前CPU共享缓存的
+ *
+ * @param thread 线程
+ * @return CPU号
+ */
+int select_thread_cpu(Thread *thread) {
+    int this_cpu = current_cpu_id();
+    int best = -1;
+    int best_score = 0;
+
+    for_each_cpu(cpu, thread->affinity & cpu_online_mask) {
+        int score = rq_load(&runqueues[cpu]) * SCHED_DOMAIN_NUM + cpu_domain(this_cpu, cpu);
+        if (best < 0 || score < best_score) {
+            best = cpu;
+            best_score = score;
+        }
+    }
+
+    return best < 0 ? this_cpu : best;
+}
+
+/**
+ * @brief 线程能否从src迁到dst_cpu
+ * 调用者需持有src的锁
+ *
+ * @param src 线程所在的运行队列
+ * @param thread 就绪线程
+ * @param dst_cpu 目标CPU
+ * @return 能否迁移
+ */
+static bool can_migrate(RunQueue *src, Thread *thread, int dst_cpu) {
+    if (! cpumask_test(thread->affinity, dst_cpu)) {
+        return false;
+    }
+
+    // 刚运行过的线程的数据还在末级缓存里 不迁出缓存域
+    if (! cpus_share_cache(thread->cpu, dst_cpu) && src->clock - thread->last_ran < SCHED_CACHE_HOT_TICKS) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 把线程从src移到dst
+ * 调用者需持有两个运行队列的锁
+ *
+ * @param src 源运行队列
+ * @param dst 目标运行队列
+ * @param dst_cpu 目标CPU
+ * @param thread 就绪线程
+ */
+static void move_thread(RunQueue *src, RunQueue *dst, int dst_cpu, Thread *thread) {
+    dequeue_thread(src, thread);
+    thread->cpu = dst_cpu;
+    queue_thread(dst, thread);
+    dst->migrations ++;
+}
+
+/**
+ * @brief 从src_cpu的运行队列拉取线程 直到负载差不足2
+ * 负载差为1时迁移只会让两边互换 因而不迁
+ *
+ * @param this_cpu 当前CPU
+ * @param src_cpu 源CPU
+ * @return 拉取的线程数
+ */
+static int pull_threads(int this_cpu, int src_cpu) {
+    RunQueue *this = &runqueues[this_cpu];
+    RunQueue *src = &runqueues[src_cpu];
+    int moved = 0;
+
+    qword flags = local_irq_save();
+    spin_lock(&this->lock);
+    double_rq_lock(this, src);
+
+    // 从队头(等待最久 缓存最冷)开始找
+    list_for_each_safe(node, &src->queue) {
+        if (rq_load(src) - rq_load(this) < 2) {
+            break;
+        }
+
+        Thread *thread = list_entry(node, Thread, list);
+        if (can_migrate(src, thread, this_cpu)) {
+            move_thread(src, this, this_cpu, thread);
+            moved ++;
+        }
+    }
+
+    if (moved > 0 && (this->current->flags & THREAD_IDLE)) {
+        this_cpu_write(need_resched, true);
+    }
+
+    spin_unlock(&src->lock);
+    spin_unlock(&this->lock);
+    local_irq_restore(flags);
+    return moved;
+}
+
+/**
+ * @brief 在调度域中找负载最重的CPU
+ * 不持锁读取负载 只作估计
+ *
+ * @param this_cpu 当前CPU
+ * @param domain 调度域
+ * @param min_load 负载至少为该值
+ * @return CPU号 没有时为-1
+ */
+static int find_busiest_cpu(int this_cpu, SchedDomain domain, int min_load) {
+    int busiest = -1;
+    int busiest_load = min_load - 1;
+
+    for_each_cpu(cpu, cpu_online_mask) {
+        if (cpu == this_cpu || cpu_domain(this_cpu, cpu) > domain) {
+            continue;
+        }
+
+        RunQueue *rq = &runqueues[cpu];
+        int load = rq_load(rq);
+        if (rq->nr_ready > 0 && load > busiest_load) {
+            busiest = cpu;
+            busiest_load = load;
+        }
+    }
+    return busiest;
+}
+
+/**
+ * @brief 空闲的CPU从最忙的运行队列中窃取一个线程
+ * 由近到远依次在各调度域中寻找
+ *
+ * @return 是否窃取到线程
+ */
+bool idle_balance(void) {
+    if (cpu_num <= 1) {
+        return false;
+    }
+
+    int this_cpu = current_cpu_id();
+    for (int domain = SCHED_DOMAIN_LLC ; domain < SCHED_DOMAIN_NUM ; domain ++) {
+        // 只剩一个就绪线程且正在运行的是空闲线程的CPU马上会运行它 不必窃取
+        int busiest = find_busiest_cpu(this_cpu, domain, 2);
+        if (busiest >= 0 && pull_threads(this_cpu, busiest) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 周期负载均衡 在时钟中断中调用
+ * 各调度域按各自的间隔从最忙的运行队列拉取线程 直到负载差不足2
+ *
+ */
+void load_balance_tick(void) {
+    if (cpu_num <= 1) {
+        return;
+    }
+
+    int this_cpu = current_cpu_id();
+    RunQueue *rq = &runqueues[this_cpu];
+    qword interval = SCHED_BALANCE_INTERVAL;
+
+    for (int domain = SCHED_DOMAIN_LLC ; domain < SCHED_DOMAIN_NUM ; domain ++) {
+        // 各CPU错开均衡的时机 避免同时争抢同一个运行队列
+        if ((rq->clock + this_cpu) % interval == 0) {
+            int busiest = find_busiest_cpu(this_cpu, domain, rq_load(rq) + 2);
+            // 近的域中已拉到线程就不再跨远的域迁移
+            if (busiest >= 0 && pull_threads(this_cpu, busiest) > 0) {
+                return;
+            }
+        }
+        interval *= 4;
+    }
+}
+
+/**
+ * @brief 设置线程的亲和集合
+ * 线程所在CPU不在集合中时迁走 正在运行的线程在下次切换走后迁移
+ * EDF线程仍固定在预留带宽的CPU上 新集合在移出截止时间调度类时生效
+ *
+ * @param thread 线程
+ * @param mask CPU集合
+ * @return 是否成功(集合中没有在线CPU 或EDF线程预留带宽的CPU不在集合中时失败)
+ */
+bool set_thread_affinity(Thread *thread, CPUMask mask) {
+    if ((mask & cpu_online_mask) == 0 || (thread->flags & THREAD_IDLE)) {
+        return false;
+    }
+
+    while (true) {
+        qword flags;
+        RunQueue *rq = lock_thread_rq(thread, &flags);
+        int cpu = thread->cpu;
+
+        // EDF线程固定在预留带宽的CPU上 新集合在移出截止时间调度类时生效
+        if (thread->sched_class == &edf_sched_class) {
+            bool ok = cpumask_test(mask, thread->edf.bw_cpu);
+            if (ok) {
+                thread->edf.saved_affinity = mask;
+            }
+            spin_unlock_irqrestore(&rq->lock, flags);
+            return ok;
+        }
+        thread->affinity = mask;
+
+        // 待迁移的线程切换走后按新集合挑选CPU
+        if (cpumask_test(mask, cpu) || thread->state == THREAD_DEAD || (thread->flags & THREAD_MIGRATE)) {
+            spin_unlock_irqrestore(&rq->lock, flags);
+            return true;
+        }
+
+        if (thread->state == THREAD_RUNNING) {
+            spin_unlock_irqrestore(&rq->lock, flags);
+            resched_cpu(cpu);
+            return true;
+        }
+
+        int target = select_thread_cpu(thread);
+        RunQueue *dst = &runqueues[target];
+        // 暂时释放过锁时线程可能已变化 重来
+        if (double_rq_lock(rq, dst) && (thread->cpu != cpu || thread->state == THREAD_RUNNING ||
+            (thread->flags & THREAD_MIGRATE))) {
+            spin_unlock(&dst->lock);
+            spin_unlock_irqrestore(&rq->lock, flags);
+            continue;
+        }
+
+        if (thread->state == THREAD_READY) {
+            move_thread(rq, dst, target, thread);
+        }
+        else if (thread->state == THREAD_SLEEPING) {
+            // 唤醒时刻换算到目标运行队列的时钟
+            qword remaining = thread->wakeup > rq->clock ? thread->wakeup - rq->clock : 0;
+            list_del(&thread->list);
+            thread->wakeup = dst->clock + remaining;
+            thread->cpu = target;
+            list_add_tail(&dst->sleepers, &thread->list);
+        }
+
+        bool preempt = thread->state == THREAD_READY && check_preempt_thread(dst, thread);
+        spin_unlock(&dst->lock);
+        spin_unlock_irqrestore(&rq->lock, flags);
+
+        if (preempt) {
+            resched_cpu(target);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file clock.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 调度时钟
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/clock.h>
+#include <tay/cr.h>
+
+/** 换算系数的定点位数 */
+#define SCHED_CLOCK_SHIFT (32)
+
+// 纳秒 = (TSC - clock_base) * clock_mult >> SCHED_CLOCK_SHIFT 为0时尚未测定
+static qword clock_mult = 0;
+// 测定时的TSC
+static qword clock_base = 0;
+
+/**
+ * @brief 以测得的TSC频率初始化调度时钟
+ *
+ * @param tsc_frequency TSC每秒的计数
+ */
+void init_sched_clock(qword tsc_frequency) {
+    if (tsc_frequency == 0 || clock_mult != 0) {
+        return;
+    }
+
+    clock_base = rdtsc();
+    clock_mult = (NSEC_PER_SEC << SCHED_CLOCK_SHIFT) / tsc_frequency;
+}
+
+/**
+ * @brief 调度时钟
+ * 由TSC换算 各CPU的TSC视为同步 测定TSC频率前恒为0
+ *
+ * @return 自测定TSC频率起的纳秒数
+ */
+qword sched_clock(void) {
+    if (clock_mult == 0) {
+        return 0;
+    }
+
+    // 其它CPU的TSC可能略落后于测定时的值
+    qword tsc = rdtsc();
+    if (tsc <= clock_base) {
+        return 0;
+    }
+
+    // 乘积可能超过64位
+    unsigned __int128 cycles = tsc - clock_base;
+    return (qword)((cycles * clock_mult) >> SCHED_CLOCK_SHIFT);
+}
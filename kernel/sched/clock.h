@@ -0,0 +1,33 @@
+/**
+ * @file clock.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 调度时钟
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+
+/** 每秒的纳秒数 */
+#define NSEC_PER_SEC (1000000000ull)
+
+/**
+ * @brief 以测得的TSC频率初始化调度时钟
+ *
+ * @param tsc_frequency TSC每秒的计数
+ */
+void init_sched_clock(qword tsc_frequency);
+
+/**
+ * @brief 调度时钟
+ * 由TSC换算 各CPU的TSC视为同步 测定TSC频率前恒为0
+ *
+ * @return 自测定TSC频率起的纳秒数
+ */
+qword sched_clock(void);
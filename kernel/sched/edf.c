@@ -0,0 +1,429 @@
+/**
+ * @file edf.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 截止时间调度类(EDF)
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/sched.h>
+#include <sched/clock.h>
+
+// 各CPU上已预留的EDF带宽 准入控制保证不超过EDF_BW_LIMIT
+static qword edf_bandwidth[MAX_CPU_NUM];
+
+/**
+ * @brief 初始化截止时间运行队列
+ *
+ * @param edf 截止时间运行队列
+ */
+void init_edf_rq(EdfRunQueue *edf) {
+    edf->tree = (RBTree)RB_TREE_INIT;
+    list_init(&edf->throttled);
+    edf->nr_queued = 0;
+    edf->curr = NULL;
+}
+
+/**
+ * @brief 由树节点获得截止时间调度状态
+ *
+ * @param node 节点
+ * @return 截止时间调度状态
+ */
+static inline EdfEntity *edf_entity(RBNode *node) {
+    return rb_entry(node, EdfEntity, node);
+}
+
+/**
+ * @brief 在CPU上预留带宽
+ * 同一CPU上已为该线程预留的带宽会在随后释放 不重复计算
+ *
+ * @param cpu CPU号
+ * @param bandwidth 带宽
+ * @param old 将被释放的旧带宽
+ * @return 是否通过准入控制
+ */
+static bool edf_reserve(int cpu, qword bandwidth, qword old) {
+    qword total = __atomic_load_n(&edf_bandwidth[cpu], __ATOMIC_RELAXED);
+    do {
+        if (total - old + bandwidth > EDF_BW_LIMIT) {
+            return false;
+        }
+    } while (! __atomic_compare_exchange_n(&edf_bandwidth[cpu], &total, total + bandwidth, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+    return true;
+}
+
+/**
+ * @brief 释放线程预留的带宽
+ *
+ * @param entity 截止时间调度状态
+ */
+static void edf_release(EdfEntity *entity) {
+    if (entity->bw_cpu < 0) {
+        return;
+    }
+    __atomic_fetch_sub(&edf_bandwidth[entity->bw_cpu], entity->bandwidth, __ATOMIC_SEQ_CST);
+    entity->bw_cpu = -1;
+}
+
+/**
+ * @brief 开始新的周期 补满预算
+ *
+ * @param entity 截止时间调度状态
+ * @param start 周期开始的调度时钟
+ */
+static void edf_new_period(EdfEntity *entity, qword start) {
+    entity->abs_deadline = start + entity->deadline;
+    entity->remaining = entity->runtime;
+}
+
+/**
+ * @brief 当前周期结束的调度时钟 即下次补充预算的时刻
+ *
+ * @param entity 截止时间调度状态
+ * @return 调度时钟
+ */
+static inline qword edf_period_end(EdfEntity *entity) {
+    return entity->abs_deadline - entity->deadline + entity->period;
+}
+
+/**
+ * @brief 按截止时间插入树中
+ *
+ * @param edf 截止时间运行队列
+ * @param entity 截止时间调度状态
+ */
+static void insert_entity(EdfRunQueue *edf, EdfEntity *entity) {
+    RBNode **link = &edf->tree.root;
+    RBNode *parent = NULL;
+
+    while (*link != NULL) {
+        parent = *link;
+        if ((int64_t)(entity->abs_deadline - edf_entity(parent)->abs_deadline) < 0) {
+            link = &parent->left;
+        }
+        else {
+            link = &parent->right;
+        }
+    }
+
+    rb_link_node(&entity->node, parent, link);
+    rb_insert_color(&edf->tree, &entity->node, NULL);
+    edf->nr_queued ++;
+}
+
+/**
+ * @brief 限流到下一周期
+ *
+ * @param edf 截止时间运行队列
+ * @param entity 截止时间调度状态
+ */
+static void throttle_entity(EdfRunQueue *edf, EdfEntity *entity) {
+    entity->throttled = true;
+    list_add_tail(&edf->throttled, &entity->throttled_node);
+}
+
+/**
+ * @brief 就绪线程放入树中 预算已用完时限流
+ *
+ * @param edf 截止时间运行队列
+ * @param entity 截止时间调度状态
+ */
+static void queue_entity(EdfRunQueue *edf, EdfEntity *entity) {
+    if (entity->remaining <= 0) {
+        throttle_entity(edf, entity);
+    }
+    else {
+        insert_entity(edf, entity);
+    }
+}
+
+/**
+ * @brief 为正在运行的线程扣除预算
+ *
+ * @param edf 截止时间运行队列
+ * @return 预算是否已用完
+ */
+static bool update_curr(EdfRunQueue *edf) {
+    EdfEntity *curr = edf->curr;
+    if (curr == NULL) {
+        return false;
+    }
+
+    qword now = sched_clock();
+    int64_t delta = (int64_t)(now - curr->exec_start);
+    if (delta > 0) {
+        curr->exec_start = now;
+        curr->remaining -= delta;
+    }
+    return curr->remaining <= 0;
+}
+
+/**
+ * @brief 加入就绪线程
+ * 按CBS的规则 截止时间已过或以剩余预算运行到截止时间会超出带宽时开始新的周期
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void enqueue_edf(RunQueue *rq, Thread *thread) {
+    EdfEntity *entity = &thread->edf;
+    qword now = sched_clock();
+
+    if ((int64_t)(now - entity->abs_deadline) >= 0) {
+        edf_new_period(entity, now);
+    }
+    // 两边都是纳秒之积 秒级的参数就会超出64位
+    else if (entity->remaining > 0 &&
+        (unsigned __int128)entity->remaining * entity->deadline >
+        (unsigned __int128)(entity->abs_deadline - now) * entity->runtime) {
+        edf_new_period(entity, now);
+    }
+    queue_entity(&rq->edf, entity);
+}
+
+/**
+ * @brief 移出就绪线程
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void dequeue_edf(RunQueue *rq, Thread *thread) {
+    EdfEntity *entity = &thread->edf;
+    if (entity->throttled) {
+        list_del(&entity->throttled_node);
+        entity->throttled = false;
+    }
+    else {
+        rb_erase(&rq->edf.tree, &entity->node, NULL);
+        rq->edf.nr_queued --;
+    }
+}
+
+/**
+ * @brief 取出截止时间最早的线程
+ *
+ * @param rq 运行队列
+ * @return 线程 没有有预算的就绪线程时为NULL
+ */
+static Thread *pick_next_edf(RunQueue *rq) {
+    RBNode *first = rb_first(&rq->edf.tree);
+    if (first == NULL) {
+        return NULL;
+    }
+
+    EdfEntity *entity = edf_entity(first);
+    rb_erase(&rq->edf.tree, first, NULL);
+    rq->edf.nr_queued --;
+    rq->edf.curr = entity;
+    entity->exec_start = sched_clock();
+    return container_of(entity, Thread, edf);
+}
+
+/**
+ * @brief 正在运行的线程被切换走
+ * 退出的线程释放带宽
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @param queued 是否仍就绪
+ */
+static void put_prev_edf(RunQueue *rq, Thread *thread, bool queued) {
+    EdfEntity *entity = &thread->edf;
+
+    update_curr(&rq->edf);
+    rq->edf.curr = NULL;
+
+    if (queued) {
+        queue_entity(&rq->edf, entity);
+    }
+    else if (thread->state == THREAD_DEAD) {
+        edf_release(entity);
+    }
+}
+
+/**
+ * @brief 正在运行的线程改为截止时间调度类
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void set_curr_edf(RunQueue *rq, Thread *thread) {
+    EdfEntity *entity = &thread->edf;
+    qword now = sched_clock();
+
+    if ((int64_t)(now - entity->abs_deadline) >= 0) {
+        edf_new_period(entity, now);
+    }
+    rq->edf.curr = entity;
+    entity->exec_start = now;
+}
+
+/**
+ * @brief 线程被移出截止时间调度类 释放带宽并恢复原先的亲和集合
+ * 原先的集合包含预留带宽的CPU 线程不需要迁移
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void switched_from_edf(RunQueue *rq, Thread *thread) {
+    edf_release(&thread->edf);
+    thread->affinity = thread->edf.saved_affinity;
+}
+
+/**
+ * @brief 预算用完时重新调度 切换走后限流
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @return 是否需要重新调度
+ */
+static bool tick_edf(RunQueue *rq, Thread *thread) {
+    return update_curr(&rq->edf);
+}
+
+/**
+ * @brief 为周期已结束的限流线程补充预算
+ * 精度为一个时钟中断
+ *
+ * @param rq 运行队列
+ * @return 是否需要重新调度
+ */
+static bool periodic_edf(RunQueue *rq) {
+    EdfRunQueue *edf = &rq->edf;
+    qword now = sched_clock();
+    bool resched = false;
+
+    list_for_each_safe(node, &edf->throttled) {
+        EdfEntity *entity = list_entry(node, EdfEntity, throttled_node);
+        qword start = edf_period_end(entity);
+        if ((int64_t)(now - start) < 0) {
+            continue;
+        }
+
+        list_del(node);
+        entity->throttled = false;
+        edf_new_period(entity, start);
+        // 错过了整个周期时从现在开始
+        if ((int64_t)(now - entity->abs_deadline) >= 0) {
+            edf_new_period(entity, now);
+        }
+        insert_entity(edf, entity);
+        resched = resched || check_preempt_thread(rq, container_of(entity, Thread, edf));
+    }
+    return resched;
+}
+
+/**
+ * @brief 截止时间更早时抢占
+ *
+ * @param rq 运行队列
+ * @param thread 新就绪的线程
+ * @return 是否抢占
+ */
+static bool check_preempt_edf(RunQueue *rq, Thread *thread) {
+    if (thread->edf.throttled) {
+        return false;
+    }
+    return (int64_t)(thread->edf.abs_deadline - rq->current->edf.abs_deadline) < 0;
+}
+
+/** 截止时间调度类 */
+const SchedClass edf_sched_class = {
+    .name = "edf",
+    .enqueue = enqueue_edf,
+    .dequeue = dequeue_edf,
+    .pick_next = pick_next_edf,
+    .put_prev = put_prev_edf,
+    .set_curr = set_curr_edf,
+    .switched_from = switched_from_edf,
+    .tick = tick_edf,
+    .periodic = periodic_edf,
+    .check_preempt = check_preempt_edf
+};
+
+/**
+ * @brief 已在cpu上预留带宽后 把线程固定到该CPU并改为截止时间调度类
+ * 按CPU划分EDF线程 准入控制只需看单个CPU的带宽
+ *
+ * @param thread 线程
+ * @param cpu 预留了带宽的CPU
+ * @param runtime 每周期的运行时间(纳秒)
+ * @param deadline 相对截止时间(纳秒)
+ * @param period 周期(纳秒)
+ * @param bandwidth 带宽
+ * @return 是否成功
+ */
+static bool admit_edf_thread(Thread *thread, int cpu, qword runtime, qword deadline, qword period,
+    qword bandwidth) {
+    EdfEntity *entity = &thread->edf;
+    // 已是EDF线程时亲和集合已被固定 沿用最初保存的集合
+    CPUMask saved = thread->sched_class == &edf_sched_class ? entity->saved_affinity : thread->affinity;
+
+    if (! set_thread_affinity(thread, 1ull << cpu)) {
+        __atomic_fetch_sub(&edf_bandwidth[cpu], bandwidth, __ATOMIC_SEQ_CST);
+        return false;
+    }
+
+    qword flags;
+    // 原先的带宽由switched_from释放 已是EDF线程时其亲和集合也被恢复 需重新固定
+    RunQueue *rq = sched_detach_thread(thread, &flags);
+    thread->affinity = 1ull << cpu;
+    entity->saved_affinity = saved;
+    entity->runtime = runtime;
+    entity->deadline = deadline;
+    entity->period = period;
+    entity->bandwidth = bandwidth;
+    entity->bw_cpu = cpu;
+    entity->remaining = 0;
+    entity->abs_deadline = sched_clock();
+    thread->sched_class = &edf_sched_class;
+    sched_attach_thread(rq, thread, flags);
+    return true;
+}
+
+/**
+ * @brief 线程改为截止时间调度类
+ * 须满足0 < runtime <= deadline <= period 且能在亲和集合内的某个CPU上预留带宽
+ * 成功后线程固定在该CPU上
+ *
+ * @param thread 线程
+ * @param runtime 每周期的运行时间(纳秒)
+ * @param deadline 相对截止时间(纳秒)
+ * @param period 周期(纳秒)
+ * @return 是否通过准入控制
+ */
+bool set_thread_edf(Thread *thread, qword runtime, qword deadline, qword period) {
+    if (runtime == 0 || runtime > deadline || deadline > period || (thread->flags & THREAD_IDLE)) {
+        return false;
+    }
+
+    qword bandwidth = (runtime << EDF_BW_SHIFT) / period;
+    EdfEntity *entity = &thread->edf;
+
+    // 已是EDF线程时只在原CPU上修改参数 新旧带宽不重复计算
+    if (thread->sched_class == &edf_sched_class) {
+        int cpu = entity->bw_cpu;
+        if (! edf_reserve(cpu, bandwidth, entity->bandwidth)) {
+            return false;
+        }
+        return admit_edf_thread(thread, cpu, runtime, deadline, period, bandwidth);
+    }
+
+    // 先尝试线程所在的CPU 避免迁移
+    int cpu = thread->cpu;
+    if (cpumask_test(thread->affinity, cpu) && edf_reserve(cpu, bandwidth, 0)) {
+        return admit_edf_thread(thread, cpu, runtime, deadline, period, bandwidth);
+    }
+    for_each_cpu(other, thread->affinity & cpu_online_mask) {
+        if (other != cpu && edf_reserve(other, bandwidth, 0)) {
+            return admit_edf_thread(thread, other, runtime, deadline, period, bandwidth);
+        }
+    }
+    return false;
+}
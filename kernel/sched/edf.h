@@ -0,0 +1,77 @@
+/**
+ * @file edf.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 截止时间调度类(EDF)
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <lib/rbtree.h>
+#include <cpu/cpu.h>
+
+/** 带宽的定点位数 */
+#define EDF_BW_SHIFT (20)
+/** 每个CPU上可分配给EDF线程的带宽上限(95%) 余下的留给其它调度类 */
+#define EDF_BW_LIMIT ((95ull << EDF_BW_SHIFT) / 100)
+
+/**
+ * @brief 线程在截止时间调度类中的状态
+ * 每个周期内至多运行runtime 须在周期开始后的deadline内完成
+ * 预算按恒定带宽服务器(CBS)的规则补充 用完时限流到下一周期
+ *
+ */
+typedef struct {
+    /** 截止时间树中的节点 */
+    RBNode node;
+    /** 限流链表中的节点 */
+    ListNode throttled_node;
+    /** 每周期的运行时间(纳秒) */
+    qword runtime;
+    /** 相对截止时间(纳秒) */
+    qword deadline;
+    /** 周期(纳秒) */
+    qword period;
+    /** 带宽 runtime / period */
+    qword bandwidth;
+    /** 预留带宽的CPU 未预留时为-1 */
+    int bw_cpu;
+    /** 改为截止时间调度类前的亲和集合 移出该调度类时恢复 */
+    CPUMask saved_affinity;
+    /** 当前周期剩余的预算(纳秒) */
+    int64_t remaining;
+    /** 当前周期的绝对截止时间(调度时钟) */
+    qword abs_deadline;
+    /** 是否已用完预算 等待下一周期 */
+    bool throttled;
+    /** 本次开始运行的调度时钟 */
+    qword exec_start;
+} EdfEntity;
+
+/**
+ * @brief 每CPU的截止时间运行队列
+ *
+ */
+typedef struct {
+    /** 有预算的就绪线程 按绝对截止时间排序 */
+    RBTree tree;
+    /** 限流中的就绪线程 */
+    ListNode throttled;
+    /** 树中的线程数 */
+    int nr_queued;
+    /** 正在运行的EDF线程 */
+    EdfEntity *curr;
+} EdfRunQueue;
+
+/**
+ * @brief 初始化截止时间运行队列
+ *
+ * @param edf 截止时间运行队列
+ */
+void init_edf_rq(EdfRunQueue *edf);
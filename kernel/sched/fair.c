@@ -0,0 +1,595 @@
+/**
+ * @file fair.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 公平调度类(EEVDF)
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/sched.h>
+#include <sched/clock.h>
+
+// nice值到权重 相邻两级约差1.25倍 即CPU时间约差10%
+static const dword nice_weights[NICE_MAX - NICE_MIN + 1] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,
+    3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,
+    335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,
+    36,    29,    23,    18,    15
+};
+
+/**
+ * @brief 初始化线程的公平调度状态
+ *
+ * @param entity 线程的公平调度状态
+ */
+void init_fair_entity(FairEntity *entity) {
+    entity->weight = NICE_0_WEIGHT;
+    entity->nice = 0;
+    entity->vruntime = 0;
+    entity->deadline = 0;
+    entity->min_deadline = 0;
+    entity->slice = SCHED_BASE_SLICE;
+    entity->vlag = 0;
+    entity->exec_start = 0;
+    entity->sum_exec_runtime = 0;
+}
+
+/**
+ * @brief 初始化公平运行队列
+ *
+ * @param fair 公平运行队列
+ */
+void init_fair_rq(FairRunQueue *fair) {
+    fair->tree = (RBTree)RB_TREE_INIT;
+    fair->nr_queued = 0;
+    fair->min_vruntime = 0;
+    fair->avg_vruntime = 0;
+    fair->avg_load = 0;
+    fair->curr = NULL;
+}
+
+/**
+ * @brief 由树节点获得公平调度状态
+ *
+ * @param node 节点
+ * @return 公平调度状态
+ */
+static inline FairEntity *fair_entity(RBNode *node) {
+    return rb_entry(node, FairEntity, node);
+}
+
+/**
+ * @brief 虚拟时间a是否早于b 容许回绕
+ *
+ * @param a 虚拟时间
+ * @param b 虚拟时间
+ * @return 是否早于
+ */
+static inline bool vtime_before(qword a, qword b) {
+    return (int64_t)(a - b) < 0;
+}
+
+/**
+ * @brief 相对min_vruntime的虚拟运行时间
+ *
+ * @param fair 公平运行队列
+ * @param entity 公平调度状态
+ * @return 相对值
+ */
+static inline int64_t entity_key(FairRunQueue *fair, FairEntity *entity) {
+    return (int64_t)(entity->vruntime - fair->min_vruntime);
+}
+
+/**
+ * @brief 实际时间换算为线程的虚拟时间
+ *
+ * @param delta 实际时间(纳秒)
+ * @param entity 公平调度状态
+ * @return 虚拟时间
+ */
+static qword calc_delta_fair(qword delta, FairEntity *entity) {
+    if (entity->weight == NICE_0_WEIGHT) {
+        return delta;
+    }
+    return delta * NICE_0_WEIGHT / entity->weight;
+}
+
+/**
+ * @brief 重新计算树节点的子树最早虚拟截止时间
+ *
+ * @param node 节点
+ */
+static void augment_deadline(RBNode *node) {
+    FairEntity *entity = fair_entity(node);
+    qword min = entity->deadline;
+    if (node->left != NULL && vtime_before(fair_entity(node->left)->min_deadline, min)) {
+        min = fair_entity(node->left)->min_deadline;
+    }
+    if (node->right != NULL && vtime_before(fair_entity(node->right)->min_deadline, min)) {
+        min = fair_entity(node->right)->min_deadline;
+    }
+    entity->min_deadline = min;
+}
+
+/**
+ * @brief 加权的虚拟运行时间之和与权重之和 包括正在运行的线程
+ *
+ * @param fair 公平运行队列
+ * @param load 返回权重之和
+ * @return 相对min_vruntime的加权和
+ */
+static int64_t weighted_vruntime(FairRunQueue *fair, int64_t *load) {
+    int64_t avg = fair->avg_vruntime;
+    *load = fair->avg_load;
+
+    FairEntity *curr = fair->curr;
+    if (curr != NULL) {
+        avg += entity_key(fair, curr) * curr->weight;
+        *load += curr->weight;
+    }
+    return avg;
+}
+
+/**
+ * @brief 加权平均虚拟运行时间 即理想情况下各线程都应达到的虚拟时间
+ *
+ * @param fair 公平运行队列
+ * @return 平均虚拟运行时间
+ */
+static qword avg_vruntime(FairRunQueue *fair) {
+    int64_t load;
+    int64_t avg = weighted_vruntime(fair, &load);
+
+    if (load > 0) {
+        // 向下取整 使至少一个线程有资格
+        if (avg < 0) {
+            avg -= load - 1;
+        }
+        avg /= load;
+    }
+    return fair->min_vruntime + avg;
+}
+
+/**
+ * @brief 线程是否有资格运行 即虚拟运行时间不超过加权平均值(滞后量非负)
+ *
+ * @param fair 公平运行队列
+ * @param entity 公平调度状态
+ * @return 是否有资格
+ */
+static bool entity_eligible(FairRunQueue *fair, FairEntity *entity) {
+    int64_t load;
+    int64_t avg = weighted_vruntime(fair, &load);
+    return avg >= entity_key(fair, entity) * load;
+}
+
+/**
+ * @brief 推进min_vruntime 使相对值保持较小
+ *
+ * @param fair 公平运行队列
+ */
+static void update_min_vruntime(FairRunQueue *fair) {
+    FairEntity *curr = fair->curr;
+    RBNode *leftmost = rb_first(&fair->tree);
+    qword vruntime = fair->min_vruntime;
+
+    if (curr != NULL) {
+        vruntime = curr->vruntime;
+    }
+    if (leftmost != NULL) {
+        FairEntity *entity = fair_entity(leftmost);
+        if (curr == NULL || vtime_before(entity->vruntime, vruntime)) {
+            vruntime = entity->vruntime;
+        }
+    }
+
+    // 单调不减 基准变化后树中各线程的相对值同步变化
+    if (vtime_before(fair->min_vruntime, vruntime)) {
+        fair->avg_vruntime -= (int64_t)fair->avg_load * (int64_t)(vruntime - fair->min_vruntime);
+        fair->min_vruntime = vruntime;
+    }
+}
+
+/**
+ * @brief 按虚拟运行时间插入树中
+ *
+ * @param fair 公平运行队列
+ * @param entity 公平调度状态
+ */
+static void insert_entity(FairRunQueue *fair, FairEntity *entity) {
+    RBNode **link = &fair->tree.root;
+    RBNode *parent = NULL;
+    int64_t key = entity_key(fair, entity);
+
+    while (*link != NULL) {
+        parent = *link;
+        if (key < entity_key(fair, fair_entity(parent))) {
+            link = &parent->left;
+        }
+        else {
+            link = &parent->right;
+        }
+    }
+
+    entity->min_deadline = entity->deadline;
+    rb_link_node(&entity->node, parent, link);
+    rb_insert_color(&fair->tree, &entity->node, augment_deadline);
+
+    fair->avg_vruntime += key * entity->weight;
+    fair->avg_load += entity->weight;
+    fair->nr_queued ++;
+}
+
+/**
+ * @brief 从树中删除
+ *
+ * @param fair 公平运行队列
+ * @param entity 公平调度状态
+ */
+static void erase_entity(FairRunQueue *fair, FairEntity *entity) {
+    rb_erase(&fair->tree, &entity->node, augment_deadline);
+
+    fair->avg_vruntime -= entity_key(fair, entity) * entity->weight;
+    fair->avg_load -= entity->weight;
+    fair->nr_queued --;
+}
+
+/**
+ * @brief 为正在运行的线程记账
+ *
+ * @param fair 公平运行队列
+ * @return 是否用完了当前请求(此时已开始新的请求)
+ */
+static bool update_curr(FairRunQueue *fair) {
+    FairEntity *curr = fair->curr;
+    if (curr == NULL) {
+        return false;
+    }
+
+    qword now = sched_clock();
+    int64_t delta = (int64_t)(now - curr->exec_start);
+    if (delta <= 0) {
+        return false;
+    }
+
+    curr->exec_start = now;
+    curr->sum_exec_runtime += delta;
+    curr->vruntime += calc_delta_fair(delta, curr);
+    update_min_vruntime(fair);
+
+    if (vtime_before(curr->vruntime, curr->deadline)) {
+        return false;
+    }
+
+    curr->deadline = curr->vruntime + calc_delta_fair(curr->slice, curr);
+    return true;
+}
+
+/**
+ * @brief 记录离开运行队列时的滞后量
+ * 限制在两个请求之内 防止长时间睡眠攒下过多的补偿
+ *
+ * @param fair 公平运行队列
+ * @param entity 公平调度状态(仍计入平均值)
+ */
+static void update_entity_lag(FairRunQueue *fair, FairEntity *entity) {
+    int64_t lag = (int64_t)(avg_vruntime(fair) - entity->vruntime);
+    int64_t limit = (int64_t)calc_delta_fair(entity->slice * 2, entity);
+
+    if (lag > limit) {
+        lag = limit;
+    }
+    else if (lag < -limit) {
+        lag = -limit;
+    }
+    entity->vlag = lag;
+}
+
+/**
+ * @brief 按滞后量确定加入运行队列时的虚拟运行时间与截止时间
+ * 加入后平均值会向新线程移动 因此按权重放大滞后量 使加入后的滞后量保持原值
+ *
+ * @param fair 公平运行队列
+ * @param entity 公平调度状态
+ */
+static void place_entity(FairRunQueue *fair, FairEntity *entity) {
+    int64_t load;
+    weighted_vruntime(fair, &load);
+
+    int64_t lag = entity->vlag;
+    if (load > 0) {
+        lag = lag * (load + entity->weight) / load;
+    }
+
+    entity->vruntime = avg_vruntime(fair) - lag;
+    entity->deadline = entity->vruntime + calc_delta_fair(entity->slice, entity);
+}
+
+/**
+ * @brief 在有资格的线程中选虚拟截止时间最早的
+ * 树按虚拟运行时间排序 有资格的线程是中序的前缀 借助子树最早截止时间 复杂度为O(log n)
+ *
+ * @param fair 公平运行队列
+ * @return 公平调度状态 树为空时为NULL
+ */
+static FairEntity *pick_eevdf(FairRunQueue *fair) {
+    RBNode *node = fair->tree.root;
+    FairEntity *best = NULL;
+    RBNode *best_left = NULL;
+
+    while (node != NULL) {
+        FairEntity *entity = fair_entity(node);
+        // 该节点没有资格时 右子树也都没有资格
+        if (! entity_eligible(fair, entity)) {
+            node = node->left;
+            continue;
+        }
+
+        // 该节点与整个左子树都有资格
+        if (best == NULL || vtime_before(entity->deadline, best->deadline)) {
+            best = entity;
+        }
+        if (node->left != NULL && (best_left == NULL ||
+            vtime_before(fair_entity(node->left)->min_deadline, fair_entity(best_left)->min_deadline))) {
+            best_left = node->left;
+        }
+        node = node->right;
+    }
+
+    if (best == NULL) {
+        RBNode *leftmost = rb_first(&fair->tree);
+        return leftmost == NULL ? NULL : fair_entity(leftmost);
+    }
+
+    if (best_left == NULL || ! vtime_before(fair_entity(best_left)->min_deadline, best->deadline)) {
+        return best;
+    }
+
+    // 沿子树最早截止时间找到该线程
+    qword deadline = fair_entity(best_left)->min_deadline;
+    node = best_left;
+    while (fair_entity(node)->deadline != deadline) {
+        if (node->left != NULL && fair_entity(node->left)->min_deadline == deadline) {
+            node = node->left;
+        }
+        else {
+            node = node->right;
+        }
+    }
+    return fair_entity(node);
+}
+
+/**
+ * @brief 加入就绪线程
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void enqueue_fair(RunQueue *rq, Thread *thread) {
+    FairRunQueue *fair = &rq->fair;
+    update_curr(fair);
+    place_entity(fair, &thread->fair);
+    insert_entity(fair, &thread->fair);
+}
+
+/**
+ * @brief 移出就绪线程
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void dequeue_fair(RunQueue *rq, Thread *thread) {
+    FairRunQueue *fair = &rq->fair;
+    update_curr(fair);
+    update_entity_lag(fair, &thread->fair);
+    erase_entity(fair, &thread->fair);
+    update_min_vruntime(fair);
+}
+
+/**
+ * @brief 取出下一个要运行的线程
+ *
+ * @param rq 运行队列
+ * @return 线程 没有就绪线程时为NULL
+ */
+static Thread *pick_next_fair(RunQueue *rq) {
+    FairRunQueue *fair = &rq->fair;
+    FairEntity *entity = pick_eevdf(fair);
+    if (entity == NULL) {
+        return NULL;
+    }
+
+    // 正在运行的线程不在树中 由curr计入平均值
+    erase_entity(fair, entity);
+    fair->curr = entity;
+    entity->exec_start = sched_clock();
+    return container_of(entity, Thread, fair);
+}
+
+/**
+ * @brief 正在运行的线程被切换走
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @param queued 是否仍就绪
+ */
+static void put_prev_fair(RunQueue *rq, Thread *thread, bool queued) {
+    FairRunQueue *fair = &rq->fair;
+    FairEntity *entity = &thread->fair;
+
+    update_curr(fair);
+    if (! queued) {
+        update_entity_lag(fair, entity);
+    }
+
+    fair->curr = NULL;
+    if (queued) {
+        // 让出时推迟截止时间 排到其它有资格的线程之后
+        if (thread->flags & THREAD_YIELD) {
+            entity->deadline += calc_delta_fair(entity->slice, entity);
+        }
+        insert_entity(fair, entity);
+    }
+    update_min_vruntime(fair);
+}
+
+/**
+ * @brief 正在运行的线程改为公平调度类
+ * 按离开时的滞后量重新确定虚拟运行时间
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void set_curr_fair(RunQueue *rq, Thread *thread) {
+    FairRunQueue *fair = &rq->fair;
+    FairEntity *entity = &thread->fair;
+
+    place_entity(fair, entity);
+    fair->curr = entity;
+    entity->exec_start = sched_clock();
+}
+
+/**
+ * @brief 时钟中断中为正在运行的线程记账
+ * 用完当前请求且有其它就绪线程时重新调度
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @return 是否需要重新调度
+ */
+static bool tick_fair(RunQueue *rq, Thread *thread) {
+    return update_curr(&rq->fair) && rq->fair.nr_queued > 0;
+}
+
+/**
+ * @brief 新就绪的线程有资格且截止时间更早 或正在运行的线程已失去资格时抢占
+ *
+ * @param rq 运行队列
+ * @param thread 新就绪的线程
+ * @return 是否抢占
+ */
+static bool check_preempt_fair(RunQueue *rq, Thread *thread) {
+    FairRunQueue *fair = &rq->fair;
+    FairEntity *curr = fair->curr;
+    FairEntity *entity = &thread->fair;
+
+    if (update_curr(fair)) {
+        return true;
+    }
+    if (! entity_eligible(fair, entity)) {
+        return false;
+    }
+    return ! entity_eligible(fair, curr) || vtime_before(entity->deadline, curr->deadline);
+}
+
+/** 公平调度类 */
+const SchedClass fair_sched_class = {
+    .name = "fair",
+    .enqueue = enqueue_fair,
+    .dequeue = dequeue_fair,
+    .pick_next = pick_next_fair,
+    .put_prev = put_prev_fair,
+    .set_curr = set_curr_fair,
+    .switched_from = NULL,
+    .tick = tick_fair,
+    .periodic = NULL,
+    .check_preempt = check_preempt_fair
+};
+
+/**
+ * @brief 修改线程的权重与请求长度
+ * 就绪的线程先移出再以原滞后量重新加入
+ *
+ * @param thread 线程
+ * @param nice nice值
+ * @param slice 请求长度(纳秒)
+ */
+static void set_fair_params(Thread *thread, int nice, qword slice) {
+    qword flags;
+    RunQueue *rq = lock_thread_rq(thread, &flags);
+    FairEntity *entity = &thread->fair;
+
+    bool queued = thread->sched_class == &fair_sched_class && thread->state == THREAD_READY &&
+        ! (thread->flags & THREAD_MIGRATE);
+    if (queued) {
+        dequeue_fair(rq, thread);
+    }
+    else if (rq->fair.curr == entity) {
+        update_curr(&rq->fair);
+    }
+
+    entity->nice = nice;
+    entity->weight = nice_weights[nice - NICE_MIN];
+    entity->slice = slice;
+
+    if (queued) {
+        enqueue_fair(rq, thread);
+    }
+    spin_unlock_irqrestore(&rq->lock, flags);
+}
+
+/**
+ * @brief 线程改回公平调度类
+ *
+ * @param thread 线程
+ * @return 是否成功
+ */
+bool set_thread_fair(Thread *thread) {
+    if (thread->flags & THREAD_IDLE) {
+        return false;
+    }
+
+    qword flags;
+    RunQueue *rq = sched_detach_thread(thread, &flags);
+    thread->sched_class = &fair_sched_class;
+    sched_attach_thread(rq, thread, flags);
+    return true;
+}
+
+/**
+ * @brief 设置线程的nice值
+ *
+ * @param thread 线程
+ * @param nice nice值 NICE_MIN到NICE_MAX
+ * @return 是否成功
+ */
+bool set_thread_nice(Thread *thread, int nice) {
+    if (nice < NICE_MIN || nice > NICE_MAX || (thread->flags & THREAD_IDLE)) {
+        return false;
+    }
+
+    set_fair_params(thread, nice, thread->fair.slice);
+    return true;
+}
+
+/**
+ * @brief 设置线程的延迟目标
+ * 即公平调度类中每次请求的长度 越短等待越短 但切换越频繁
+ *
+ * @param thread 线程
+ * @param slice 请求长度(纳秒) 限制在SCHED_MIN_SLICE到SCHED_MAX_SLICE之间
+ * @return 是否成功
+ */
+bool set_thread_latency(Thread *thread, qword slice) {
+    if (thread->flags & THREAD_IDLE) {
+        return false;
+    }
+
+    if (slice < SCHED_MIN_SLICE) {
+        slice = SCHED_MIN_SLICE;
+    }
+    else if (slice > SCHED_MAX_SLICE) {
+        slice = SCHED_MAX_SLICE;
+    }
+
+    set_fair_params(thread, thread->fair.nice, slice);
+    return true;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file fair.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 公平调度类(EEVDF)
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <lib/rbtree.h>
+
+/** 最高的nice值 */
+#define NICE_MIN (-20)
+/** 最低的nice值 */
+#define NICE_MAX (19)
+/** nice为0时的权重 */
+#define NICE_0_WEIGHT (1024)
+
+/** 默认的请求长度(纳秒) 即延迟目标 */
+#define SCHED_BASE_SLICE (3000000ull)
+/** 请求长度下限(纳秒) */
+#define SCHED_MIN_SLICE  (100000ull)
+/** 请求长度上限(纳秒) */
+#define SCHED_MAX_SLICE  (100000000ull)
+
+/**
+ * @brief 线程在公平调度类中的状态
+ * 虚拟时间以纳秒计 按NICE_0_WEIGHT / weight的速率流逝
+ *
+ */
+typedef struct {
+    /** 公平运行队列的树中的节点 按虚拟运行时间排序 */
+    RBNode node;
+    /** 权重 */
+    dword weight;
+    /** nice值 */
+    int nice;
+    /** 虚拟运行时间 */
+    qword vruntime;
+    /** 虚拟截止时间 即当前请求结束时的虚拟运行时间 */
+    qword deadline;
+    /** 子树中最早的虚拟截止时间 */
+    qword min_deadline;
+    /** 请求长度(纳秒) 越短等待越短 但切换越频繁 */
+    qword slice;
+    /** 离开运行队列时的滞后量 再次加入时保持 */
+    int64_t vlag;
+    /** 本次开始运行的调度时钟 */
+    qword exec_start;
+    /** 累计运行时间(纳秒) */
+    qword sum_exec_runtime;
+} FairEntity;
+
+/**
+ * @brief 每CPU的公平运行队列
+ * 就绪线程的虚拟运行时间不超过加权平均值时有资格运行 在其中选虚拟截止时间最早的
+ *
+ */
+typedef struct {
+    /** 就绪线程(不含正在运行的) */
+    RBTree tree;
+    /** 就绪线程数 */
+    int nr_queued;
+    /** 虚拟运行时间的基准 单调不减 */
+    qword min_vruntime;
+    /** 树中线程(vruntime - min_vruntime) * weight之和 */
+    int64_t avg_vruntime;
+    /** 树中线程的权重之和 */
+    qword avg_load;
+    /** 正在运行的公平线程 */
+    FairEntity *curr;
+} FairRunQueue;
+
+/**
+ * @brief 初始化线程的公平调度状态
+ *
+ * @param entity 线程的公平调度状态
+ */
+void init_fair_entity(FairEntity *entity);
+
+/**
+ * @brief 初始化公平运行队列
+ *
+ * @param fair 公平运行队列
+ */
+void init_fair_rq(FairRunQueue *fair);
@@ -0,0 +1,8 @@
+objects += sched/sched.o
+objects += sched/thread.o
+objects += sched/switch.o
+objects += sched/balance.o
+objects += sched/clock.o
+objects += sched/fair.o
+objects += sched/rt.o
+objects += sched/edf.o
\ No newline at end of file
@@ -0,0 +1,92 @@
+/**
+ * @file preempt.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 抢占计数
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <cpu/percpu.h>
+#include <cpu/irqflags.h>
+
+/*
+ * 每CPU的抢占计数不为0时不会发生抢占
+ * 低16位为禁止抢占的嵌套层数(自旋锁各占一层) 其上为中断处理的嵌套层数
+ * 计数与need_resched都是每CPU变量 增减各只需一条GS相对指令
+ */
+
+/** 中断处理占用的计数 */
+#define HARDIRQ_OFFSET (1u << 16)
+/** 禁止抢占层数的掩码 */
+#define PREEMPT_MASK   (HARDIRQ_OFFSET - 1)
+
+/** 抢占计数 */
+DECLARE_PER_CPU(dword, preempt_count);
+/** 是否需要重新调度 */
+DECLARE_PER_CPU(bool, need_resched);
+
+/**
+ * @brief 抢占计数归零且需要重新调度时抢占当前线程
+ *
+ */
+void preempt_schedule(void);
+
+/**
+ * @brief 禁止抢占
+ *
+ */
+static inline void preempt_disable(void) {
+    this_cpu_inc(preempt_count);
+    asm volatile ("" : : : "memory");
+}
+
+/**
+ * @brief 允许抢占 但不检查是否需要重新调度
+ *
+ */
+static inline void preempt_enable_no_resched(void) {
+    asm volatile ("" : : : "memory");
+    this_cpu_dec(preempt_count);
+}
+
+/**
+ * @brief 允许抢占 计数归零时处理积压的重新调度请求
+ *
+ */
+static inline void preempt_enable(void) {
+    preempt_enable_no_resched();
+    if (this_cpu_read(preempt_count) == 0 && this_cpu_read(need_resched)) {
+        preempt_schedule();
+    }
+}
+
+/**
+ * @brief 是否处于中断处理中
+ *
+ * @return 是否处于中断处理中
+ */
+static inline bool in_interrupt(void) {
+    return this_cpu_read(preempt_count) >= HARDIRQ_OFFSET;
+}
+
+/**
+ * @brief 进入中断处理
+ *
+ */
+static inline void irq_enter(void) {
+    this_cpu_add(preempt_count, HARDIRQ_OFFSET);
+}
+
+/**
+ * @brief 退出中断处理
+ *
+ */
+static inline void irq_exit(void) {
+    this_cpu_sub(preempt_count, HARDIRQ_OFFSET);
+}
@@ -0,0 +1,219 @@
+/**
+ * @file rt.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 实时调度类(固定优先级FIFO/RR)
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/sched.h>
+
+/**
+ * @brief 初始化实时运行队列
+ *
+ * @param rt 实时运行队列
+ */
+void init_rt_rq(RtRunQueue *rt) {
+    for (int i = 0 ; i < RT_PRIO_NUM ; i ++) {
+        list_init(&rt->queues[i]);
+    }
+    for (int i = 0 ; i < RT_BITMAP_SIZE ; i ++) {
+        rt->bitmap[i] = 0;
+    }
+    rt->nr_queued = 0;
+}
+
+/**
+ * @brief 放入优先级队列
+ *
+ * @param rt 实时运行队列
+ * @param entity 实时调度状态
+ * @param head 是否放在队头(被抢占的线程仍最先运行)
+ */
+static void rt_queue(RtRunQueue *rt, RtEntity *entity, bool head) {
+    int priority = entity->priority;
+    if (head) {
+        list_add(&rt->queues[priority], &entity->node);
+    }
+    else {
+        list_add_tail(&rt->queues[priority], &entity->node);
+    }
+    rt->bitmap[priority / 64] |= 1ull << (priority % 64);
+    rt->nr_queued ++;
+}
+
+/**
+ * @brief 移出优先级队列
+ *
+ * @param rt 实时运行队列
+ * @param entity 实时调度状态
+ */
+static void rt_unqueue(RtRunQueue *rt, RtEntity *entity) {
+    int priority = entity->priority;
+    list_del(&entity->node);
+    if (list_empty(&rt->queues[priority])) {
+        rt->bitmap[priority / 64] &= ~(1ull << (priority % 64));
+    }
+    rt->nr_queued --;
+}
+
+/**
+ * @brief 最高的非空优先级
+ * 只需查找位图 与线程数无关
+ *
+ * @param rt 实时运行队列
+ * @return 优先级 没有就绪线程时为-1
+ */
+static int rt_highest_priority(RtRunQueue *rt) {
+    for (int i = RT_BITMAP_SIZE - 1 ; i >= 0 ; i --) {
+        if (rt->bitmap[i] != 0) {
+            return i * 64 + 63 - __builtin_clzll(rt->bitmap[i]);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 加入就绪线程 排在同优先级线程之后
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void enqueue_rt(RunQueue *rq, Thread *thread) {
+    rt_queue(&rq->rt, &thread->rt, false);
+}
+
+/**
+ * @brief 移出就绪线程
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void dequeue_rt(RunQueue *rq, Thread *thread) {
+    rt_unqueue(&rq->rt, &thread->rt);
+}
+
+/**
+ * @brief 取出最高优先级队列的队头
+ *
+ * @param rq 运行队列
+ * @return 线程 没有就绪线程时为NULL
+ */
+static Thread *pick_next_rt(RunQueue *rq) {
+    int priority = rt_highest_priority(&rq->rt);
+    if (priority < 0) {
+        return NULL;
+    }
+
+    RtEntity *entity = list_entry(rq->rt.queues[priority].next, RtEntity, node);
+    rt_unqueue(&rq->rt, entity);
+    return container_of(entity, Thread, rt);
+}
+
+/**
+ * @brief 正在运行的线程被切换走
+ * 被抢占的线程回到队头 让出或用完RR时间片的线程排到队尾
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @param queued 是否仍就绪
+ */
+static void put_prev_rt(RunQueue *rq, Thread *thread, bool queued) {
+    RtEntity *entity = &thread->rt;
+    if (! queued) {
+        return;
+    }
+
+    bool tail = (thread->flags & THREAD_YIELD) != 0;
+    if (entity->policy == RT_RR && entity->time_slice == 0) {
+        entity->time_slice = RT_RR_TIME_SLICE;
+        tail = true;
+    }
+    rt_queue(&rq->rt, entity, ! tail);
+}
+
+/**
+ * @brief 正在运行的线程改为实时调度类
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+static void set_curr_rt(RunQueue *rq, Thread *thread) {
+    if (thread->rt.time_slice == 0) {
+        thread->rt.time_slice = RT_RR_TIME_SLICE;
+    }
+}
+
+/**
+ * @brief RR线程用完时间片且有同优先级的就绪线程时重新调度
+ * 没有同优先级的线程时续上时间片
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @return 是否需要重新调度
+ */
+static bool tick_rt(RunQueue *rq, Thread *thread) {
+    RtEntity *entity = &thread->rt;
+    if (entity->policy != RT_RR || entity->time_slice == 0 || -- entity->time_slice > 0) {
+        return false;
+    }
+
+    if (! list_empty(&rq->rt.queues[entity->priority])) {
+        return true;
+    }
+    entity->time_slice = RT_RR_TIME_SLICE;
+    return false;
+}
+
+/**
+ * @brief 优先级更高时抢占
+ *
+ * @param rq 运行队列
+ * @param thread 新就绪的线程
+ * @return 是否抢占
+ */
+static bool check_preempt_rt(RunQueue *rq, Thread *thread) {
+    return thread->rt.priority > rq->current->rt.priority;
+}
+
+/** 实时调度类 */
+const SchedClass rt_sched_class = {
+    .name = "rt",
+    .enqueue = enqueue_rt,
+    .dequeue = dequeue_rt,
+    .pick_next = pick_next_rt,
+    .put_prev = put_prev_rt,
+    .set_curr = set_curr_rt,
+    .switched_from = NULL,
+    .tick = tick_rt,
+    .periodic = NULL,
+    .check_preempt = check_preempt_rt
+};
+
+/**
+ * @brief 线程改为实时调度类
+ *
+ * @param thread 线程
+ * @param policy 策略
+ * @param priority 优先级 RT_PRIO_MIN到RT_PRIO_MAX 越大越优先
+ * @return 是否成功
+ */
+bool set_thread_rt(Thread *thread, RtPolicy policy, int priority) {
+    if (priority < RT_PRIO_MIN || priority > RT_PRIO_MAX || (policy != RT_FIFO && policy != RT_RR) ||
+        (thread->flags & THREAD_IDLE)) {
+        return false;
+    }
+
+    qword flags;
+    RunQueue *rq = sched_detach_thread(thread, &flags);
+    thread->rt.policy = policy;
+    thread->rt.priority = priority;
+    thread->rt.time_slice = RT_RR_TIME_SLICE;
+    thread->sched_class = &rt_sched_class;
+    sched_attach_thread(rq, thread, flags);
+    return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file rt.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 实时调度类(固定优先级FIFO/RR)
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <lib/list.h>
+
+/** 实时优先级数 */
+#define RT_PRIO_NUM (100)
+/** 最低的实时优先级 */
+#define RT_PRIO_MIN (1)
+/** 最高的实时优先级 */
+#define RT_PRIO_MAX (RT_PRIO_NUM - 1)
+/** 优先级位图的四字数 */
+#define RT_BITMAP_SIZE ((RT_PRIO_NUM + 63) / 64)
+
+/** RR线程的时间片(时钟中断数) */
+#define RT_RR_TIME_SLICE (10)
+
+/**
+ * @brief 实时调度策略
+ *
+ */
+typedef enum {
+    /** 先进先出 一直运行到睡眠 让出或被更高优先级抢占 */
+    RT_FIFO = 0,
+    /** 轮转 同优先级的线程之间按时间片轮流 */
+    RT_RR
+} RtPolicy;
+
+/**
+ * @brief 线程在实时调度类中的状态
+ *
+ */
+typedef struct {
+    /** 所在优先级队列中的节点 */
+    ListNode node;
+    /** 优先级 越大越优先 */
+    int priority;
+    /** 策略 */
+    RtPolicy policy;
+    /** RR线程剩余的时间片(时钟中断数) */
+    dword time_slice;
+} RtEntity;
+
+/**
+ * @brief 每CPU的实时运行队列
+ * 每个优先级一个队列 位图中第i位表示优先级i的队列非空
+ *
+ */
+typedef struct {
+    /** 各优先级的就绪线程 */
+    ListNode queues[RT_PRIO_NUM];
+    /** 非空队列的位图 */
+    qword bitmap[RT_BITMAP_SIZE];
+    /** 就绪线程数 */
+    int nr_queued;
+} RtRunQueue;
+
+/**
+ * @brief 初始化实时运行队列
+ *
+ * @param rt 实时运行队列
+ */
+void init_rt_rq(RtRunQueue *rt);
@@ -0,0 +1,595 @@
+/**
+ * @file sched.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 调度器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/sched.h>
+#include <cpu/cpu.h>
+#include <cpu/apic.h>
+#include <cpu/interrupt.h>
+#include <cpu/gdt.h>
+#include <mm/kstack.h>
+#include <mm/tlb.h>
+#include <basec/logger.h>
+
+/** switch.S 切换到next 返回切换到本线程之前运行的线程 */
+extern Thread *switch_context(Thread *prev, Thread *next);
+
+/** 各CPU的运行队列 */
+RunQueue runqueues[MAX_CPU_NUM];
+
+// 调度类 按优先级从高到低
+static const SchedClass *const sched_classes[] = {
+    &edf_sched_class,
+    &rt_sched_class,
+    &fair_sched_class
+};
+
+/** 调度类数 */
+#define SCHED_CLASS_NUM (sizeof(sched_classes) / sizeof(sched_classes[0]))
+
+/** 抢占计数 */
+DEFINE_PER_CPU(dword, preempt_count);
+/** 是否需要重新调度 */
+DEFINE_PER_CPU(bool, need_resched);
+
+/**
+ * @brief 初始化CPU的运行队列 以idle为其空闲线程
+ *
+ * @param cpu CPU号
+ * @param idle 空闲线程
+ */
+void init_runqueue(int cpu, Thread *idle) {
+    RunQueue *rq = &runqueues[cpu];
+    rq->lock = (Spinlock)SPINLOCK_INIT;
+    list_init(&rq->queue);
+    list_init(&rq->sleepers);
+    rq->nr_ready = 0;
+    rq->clock = 0;
+    rq->switches = 0;
+    rq->migrations = 0;
+    init_edf_rq(&rq->edf);
+    init_rt_rq(&rq->rt);
+    init_fair_rq(&rq->fair);
+    rq->current = idle;
+    rq->idle = idle;
+
+    idle->state = THREAD_RUNNING;
+    idle->flags |= THREAD_IDLE;
+    idle->cpu = cpu;
+    idle->affinity = 1ull << cpu;
+    list_init(&idle->list);
+}
+
+/**
+ * @brief 时钟中断
+ *
+ * @param frame 中断现场
+ */
+static void timer_interrupt(InterruptFrame *frame) {
+    scheduler_tick();
+    load_balance_tick();
+}
+
+/**
+ * @brief 重新调度IPI
+ * 发送方已设置本CPU的need_resched 中断返回时即会调度
+ *
+ * @param frame 中断现场
+ */
+static void reschedule_interrupt(InterruptFrame *frame) {
+}
+
+/**
+ * @brief 初始化调度器
+ * 当前执行流成为0号CPU的空闲线程
+ *
+ */
+void init_sched(void) {
+    init_runqueue(0, current_thread());
+
+    register_interrupt_handler(APIC_TIMER_VECTOR, timer_interrupt);
+    register_interrupt_handler(RESCHEDULE_VECTOR, reschedule_interrupt);
+}
+
+/**
+ * @brief 启动当前CPU的时钟中断 此后开始抢占
+ *
+ */
+void sched_start(void) {
+    init_apic_timer(SCHED_HZ);
+    local_irq_enable();
+}
+
+/**
+ * @brief 请求CPU重新调度
+ * 其它CPU通过IPI通知
+ *
+ * @param cpu CPU号
+ */
+void resched_cpu(int cpu) {
+    if (cpu == current_cpu_id()) {
+        this_cpu_write(need_resched, true);
+        return;
+    }
+
+    per_cpu(need_resched, cpu) = true;
+    apic_send_ipi(cpu_apic_ids[cpu], RESCHEDULE_VECTOR);
+}
+
+/**
+ * @brief 把线程放到队尾
+ * 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+void queue_thread(RunQueue *rq, Thread *thread) {
+    thread->state = THREAD_READY;
+    list_add_tail(&rq->queue, &thread->list);
+    rq->nr_ready ++;
+    thread->sched_class->enqueue(rq, thread);
+}
+
+/**
+ * @brief 把就绪线程移出运行队列
+ * 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+void dequeue_thread(RunQueue *rq, Thread *thread) {
+    thread->sched_class->dequeue(rq, thread);
+    list_del(&thread->list);
+    rq->nr_ready --;
+}
+
+/**
+ * @brief 调度类的优先级 越小越高
+ *
+ * @param sched_class 调度类
+ * @return 优先级
+ */
+static int sched_class_rank(const SchedClass *sched_class) {
+    for (int i = 0 ; i < (int)SCHED_CLASS_NUM ; i ++) {
+        if (sched_classes[i] == sched_class) {
+            return i;
+        }
+    }
+    return SCHED_CLASS_NUM;
+}
+
+/**
+ * @brief 新就绪的线程是否应抢占运行队列中正在运行的线程
+ * 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @return 是否抢占
+ */
+bool check_preempt_thread(RunQueue *rq, Thread *thread) {
+    // 限流中的EDF线程要等到下一周期才能被选中 不能抢占任何线程
+    if (thread->sched_class == &edf_sched_class && thread->edf.throttled) {
+        return false;
+    }
+
+    Thread *current = rq->current;
+    if (current->flags & THREAD_IDLE) {
+        return true;
+    }
+    if (current->sched_class != thread->sched_class) {
+        return sched_class_rank(thread->sched_class) < sched_class_rank(current->sched_class);
+    }
+    return thread->sched_class->check_preempt(rq, thread);
+}
+
+/**
+ * @brief 锁住线程所在CPU的运行队列
+ * 线程可能在上锁前被迁移 上锁后须确认仍在该队列
+ *
+ * @param thread 线程
+ * @param flags 用于保存上锁前的RFLAGS
+ * @return 运行队列
+ */
+RunQueue *lock_thread_rq(Thread *thread, qword *flags) {
+    while (true) {
+        int cpu = thread->cpu;
+        RunQueue *rq = &runqueues[cpu];
+        *flags = spin_lock_irqsave(&rq->lock);
+        if (thread->cpu == cpu) {
+            return rq;
+        }
+        spin_unlock_irqrestore(&rq->lock, *flags);
+    }
+}
+
+/**
+ * @brief 锁住线程的运行队列并把线程移出其调度类
+ * 之后可修改线程的调度类与调度参数 再由sched_attach_thread放回
+ *
+ * @param thread 线程(非空闲线程)
+ * @param flags 用于保存上锁前的RFLAGS
+ * @return 运行队列
+ */
+RunQueue *sched_detach_thread(Thread *thread, qword *flags) {
+    RunQueue *rq = lock_thread_rq(thread, flags);
+    const SchedClass *sched_class = thread->sched_class;
+
+    if (rq->current == thread) {
+        sched_class->put_prev(rq, thread, false);
+    }
+    // 待迁移的线程不在任何调度类的就绪结构中
+    else if (thread->state == THREAD_READY && ! (thread->flags & THREAD_MIGRATE)) {
+        sched_class->dequeue(rq, thread);
+    }
+
+    if (sched_class->switched_from != NULL) {
+        sched_class->switched_from(rq, thread);
+    }
+    return rq;
+}
+
+/**
+ * @brief 把线程放回其(新的)调度类并解锁运行队列
+ * 需要时抢占
+ *
+ * @param rq sched_detach_thread返回的运行队列
+ * @param thread 线程
+ * @param flags sched_detach_thread保存的RFLAGS
+ */
+void sched_attach_thread(RunQueue *rq, Thread *thread, qword flags) {
+    bool resched = false;
+
+    if (rq->current == thread) {
+        thread->sched_class->set_curr(rq, thread);
+        // 调度类或参数改变后重新选择
+        resched = true;
+    }
+    else if (thread->state == THREAD_READY && ! (thread->flags & THREAD_MIGRATE)) {
+        thread->sched_class->enqueue(rq, thread);
+        resched = check_preempt_thread(rq, thread);
+    }
+
+    int cpu = thread->cpu;
+    spin_unlock_irqrestore(&rq->lock, flags);
+
+    if (resched) {
+        resched_cpu(cpu);
+    }
+}
+
+/**
+ * @brief 按CPU号顺序锁住两个运行队列
+ * 调用者需关中断并持有rq1的锁 rq2在前时会暂时释放rq1
+ *
+ * @param rq1 已持有锁的运行队列
+ * @param rq2 运行队列
+ * @return 是否暂时释放过rq1的锁
+ */
+bool double_rq_lock(RunQueue *rq1, RunQueue *rq2) {
+    if (rq1 < rq2) {
+        spin_lock(&rq2->lock);
+        return false;
+    }
+
+    spin_unlock(&rq1->lock);
+    spin_lock(&rq2->lock);
+    spin_lock(&rq1->lock);
+    return true;
+}
+
+/**
+ * @brief 取出下一个要运行的线程
+ * 依优先级询问各调度类 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @return 线程 没有就绪线程时为空闲线程
+ */
+static Thread *pick_next_thread(RunQueue *rq) {
+    if (rq->nr_ready == 0) {
+        return rq->idle;
+    }
+
+    for (int i = 0 ; i < (int)SCHED_CLASS_NUM ; i ++) {
+        Thread *thread = sched_classes[i]->pick_next(rq);
+        if (thread != NULL) {
+            list_del(&thread->list);
+            rq->nr_ready --;
+            return thread;
+        }
+    }
+    return rq->idle;
+}
+
+/**
+ * @brief 选出下一个线程并切换
+ * 调用者需关中断并持有当前CPU运行队列的锁 切换回来时锁仍被持有
+ * 当前线程仍在运行状态时放回运行队列 本CPU已不在其亲和集合中时留待切换后迁移
+ *
+ * @return 切换回本线程之前运行的线程 没有切换时为NULL
+ */
+static Thread *__schedule(void) {
+    RunQueue *rq = this_rq();
+    Thread *prev = current_thread();
+
+    this_cpu_write(need_resched, false);
+
+    if (! (prev->flags & THREAD_IDLE)) {
+        bool queued = false;
+        if (prev->state == THREAD_RUNNING) {
+            prev->state = THREAD_READY;
+            if (cpumask_test(prev->affinity, current_cpu_id())) {
+                list_add_tail(&rq->queue, &prev->list);
+                rq->nr_ready ++;
+                queued = true;
+            }
+            else {
+                prev->flags |= THREAD_MIGRATE;
+            }
+        }
+        prev->sched_class->put_prev(rq, prev, queued);
+        prev->flags &= ~THREAD_YIELD;
+    }
+
+    Thread *next = pick_next_thread(rq);
+    next->state = THREAD_RUNNING;
+    if (next == prev) {
+        return NULL;
+    }
+
+    prev->last_ran = rq->clock;
+    next->cpu = current_cpu_id();
+    rq->current = next;
+    rq->switches ++;
+    this_cpu_write(current_thread_ptr, next);
+    // 0号CPU的启动执行流沿用启动栈
+    if (next->stack != NULL) {
+        set_kernel_stack((qword)kernel_stack_top(next->stack));
+    }
+    // 线程都没有自己的用户地址空间 沿用当前CR3进入惰性TLB模式
+    // 切换到用户地址空间时由switch_address_space离开惰性模式并补刷新
+    tlb_enter_lazy();
+
+    return switch_context(prev, next);
+}
+
+/**
+ * @brief 切换的收尾
+ * 释放已退出的前一个线程 把需要迁移的前一个线程放到其它CPU
+ * 调用者已释放运行队列的锁
+ *
+ * @param prev 切换前的线程
+ */
+static void finish_switch(Thread *prev) {
+    if (prev == NULL) {
+        return;
+    }
+
+    if (prev->state == THREAD_DEAD) {
+        free_thread(prev);
+    }
+    else if (prev->flags & THREAD_MIGRATE) {
+        prev->flags &= ~THREAD_MIGRATE;
+        prev->cpu = select_thread_cpu(prev);
+        enqueue_thread(prev);
+    }
+}
+
+/**
+ * @brief 持有运行队列的锁时切换 之后解锁并恢复中断状态
+ *
+ * @param flags 上锁前的RFLAGS
+ */
+static void schedule_locked(qword flags) {
+    Thread *prev = __schedule();
+    // 可能已在另一个CPU上恢复运行 重新取运行队列
+    spin_unlock(&this_rq()->lock);
+    finish_switch(prev);
+    local_irq_restore(flags);
+}
+
+/**
+ * @brief 选出下一个线程并切换
+ *
+ */
+void schedule(void) {
+    qword flags = local_irq_save();
+    spin_lock(&this_rq()->lock);
+    schedule_locked(flags);
+}
+
+/**
+ * @brief 新线程第一次运行时完成切换的收尾
+ * 释放运行队列的锁并开中断
+ *
+ * @param prev 切换前的线程
+ */
+void schedule_tail(Thread *prev) {
+    spin_unlock(&this_rq()->lock);
+    finish_switch(prev);
+    local_irq_enable();
+}
+
+/**
+ * @brief 抢占计数归零且需要重新调度时抢占当前线程
+ *
+ */
+void preempt_schedule(void) {
+    if (this_cpu_read(preempt_count) != 0 || irqs_disabled()) {
+        return;
+    }
+
+    while (this_cpu_read(need_resched)) {
+        schedule();
+    }
+}
+
+/**
+ * @brief 中断返回前抢占被中断的线程
+ * 在关中断的情况下调用
+ *
+ */
+void preempt_schedule_irq(void) {
+    while (this_cpu_read(need_resched)) {
+        schedule();
+    }
+}
+
+/**
+ * @brief 时钟中断中更新调度状态
+ * 由各调度类决定是否重新调度 唤醒到期的睡眠线程
+ *
+ */
+void scheduler_tick(void) {
+    RunQueue *rq = this_rq();
+    bool resched = false;
+
+    spin_lock(&rq->lock);
+    rq->clock ++;
+
+    Thread *current = rq->current;
+    if (! (current->flags & THREAD_IDLE)) {
+        resched = current->sched_class->tick(rq, current);
+    }
+
+    for (int i = 0 ; i < (int)SCHED_CLASS_NUM ; i ++) {
+        if (sched_classes[i]->periodic != NULL && sched_classes[i]->periodic(rq)) {
+            resched = true;
+        }
+    }
+
+    list_for_each_safe(node, &rq->sleepers) {
+        Thread *thread = list_entry(node, Thread, list);
+        if (thread->wakeup <= rq->clock) {
+            list_del(node);
+            queue_thread(rq, thread);
+            resched = resched || check_preempt_thread(rq, thread);
+        }
+    }
+
+    if (resched) {
+        this_cpu_write(need_resched, true);
+    }
+    spin_unlock(&rq->lock);
+}
+
+/**
+ * @brief 放入线程所在CPU的运行队列
+ *
+ * @param thread 线程(非运行状态)
+ */
+void enqueue_thread(Thread *thread) {
+    int cpu = thread->cpu;
+    RunQueue *rq = &runqueues[cpu];
+
+    qword flags = spin_lock_irqsave(&rq->lock);
+    queue_thread(rq, thread);
+    bool preempt = check_preempt_thread(rq, thread);
+    spin_unlock_irqrestore(&rq->lock, flags);
+
+    if (preempt) {
+        resched_cpu(cpu);
+    }
+}
+
+/**
+ * @brief 唤醒睡眠的线程
+ *
+ * @param thread 线程
+ * @return 是否唤醒(线程原先不在睡眠时为false)
+ */
+bool wake_up_thread(Thread *thread) {
+    qword flags;
+    RunQueue *rq = lock_thread_rq(thread, &flags);
+    int cpu = thread->cpu;
+
+    if (thread->state != THREAD_SLEEPING) {
+        spin_unlock_irqrestore(&rq->lock, flags);
+        return false;
+    }
+
+    list_del(&thread->list);
+    queue_thread(rq, thread);
+    bool preempt = check_preempt_thread(rq, thread);
+    spin_unlock_irqrestore(&rq->lock, flags);
+
+    if (preempt) {
+        resched_cpu(cpu);
+    }
+    return true;
+}
+
+/**
+ * @brief 当前线程睡眠
+ *
+ * @param ticks 时钟中断数 到期或被wake_up_thread唤醒时返回
+ */
+void thread_sleep(qword ticks) {
+    // 关中断后再取运行队列 期间不会被抢占或迁移
+    qword flags = local_irq_save();
+    RunQueue *rq = this_rq();
+    Thread *current = current_thread();
+
+    spin_lock(&rq->lock);
+    current->state = THREAD_SLEEPING;
+    current->wakeup = rq->clock + ticks;
+    list_add_tail(&rq->sleepers, &current->list);
+    schedule_locked(flags);
+}
+
+/**
+ * @brief 当前线程睡眠直到标志被置位
+ * 在运行队列的锁下检查标志 置位者先置位再调用wake_up_thread 不会漏掉唤醒
+ *
+ * @param flag 标志
+ */
+void thread_wait(bool *flag) {
+    qword flags = local_irq_save();
+    RunQueue *rq = this_rq();
+    Thread *current = current_thread();
+
+    spin_lock(&rq->lock);
+    if (__atomic_load_n(flag, __ATOMIC_SEQ_CST)) {
+        spin_unlock(&rq->lock);
+        local_irq_restore(flags);
+        return;
+    }
+    current->state = THREAD_SLEEPING;
+    // 不会因时钟到期而醒来
+    current->wakeup = ~0ull;
+    list_add_tail(&rq->sleepers, &current->list);
+    schedule_locked(flags);
+}
+
+/**
+ * @brief 结束当前线程
+ * 线程的栈在切换到下一个线程后释放
+ *
+ */
+void thread_exit(void) {
+    qword flags = local_irq_save();
+    spin_lock(&this_rq()->lock);
+    current_thread()->state = THREAD_DEAD;
+    schedule_locked(flags);
+
+    // 不会再被调度
+    while (true);
+}
+
+/**
+ * @brief 让出CPU
+ *
+ */
+void thread_yield(void) {
+    qword flags = local_irq_save();
+    spin_lock(&this_rq()->lock);
+    current_thread()->flags |= THREAD_YIELD;
+    schedule_locked(flags);
+}
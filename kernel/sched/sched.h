@@ -0,0 +1,436 @@
+/**
+ * @file sched.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 调度器
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <sched/thread.h>
+#include <sched/preempt.h>
+#include <sync/spinlock.h>
+
+/** 时钟中断频率 */
+#define SCHED_HZ (100)
+/** 被切换走不足该时钟中断数的线程视为缓存仍热 不迁出末级缓存域 */
+#define SCHED_CACHE_HOT_TICKS (2)
+/** 末级缓存域内周期均衡的间隔(时钟中断数) 每上一级域间隔乘4 */
+#define SCHED_BALANCE_INTERVAL (4)
+
+/**
+ * @brief 调度域 负载均衡先在近的域内进行
+ *
+ */
+typedef enum {
+    /** 共享末级缓存的CPU */
+    SCHED_DOMAIN_LLC = 0,
+    /** 同一NUMA节点的CPU */
+    SCHED_DOMAIN_NODE,
+    /** 全部CPU */
+    SCHED_DOMAIN_ALL,
+    SCHED_DOMAIN_NUM
+} SchedDomain;
+
+/**
+ * @brief 每CPU的运行队列
+ * 只有本CPU从中取线程运行 其它CPU只在唤醒线程时放入
+ *
+ */
+typedef struct {
+    /** 锁 时钟中断中也会获取 */
+    Spinlock lock;
+    /** 全部就绪线程 按入队顺序 供负载均衡遍历 选择顺序由各调度类决定 */
+    ListNode queue;
+    /** 就绪线程数(不含正在运行的) */
+    int nr_ready;
+    /** 截止时间运行队列 */
+    EdfRunQueue edf;
+    /** 实时运行队列 */
+    RtRunQueue rt;
+    /** 公平运行队列 */
+    FairRunQueue fair;
+    /** 睡眠线程 */
+    ListNode sleepers;
+    /** 时钟 本CPU的时钟中断数 */
+    qword clock;
+    /** 切换次数 */
+    qword switches;
+    /** 迁入的线程数 */
+    qword migrations;
+    /** 正在运行的线程 */
+    Thread *current;
+    /** 空闲线程 不在队列中 队列为空时运行 */
+    Thread *idle;
+} RunQueue;
+
+/**
+ * @brief 调度类
+ * 调用时均需持有运行队列的锁 正在运行的线程不在调度类的就绪结构中
+ *
+ */
+typedef struct SchedClass {
+    /** 名称 */
+    const char *name;
+    /**
+     * @brief 加入就绪线程(新建 唤醒或迁入)
+     *
+     * @param rq 运行队列
+     * @param thread 线程
+     */
+    void (*enqueue)(RunQueue *rq, Thread *thread);
+    /**
+     * @brief 移出就绪线程(迁出或改变调度参数)
+     *
+     * @param rq 运行队列
+     * @param thread 线程
+     */
+    void (*dequeue)(RunQueue *rq, Thread *thread);
+    /**
+     * @brief 取出下一个要运行的线程
+     *
+     * @param rq 运行队列
+     * @return 线程 没有就绪线程时为NULL
+     */
+    Thread *(*pick_next)(RunQueue *rq);
+    /**
+     * @brief 正在运行的线程被切换走
+     *
+     * @param rq 运行队列
+     * @param thread 线程
+     * @param queued 是否仍就绪 为false时线程睡眠 退出 迁移或改变调度类
+     */
+    void (*put_prev)(RunQueue *rq, Thread *thread, bool queued);
+    /**
+     * @brief 正在运行的线程改为本调度类
+     *
+     * @param rq 运行队列
+     * @param thread 线程
+     */
+    void (*set_curr)(RunQueue *rq, Thread *thread);
+    /**
+     * @brief 线程被移出本调度类以改变调度类或调度参数(可为NULL)
+     * 此时线程已被移出就绪结构 或已由put_prev切换走
+     *
+     * @param rq 运行队列
+     * @param thread 线程
+     */
+    void (*switched_from)(RunQueue *rq, Thread *thread);
+    /**
+     * @brief 时钟中断中更新正在运行的线程
+     *
+     * @param rq 运行队列
+     * @param thread 线程
+     * @return 是否需要重新调度
+     */
+    bool (*tick)(RunQueue *rq, Thread *thread);
+    /**
+     * @brief 时钟中断中处理与正在运行的线程无关的事件(可为NULL)
+     *
+     * @param rq 运行队列
+     * @return 是否需要重新调度
+     */
+    bool (*periodic)(RunQueue *rq);
+    /**
+     * @brief 新就绪的线程是否应抢占同一调度类中正在运行的线程
+     *
+     * @param rq 运行队列
+     * @param thread 新就绪的线程
+     * @return 是否抢占
+     */
+    bool (*check_preempt)(RunQueue *rq, Thread *thread);
+} SchedClass;
+
+/** 截止时间调度类 */
+extern const SchedClass edf_sched_class;
+/** 实时调度类 */
+extern const SchedClass rt_sched_class;
+/** 公平调度类 */
+extern const SchedClass fair_sched_class;
+
+/** 各CPU的运行队列 */
+extern RunQueue runqueues[];
+
+/**
+ * @brief 当前CPU的运行队列
+ *
+ * @return 运行队列
+ */
+static inline RunQueue *this_rq(void) {
+    return &runqueues[this_cpu_read(cpu_number)];
+}
+
+/**
+ * @brief 运行队列的负载 就绪线程与正在运行的非空闲线程数
+ * 不持锁读取时只作估计
+ *
+ * @param rq 运行队列
+ * @return 负载
+ */
+static inline int rq_load(RunQueue *rq) {
+    return rq->nr_ready + ((rq->current->flags & THREAD_IDLE) ? 0 : 1);
+}
+
+/**
+ * @brief 初始化调度器
+ * 当前执行流成为0号CPU的空闲线程
+ *
+ */
+void init_sched(void);
+
+/**
+ * @brief 初始化CPU的运行队列 以idle为其空闲线程
+ *
+ * @param cpu CPU号
+ * @param idle 空闲线程
+ */
+void init_runqueue(int cpu, Thread *idle);
+
+/**
+ * @brief 启动当前CPU的时钟中断 此后开始抢占
+ *
+ */
+void sched_start(void);
+
+/**
+ * @brief 选出下一个线程并切换
+ *
+ */
+void schedule(void);
+
+/**
+ * @brief 新线程第一次运行时完成切换的收尾
+ * 释放运行队列的锁并开中断
+ *
+ * @param prev 切换前的线程
+ */
+void schedule_tail(Thread *prev);
+
+/**
+ * @brief 抢占计数归零且需要重新调度时抢占当前线程
+ *
+ */
+void preempt_schedule(void);
+
+/**
+ * @brief 中断返回前抢占被中断的线程
+ * 在关中断的情况下调用
+ *
+ */
+void preempt_schedule_irq(void);
+
+/**
+ * @brief 时钟中断中更新调度状态
+ * 唤醒到期的睡眠线程 时间片耗尽时请求重新调度
+ *
+ */
+void scheduler_tick(void);
+
+/**
+ * @brief 放入线程所在CPU的运行队列
+ *
+ * @param thread 线程(非运行状态)
+ */
+void enqueue_thread(Thread *thread);
+
+/**
+ * @brief 唤醒睡眠的线程
+ *
+ * @param thread 线程
+ * @return 是否唤醒(线程原先不在睡眠时为false)
+ */
+bool wake_up_thread(Thread *thread);
+
+/**
+ * @brief 当前线程睡眠
+ *
+ * @param ticks 时钟中断数 到期或被wake_up_thread唤醒时返回
+ */
+void thread_sleep(qword ticks);
+
+/**
+ * @brief 当前线程睡眠直到标志被置位
+ * 在运行队列的锁下检查标志 置位者先置位再调用wake_up_thread 不会漏掉唤醒
+ *
+ * @param flag 标志
+ */
+void thread_wait(bool *flag);
+
+/**
+ * @brief 结束当前线程
+ * 线程的栈在切换到下一个线程后释放
+ *
+ */
+void thread_exit(void) __attribute__((noreturn));
+
+/**
+ * @brief 让出CPU
+ *
+ */
+void thread_yield(void);
+
+/**
+ * @brief 把线程放到队尾
+ * 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+void queue_thread(RunQueue *rq, Thread *thread);
+
+/**
+ * @brief 把就绪线程移出运行队列
+ * 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ */
+void dequeue_thread(RunQueue *rq, Thread *thread);
+
+/**
+ * @brief 新就绪的线程是否应抢占运行队列中正在运行的线程
+ * 调用者需持有运行队列的锁
+ *
+ * @param rq 运行队列
+ * @param thread 线程
+ * @return 是否抢占
+ */
+bool check_preempt_thread(RunQueue *rq, Thread *thread);
+
+/**
+ * @brief 锁住线程的运行队列并把线程移出其调度类
+ * 之后可修改线程的调度类与调度参数 再由sched_attach_thread放回
+ *
+ * @param thread 线程(非空闲线程)
+ * @param flags 用于保存上锁前的RFLAGS
+ * @return 运行队列
+ */
+RunQueue *sched_detach_thread(Thread *thread, qword *flags);
+
+/**
+ * @brief 把线程放回其(新的)调度类并解锁运行队列
+ * 需要时抢占
+ *
+ * @param rq sched_detach_thread返回的运行队列
+ * @param thread 线程
+ * @param flags sched_detach_thread保存的RFLAGS
+ */
+void sched_attach_thread(RunQueue *rq, Thread *thread, qword flags);
+
+/**
+ * @brief 线程改回公平调度类
+ *
+ * @param thread 线程
+ * @return 是否成功
+ */
+bool set_thread_fair(Thread *thread);
+
+/**
+ * @brief 线程改为实时调度类
+ *
+ * @param thread 线程
+ * @param policy 策略
+ * @param priority 优先级 RT_PRIO_MIN到RT_PRIO_MAX 越大越优先
+ * @return 是否成功
+ */
+bool set_thread_rt(Thread *thread, RtPolicy policy, int priority);
+
+/**
+ * @brief 线程改为截止时间调度类
+ * 须满足0 < runtime <= deadline <= period 且能在亲和集合内的某个CPU上预留带宽
+ * 成功后线程固定在该CPU上
+ *
+ * @param thread 线程
+ * @param runtime 每周期的运行时间(纳秒)
+ * @param deadline 相对截止时间(纳秒)
+ * @param period 周期(纳秒)
+ * @return 是否通过准入控制
+ */
+bool set_thread_edf(Thread *thread, qword runtime, qword deadline, qword period);
+
+/**
+ * @brief 设置线程的nice值
+ *
+ * @param thread 线程
+ * @param nice nice值 NICE_MIN到NICE_MAX
+ * @return 是否成功
+ */
+bool set_thread_nice(Thread *thread, int nice);
+
+/**
+ * @brief 设置线程的延迟目标
+ * 即公平调度类中每次请求的长度 越短等待越短 但切换越频繁
+ *
+ * @param thread 线程
+ * @param slice 请求长度(纳秒) 限制在SCHED_MIN_SLICE到SCHED_MAX_SLICE之间
+ * @return 是否成功
+ */
+bool set_thread_latency(Thread *thread, qword slice);
+
+/**
+ * @brief 锁住线程所在CPU的运行队列
+ * 线程可能在上锁前被迁移 上锁后须确认仍在该队列
+ *
+ * @param thread 线程
+ * @param flags 用于保存上锁前的RFLAGS
+ * @return 运行队列
+ */
+RunQueue *lock_thread_rq(Thread *thread, qword *flags);
+
+/**
+ * @brief 按CPU号顺序锁住两个运行队列
+ * 调用者需关中断并持有rq1的锁 rq2在前时会暂时释放rq1
+ *
+ * @param rq1 已持有锁的运行队列
+ * @param rq2 运行队列
+ * @return 是否暂时释放过rq1的锁
+ */
+bool double_rq_lock(RunQueue *rq1, RunQueue *rq2);
+
+/**
+ * @brief 为线程挑选CPU
+ * 在亲和集合内的在线CPU中选负载最轻的 负载相同时优先与当前CPU共享缓存的
+ *
+ * @param thread 线程
+ * @return CPU号
+ */
+int select_thread_cpu(Thread *thread);
+
+/**
+ * @brief 设置线程的亲和集合
+ * 线程所在CPU不在集合中时迁走 正在运行的线程在下次切换走后迁移
+ * EDF线程仍固定在预留带宽的CPU上 新集合在移出截止时间调度类时生效
+ *
+ * @param thread 线程
+ * @param mask CPU集合
+ * @return 是否成功(集合中没有在线CPU 或EDF线程预留带宽的CPU不在集合中时失败)
+ */
+bool set_thread_affinity(Thread *thread, CPUMask mask);
+
+/**
+ * @brief 空闲的CPU从最忙的运行队列中窃取一个线程
+ * 由近到远依次在各调度域中寻找
+ *
+ * @return 是否窃取到线程
+ */
+bool idle_balance(void);
+
+/**
+ * @brief 周期负载均衡 在时钟中断中调用
+ * 各调度域按各自的间隔从最忙的运行队列拉取线程 直到负载差不足2
+ *
+ */
+void load_balance_tick(void);
+
+/**
+ * @brief 请求CPU重新调度
+ * 其它CPU通过IPI通知
+ *
+ * @param cpu CPU号
+ */
+void resched_cpu(int cpu);
@@ -0,0 +1,166 @@
+/**
+ * @file thread.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内核线程
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <sched/thread.h>
+#include <sched/sched.h>
+#include <cpu/cpu.h>
+#include <mm/slab.h>
+#include <mm/kstack.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+/** switch.S中新线程的起点 */
+extern byte thread_start[];
+
+/**
+ * @brief 新线程栈顶的初始内容
+ * switch_context依次弹出被调用者保存的寄存器 再返回到thread_start
+ *
+ */
+typedef struct {
+    qword r15;
+    qword r14;
+    qword r13;
+    qword r12;
+    qword rbx;
+    qword rbp;
+    /** switch_context的返回地址 */
+    qword ret;
+} ThreadStartFrame;
+
+// 0号CPU的启动执行流 初始化完成后成为其空闲线程
+static Thread boot_thread = {
+    .name = "idle0",
+    .state = THREAD_RUNNING,
+    .flags = THREAD_IDLE,
+    .cpu = 0,
+    .affinity = 1
+};
+
+/** 当前线程 建立每CPU区域前即为启动执行流 */
+DEFINE_PER_CPU(Thread *, current_thread_ptr) = &boot_thread;
+
+// 线程对象缓存
+static KMemCache thread_cache;
+// 下一个线程号
+static int next_tid = 1;
+
+/**
+ * @brief 初始化线程管理
+ * 需在slab初始化之后调用
+ *
+ */
+void init_thread(void) {
+    kmem_cache_init(&thread_cache, "thread", sizeof(Thread));
+}
+
+/**
+ * @brief 新线程的C入口
+ * 由thread_start调用 完成切换的收尾后运行线程入口
+ *
+ * @param prev 切换前的线程
+ */
+void thread_main(Thread *prev) {
+    schedule_tail(prev);
+
+    Thread *thread = current_thread();
+    thread->entry(thread->arg);
+    thread_exit();
+}
+
+/**
+ * @brief 创建内核线程并放入当前CPU的运行队列
+ *
+ * @param name 名字
+ * @param entry 入口
+ * @param arg 入口参数
+ * @return 线程 失败时为NULL
+ */
+Thread *create_kernel_thread(const char *name, ThreadEntry entry, void *arg) {
+    Thread *thread = kmem_cache_alloc(&thread_cache);
+    if (thread == NULL) {
+        return NULL;
+    }
+    memset(thread, 0, sizeof(Thread));
+
+    thread->stack = alloc_kernel_stack();
+    if (thread->stack == NULL) {
+        kmem_cache_free(&thread_cache, thread);
+        return NULL;
+    }
+
+    // 栈顶留出16字节 返回到thread_start后栈按16字节对齐
+    ThreadStartFrame *frame = (ThreadStartFrame *)((byte *)kernel_stack_top(thread->stack) - 16) - 1;
+    memset(frame, 0, sizeof(ThreadStartFrame));
+    frame->ret = (qword)thread_start;
+
+    thread->rsp = (qword)frame;
+    thread->tid = __atomic_fetch_add(&next_tid, 1, __ATOMIC_RELAXED);
+    strncpy(thread->name, name, THREAD_NAME_LEN - 1);
+    thread->state = THREAD_READY;
+    thread->cpu = current_cpu_id();
+    thread->affinity = CPU_MASK_ALL;
+    thread->sched_class = &fair_sched_class;
+    init_fair_entity(&thread->fair);
+    list_init(&thread->rt.node);
+    thread->edf.bw_cpu = -1;
+    thread->entry = entry;
+    thread->arg = arg;
+    list_init(&thread->list);
+
+    enqueue_thread(thread);
+    return thread;
+}
+
+/**
+ * @brief 为其它CPU创建空闲线程
+ * 线程不进入运行队列 该CPU启动后直接在其栈上运行
+ *
+ * @param cpu CPU号
+ * @return 线程 失败时为NULL
+ */
+Thread *create_idle_thread(int cpu) {
+    Thread *thread = kmem_cache_alloc(&thread_cache);
+    if (thread == NULL) {
+        return NULL;
+    }
+    memset(thread, 0, sizeof(Thread));
+
+    thread->stack = alloc_kernel_stack();
+    if (thread->stack == NULL) {
+        kmem_cache_free(&thread_cache, thread);
+        return NULL;
+    }
+
+    thread->tid = __atomic_fetch_add(&next_tid, 1, __ATOMIC_RELAXED);
+    sprintf(thread->name, "idle%d", cpu);
+    thread->state = THREAD_RUNNING;
+    thread->flags = THREAD_IDLE;
+    thread->cpu = cpu;
+    thread->affinity = 1ull << cpu;
+    list_init(&thread->rt.node);
+    thread->edf.bw_cpu = -1;
+    list_init(&thread->list);
+    return thread;
+}
+
+/**
+ * @brief 释放已退出的线程
+ * 由调度器在切换走之后调用
+ *
+ * @param thread 线程
+ */
+void free_thread(Thread *thread) {
+    free_kernel_stack(thread->stack);
+    kmem_cache_free(&thread_cache, thread);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file thread.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内核线程
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <lib/list.h>
+#include <cpu/cpu.h>
+#include <sched/fair.h>
+#include <sched/rt.h>
+#include <sched/edf.h>
+
+/** 线程名长度 */
+#define THREAD_NAME_LEN (16)
+
+/** 线程标志: 正在回收内存 回收路径中的分配可以动用保留内存 */
+#define THREAD_RECLAIM (1 << 0)
+/** 线程标志: 空闲线程 */
+#define THREAD_IDLE    (1 << 1)
+/** 线程标志: 当前CPU不在亲和集合中 切换走后迁移到其它CPU */
+#define THREAD_MIGRATE (1 << 2)
+/** 线程标志: 主动让出CPU 由调度类排到同级线程之后 */
+#define THREAD_YIELD   (1 << 3)
+
+/**
+ * @brief 线程状态
+ *
+ */
+typedef enum {
+    /** 正在运行 */
+    THREAD_RUNNING = 0,
+    /** 在运行队列中等待 */
+    THREAD_READY,
+    /** 睡眠 */
+    THREAD_SLEEPING,
+    /** 已退出 等待回收 */
+    THREAD_DEAD
+} ThreadState;
+
+/**
+ * @brief 线程入口
+ *
+ */
+typedef void (*ThreadEntry)(void *arg);
+
+struct SchedClass;
+
+/**
+ * @brief 线程
+ *
+ */
+typedef struct {
+    /** 切换走时保存的栈指针 必须为第一个成员(switch.S) */
+    qword rsp;
+    /** 内核栈 */
+    void *stack;
+    /** 线程号 */
+    int tid;
+    /** 名字 */
+    char name[THREAD_NAME_LEN];
+    /** 状态 */
+    ThreadState state;
+    /** 标志 */
+    dword flags;
+    /** 所在CPU */
+    int cpu;
+    /** 允许运行的CPU */
+    CPUMask affinity;
+    /** 上次被切换走时所在运行队列的时钟 用于判断缓存是否仍热 */
+    qword last_ran;
+    /** 调度类 空闲线程不属于任何调度类 */
+    const struct SchedClass *sched_class;
+    /** 公平调度状态 */
+    FairEntity fair;
+    /** 实时调度状态 */
+    RtEntity rt;
+    /** 截止时间调度状态 */
+    EdfEntity edf;
+    /** 睡眠到运行队列时钟的该值时唤醒 */
+    qword wakeup;
+    /** 运行队列或睡眠链表中的节点 */
+    ListNode list;
+    /** 入口 */
+    ThreadEntry entry;
+    /** 入口参数 */
+    void *arg;
+} Thread;
+
+/** 当前线程 */
+DECLARE_PER_CPU(Thread *, current_thread_ptr);
+
+/**
+ * @brief 当前线程
+ *
+ * @return 当前线程
+ */
+static inline Thread *current_thread(void) {
+    return this_cpu_read(current_thread_ptr);
+}
+
+/**
+ * @brief 初始化线程管理
+ * 需在slab初始化之后调用
+ *
+ */
+void init_thread(void);
+
+/**
+ * @brief 创建内核线程并放入当前CPU的运行队列
+ *
+ * @param name 名字
+ * @param entry 入口
+ * @param arg 入口参数
+ * @return 线程 失败时为NULL
+ */
+Thread *create_kernel_thread(const char *name, ThreadEntry entry, void *arg);
+
+/**
+ * @brief 为其它CPU创建空闲线程
+ * 线程不进入运行队列 该CPU启动后直接在其栈上运行
+ *
+ * @param cpu CPU号
+ * @return 线程 失败时为NULL
+ */
+Thread *create_idle_thread(int cpu);
+
+/**
+ * @brief 释放已退出的线程
+ * 由调度器在切换走之后调用
+ *
+ * @param thread 线程
+ */
+void free_thread(Thread *thread);
@@ -0,0 +1,102 @@
+/**
+ * @file spinlock.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 自旋锁
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <sched/preempt.h>
+
+/**
+ * @brief 自旋锁
+ *
+ */
+typedef struct {
+    /** 是否已上锁 */
+    volatile dword locked;
+} Spinlock;
+
+/** 自旋锁初始值 */
+#define SPINLOCK_INIT { .locked = 0 }
+
+/**
+ * @brief 自旋等待时的提示
+ *
+ */
+static inline void cpu_relax(void) {
+    asm volatile ("pause" : : : "memory");
+}
+
+/**
+ * @brief 尝试上锁
+ * 成功时禁止抢占 持锁期间不会被切换走
+ *
+ * @param lock 自旋锁
+ * @return 是否成功上锁
+ */
+static inline bool spin_trylock(Spinlock *lock) {
+    preempt_disable();
+    if (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE) == 0) {
+        return true;
+    }
+    preempt_enable_no_resched();
+    return false;
+}
+
+/**
+ * @brief 上锁
+ *
+ * @param lock 自旋锁
+ */
+static inline void spin_lock(Spinlock *lock) {
+    while (! spin_trylock(lock)) {
+        // 只读等待 避免缓存行来回传递
+        while (lock->locked) {
+            cpu_relax();
+        }
+    }
+}
+
+/**
+ * @brief 解锁
+ *
+ * @param lock 自旋锁
+ */
+static inline void spin_unlock(Spinlock *lock) {
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+    preempt_enable();
+}
+
+/**
+ * @brief 关中断并上锁
+ * 中断处理程序中也会获取的锁必须以此上锁
+ *
+ * @param lock 自旋锁
+ * @return 原先的RFLAGS
+ */
+static inline qword spin_lock_irqsave(Spinlock *lock) {
+    qword flags = local_irq_save();
+    spin_lock(lock);
+    return flags;
+}
+
+/**
+ * @brief 解锁并恢复中断状态
+ *
+ * @param lock 自旋锁
+ * @param flags spin_lock_irqsave的返回值
+ */
+static inline void spin_unlock_irqrestore(Spinlock *lock, qword flags) {
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+    local_irq_restore(flags);
+    // 恢复中断后再处理积压的重新调度请求
+    preempt_enable();
+}
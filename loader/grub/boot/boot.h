@@ -0,0 +1,78 @@
+/**
+ * @file boot.h
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 加载内核
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#pragma once
+
+#include <tay/types.h>
+#include <tay/boot.h>
+#include <multiboot2.h>
+
+/**
+ * @brief 交给内核的页表所在的物理地址
+ * 位于KERNEL_LOAD_ADDR之下 由内核保留 内核沿用这些页表
+ *
+ */
+#define BOOT_PAGING_ADDR (0x100000)
+/** 页表占用的页数(PML4 两个PDPT 四个PD) */
+#define BOOT_PAGING_PAGES (7)
+/** 交给内核的启动信息所在的物理地址 紧接在页表之后 */
+#define BOOT_INFO_ADDR   (BOOT_PAGING_ADDR + BOOT_PAGING_PAGES * 0x1000)
+
+/** 恒等映射的大小(4GB 覆盖APIC等MMIO) */
+#define BOOT_IDENTITY_SIZE (4ull << 30)
+
+/**
+ * @brief 由Multiboot2信息填写启动信息
+ *
+ * @param tags Multiboot2信息
+ * @param boot_info 启动信息
+ */
+void build_boot_info(struct multiboot_tag *tags, BootInfo *boot_info);
+
+/**
+ * @brief 查找内核模块
+ *
+ * @param tags Multiboot2信息
+ * @return 内核模块 没有时为NULL
+ */
+struct multiboot_tag_module *find_kernel_module(struct multiboot_tag *tags);
+
+/**
+ * @brief 把内核ELF映像的各段加载到其物理地址
+ *
+ * @param module 内核模块
+ * @param entry 用于返回入口(高半区地址)
+ * @return 是否成功
+ */
+bool load_kernel(struct multiboot_tag_module *module, qword *entry);
+
+/**
+ * @brief 建立内核所需的页表
+ * 恒等映射低端4GB 并把物理内存[0, KERNEL_MAP_SIZE)映射到KERNEL_VIRT_BASE
+ *
+ * @return PML4的物理地址
+ */
+dword setup_boot_paging(void);
+
+/**
+ * @brief 进入长模式并跳转到内核
+ * 参数经kernel_pml4, kernel_entry与kernel_boot_info传递
+ *
+ */
+void enter_kernel(void) __attribute__((noreturn));
+
+/** 页表根 */
+extern dword kernel_pml4;
+/** 内核入口 */
+extern qword kernel_entry;
+/** 启动信息 */
+extern dword kernel_boot_info;
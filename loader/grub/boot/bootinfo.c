@@ -0,0 +1,86 @@
+/**
+ * @file bootinfo.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 启动信息
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <boot/boot.h>
+#include <basec/logger.h>
+#include <stddef.h>
+
+/**
+ * @brief 第一个标签
+ * 固定部分(total_size与reserved)之后即为各标签
+ *
+ * @param tags Multiboot2信息
+ * @return 第一个标签
+ */
+static inline struct multiboot_tag *first_tag(struct multiboot_tag *tags) {
+    return (struct multiboot_tag *)(((byte *)tags) + 8);
+}
+
+/**
+ * @brief 下一个标签
+ * 标签按8字节对齐
+ *
+ * @param tag 标签
+ * @return 下一个标签
+ */
+static inline struct multiboot_tag *next_tag(struct multiboot_tag *tag) {
+    return (struct multiboot_tag *)(((byte *)tag) + ((tag->size + MULTIBOOT_TAG_ALIGN - 1) & ~(MULTIBOOT_TAG_ALIGN - 1)));
+}
+
+/**
+ * @brief 由Multiboot2信息填写启动信息
+ *
+ * @param tags Multiboot2信息
+ * @param boot_info 启动信息
+ */
+void build_boot_info(struct multiboot_tag *tags, BootInfo *boot_info) {
+    boot_info->memory_entry_num = 0;
+    boot_info->reserved = 0;
+
+    for (struct multiboot_tag *tag = first_tag(tags) ; tag->type != MULTIBOOT_TAG_TYPE_END ; tag = next_tag(tag)) {
+        if (tag->type != MULTIBOOT_TAG_TYPE_MMAP) {
+            continue;
+        }
+
+        // 内存区域类型与Multiboot2一致 直接复制
+        struct multiboot_tag_mmap *mmap = (struct multiboot_tag_mmap *)tag;
+        byte *end = ((byte *)mmap) + mmap->size;
+        for (byte *ptr = (byte *)mmap->entries ; ptr < end ; ptr += mmap->entry_size) {
+            if (boot_info->memory_entry_num >= BOOT_MEMORY_ENTRY_MAX) {
+                log_warn("内存布局表项过多, 忽略其余项");
+                return;
+            }
+
+            struct multiboot_mmap_entry *entry = (struct multiboot_mmap_entry *)ptr;
+            BootMemoryEntry *boot_entry = &boot_info->memory_map[boot_info->memory_entry_num ++];
+            boot_entry->base = entry->addr;
+            boot_entry->length = entry->len;
+            boot_entry->type = entry->type;
+            boot_entry->reserved = 0;
+        }
+    }
+}
+
+/**
+ * @brief 查找内核模块
+ *
+ * @param tags Multiboot2信息
+ * @return 内核模块 没有时为NULL
+ */
+struct multiboot_tag_module *find_kernel_module(struct multiboot_tag *tags) {
+    for (struct multiboot_tag *tag = first_tag(tags) ; tag->type != MULTIBOOT_TAG_TYPE_END ; tag = next_tag(tag)) {
+        if (tag->type == MULTIBOOT_TAG_TYPE_MODULE) {
+            return (struct multiboot_tag_module *)tag;
+        }
+    }
+    return NULL;
+}
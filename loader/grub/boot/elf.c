@@ -0,0 +1,111 @@
+/**
+ * @file elf.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 加载内核ELF映像
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <boot/boot.h>
+#include <basec/logger.h>
+#include <string.h>
+#include <elf.h>
+
+/** e_ident中的位宽 */
+#define ELF_IDENT_CLASS (4)
+/** 64位 */
+#define ELF_CLASS_64    (2)
+/** x86_64 */
+#define ELF_MACHINE_X86_64 (62)
+
+/** 加载器映像开始 */
+extern byte __loader_start[];
+/** 加载器映像结束 */
+extern byte __loader_end[];
+
+/**
+ * @brief 两个物理地址范围是否重叠
+ *
+ * @param start1 范围1起始
+ * @param end1 范围1结束
+ * @param start2 范围2起始
+ * @param end2 范围2结束
+ * @return 是否重叠
+ */
+static inline bool overlaps(qword start1, qword end1, qword start2, qword end2) {
+    return start1 < end2 && start2 < end1;
+}
+
+/**
+ * @brief 检查内核ELF头
+ *
+ * @param header ELF头
+ * @param size 映像大小
+ * @return 是否为可加载的x86_64可执行文件
+ */
+static bool check_header(Elf64_Ehdr *header, dword size) {
+    if (size < sizeof(Elf64_Ehdr) || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0) {
+        log_error("内核不是ELF文件");
+        return false;
+    }
+    if (header->e_ident[ELF_IDENT_CLASS] != ELF_CLASS_64 || header->e_machine != ELF_MACHINE_X86_64 ||
+        header->e_type != ET_EXEC) {
+        log_error("内核不是x86_64可执行文件");
+        return false;
+    }
+    if (header->e_phoff + (qword)header->e_phnum * sizeof(Elf64_Phdr) > size) {
+        log_error("内核程序头表越界");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 把内核ELF映像的各段加载到其物理地址
+ *
+ * @param module 内核模块
+ * @param entry 用于返回入口(高半区地址)
+ * @return 是否成功
+ */
+bool load_kernel(struct multiboot_tag_module *module, qword *entry) {
+    byte *image = (byte *)module->mod_start;
+    dword size = module->mod_end - module->mod_start;
+    Elf64_Ehdr *header = (Elf64_Ehdr *)image;
+
+    if (! check_header(header, size)) {
+        return false;
+    }
+
+    Elf64_Phdr *phdrs = (Elf64_Phdr *)(image + header->e_phoff);
+    for (int i = 0 ; i < header->e_phnum ; i ++) {
+        Elf64_Phdr *phdr = &phdrs[i];
+        if (phdr->p_type != PT_LOAD || phdr->p_memsz == 0) {
+            continue;
+        }
+
+        qword start = phdr->p_paddr;
+        qword end = start + phdr->p_memsz;
+
+        // 段须在内核区域内 且不能覆盖加载器自身与尚未读完的模块
+        if (start < KERNEL_LOAD_ADDR || end > KERNEL_MAP_SIZE || phdr->p_filesz > phdr->p_memsz ||
+            phdr->p_offset + phdr->p_filesz > size) {
+            log_error("内核段%d的位置无效", i);
+            return false;
+        }
+        if (overlaps(start, end, (qword)(dword)__loader_start, (qword)(dword)__loader_end) ||
+            overlaps(start, end, module->mod_start, module->mod_end)) {
+            log_error("内核段%d与加载器或内核模块重叠", i);
+            return false;
+        }
+
+        memcpy((void *)(dword)start, image + phdr->p_offset, phdr->p_filesz);
+        memset((void *)(dword)(start + phdr->p_filesz), 0, phdr->p_memsz - phdr->p_filesz);
+    }
+
+    *entry = header->e_entry;
+    return true;
+}
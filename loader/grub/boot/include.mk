@@ -0,0 +1,4 @@
+objects += boot/bootinfo.o
+objects += boot/elf.o
+objects += boot/paging.o
+objects += boot/enter.o
\ No newline at end of file
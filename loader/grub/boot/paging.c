@@ -0,0 +1,65 @@
+/**
+ * @file paging.c
+ * @author theflysong (song_of_the_fly@163.com)
+ * @brief 内核的初始页表
+ * @version alpha-1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 TayhuangOS Development Team
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <boot/boot.h>
+#include <tay/paging.h>
+#include <string.h>
+
+/** 每个页表的项数 */
+#define ENTRIES_PER_TABLE (512)
+/** 页表大小 */
+#define TABLE_SIZE (0x1000)
+/** 1GB */
+#define SIZE_1G (1ull << 30)
+/** 2MB */
+#define SIZE_2M (1ull << 21)
+
+/**
+ * @brief 第index个页表
+ * 依次为PML4 低端PDPT 高半区PDPT 以及恒等映射各GB的PD
+ *
+ * @param index 序号
+ * @return 页表
+ */
+static inline qword *boot_table(int index) {
+    return (qword *)(BOOT_PAGING_ADDR + index * TABLE_SIZE);
+}
+
+/**
+ * @brief 建立内核所需的页表
+ * 恒等映射低端4GB 并把物理内存[0, KERNEL_MAP_SIZE)映射到KERNEL_VIRT_BASE
+ *
+ * @return PML4的物理地址
+ */
+dword setup_boot_paging(void) {
+    qword *pml4 = boot_table(0);
+    qword *pdpt_low = boot_table(1);
+    qword *pdpt_high = boot_table(2);
+
+    memset(pml4, 0, BOOT_PAGING_PAGES * TABLE_SIZE);
+
+    // 恒等映射 以2MB页覆盖低端4GB
+    for (int i = 0 ; i < BOOT_IDENTITY_SIZE / SIZE_1G ; i ++) {
+        qword *pd = boot_table(3 + i);
+        for (int j = 0 ; j < ENTRIES_PER_TABLE ; j ++) {
+            pd[j] = (i * SIZE_1G + j * SIZE_2M) | PAGE_PRESENT | PAGE_WRITE | PAGE_HUGE;
+        }
+        pdpt_low[i] = (dword)pd | PAGE_PRESENT | PAGE_WRITE;
+    }
+    pml4[0] = (dword)pdpt_low | PAGE_PRESENT | PAGE_WRITE;
+
+    // 高半区与恒等映射的第一个GB共用PD
+    pdpt_high[(KERNEL_VIRT_BASE >> 30) % ENTRIES_PER_TABLE] = (dword)boot_table(3) | PAGE_PRESENT | PAGE_WRITE;
+    pml4[(KERNEL_VIRT_BASE >> 39) % ENTRIES_PER_TABLE] = (dword)pdpt_high | PAGE_PRESENT | PAGE_WRITE;
+
+    return (dword)pml4;
+}
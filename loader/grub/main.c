@@ -12,6 +12,7 @@
 
 #include <tay/types.h>
 #include <tay/ports.h>
+#include <tay/io.h>
 #include <tay/cr.h>
 #include <tay/paging.h>
 
@@ -21,6 +22,20 @@
 
 #include <init/init.h>
 #include <libs/debug.h>
+#include <boot/boot.h>
+#include <string.h>
+
+/** 页表根 */
+dword kernel_pml4;
+/** 内核入口 */
+qword kernel_entry;
+/** 启动信息 */
+dword kernel_boot_info;
+
+// Multiboot2信息
+static struct multiboot_tag *boot_tags;
+// 启动信息 页表建立后复制到BOOT_INFO_ADDR
+static BootInfo boot_info;
 
 void init() {
     init_gdt();
@@ -40,7 +55,30 @@ void init() {
 
 int main() {
     log_debug("Loader here!");
-    return 0;
+
+    // 页表与启动信息可能覆盖Multiboot2信息 先取出所需内容
+    build_boot_info(boot_tags, &boot_info);
+    struct multiboot_tag_module *module = find_kernel_module(boot_tags);
+    if (module == NULL) {
+        log_error("没有找到内核模块");
+        return -1;
+    }
+
+    if (! load_kernel(module, &kernel_entry)) {
+        return -1;
+    }
+
+    kernel_pml4 = setup_boot_paging();
+    memcpy((void *)BOOT_INFO_ADDR, &boot_info, sizeof(BootInfo));
+    kernel_boot_info = BOOT_INFO_ADDR;
+
+    log_debug("内核已加载, 进入长模式");
+
+    // 内核使用APIC 屏蔽PIC
+    outb(M_PIC_BASE + PIC_DATA, 0xFF);
+    outb(S_PIC_BASE + PIC_DATA, 0xFF);
+
+    enter_kernel();
 }
 
 void terminate() {
@@ -63,6 +101,8 @@ void setup(void) {
         while (true);
     }
 
+    boot_tags = multiboot_info;
+
     // 初始化
     init();
 